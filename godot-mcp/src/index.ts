@@ -9,7 +9,8 @@
 
 import { fileURLToPath } from 'url';
 import { join, dirname, basename, normalize } from 'path';
-import { existsSync, readdirSync, mkdirSync } from 'fs';
+import { existsSync, readdirSync, mkdirSync, readFileSync } from 'fs';
+import { createConnection } from 'net';
 import { spawn } from 'child_process';
 import { promisify } from 'util';
 import { exec } from 'child_process';
@@ -59,6 +60,26 @@ interface OperationParams {
   [key: string]: any;
 }
 
+/**
+ * Connection details written by the Vector AI editor module's RPC server
+ */
+interface EditorRpcDiscovery {
+  port: number;
+  token: string;
+  pid?: number;
+}
+
+/**
+ * Operations the running editor can serve, mapped to their RPC method names
+ */
+const EDITOR_RPC_METHODS: Record<string, string> = {
+  create_scene: 'create_scene',
+  add_node: 'create_node',
+  save_scene: 'save_scene',
+};
+
+const EDITOR_RPC_TIMEOUT_MS = 5000;
+
 /**
  * Main server class for the Godot MCP server
  */
@@ -482,6 +503,11 @@ class GodotServer {
     const snakeCaseParams = this.convertCamelToSnakeCase(params);
     this.logDebug(`Converted snake_case params: ${JSON.stringify(snakeCaseParams)}`);
 
+    // Prefer the running editor: a socket round trip instead of an engine launch
+    const rpcResult = await this.tryEditorRpc(operation, snakeCaseParams, projectPath);
+    if (rpcResult) {
+      return rpcResult;
+    }
 
     // Ensure godotPath is set
     if (!this.godotPath) {
@@ -533,6 +559,80 @@ class GodotServer {
     }
   }
 
+  /**
+   * Run an operation through the RPC server of an editor that has the project open
+   * @param operation The operation to execute
+   * @param params The snake_case parameters for the operation
+   * @param projectPath The path to the Godot project
+   * @returns The stdout and stderr equivalent, or null when no editor is reachable
+   */
+  private async tryEditorRpc(
+    operation: string,
+    params: OperationParams,
+    projectPath: string
+  ): Promise<{ stdout: string; stderr: string } | null> {
+    const method = EDITOR_RPC_METHODS[operation];
+    if (!method) {
+      return null;
+    }
+
+    const discoveryPath = join(projectPath, '.godot', 'editor', 'vector_ai_rpc.json');
+    if (!existsSync(discoveryPath)) {
+      return null;
+    }
+
+    let discovery: EditorRpcDiscovery;
+    try {
+      discovery = JSON.parse(readFileSync(discoveryPath, 'utf8'));
+    } catch {
+      return null;
+    }
+
+    const request = {
+      jsonrpc: '2.0',
+      id: 1,
+      method,
+      params: { ...params, token: discovery.token },
+    };
+
+    let response: any;
+    try {
+      response = await new Promise((resolve, reject) => {
+        const socket = createConnection({ host: '127.0.0.1', port: discovery.port });
+        let buffer = '';
+
+        socket.setTimeout(EDITOR_RPC_TIMEOUT_MS, () => {
+          socket.destroy();
+          reject(new Error('Editor RPC timed out'));
+        });
+        socket.on('connect', () => socket.write(JSON.stringify(request) + '\n'));
+        socket.on('data', (chunk) => {
+          buffer += chunk.toString('utf8');
+          const newline = buffer.indexOf('\n');
+          if (newline !== -1) {
+            socket.end();
+            try {
+              resolve(JSON.parse(buffer.slice(0, newline)));
+            } catch (error) {
+              reject(error);
+            }
+          }
+        });
+        socket.on('error', reject);
+      });
+    } catch (error: any) {
+      // Stale discovery file or editor busy: fall back to a headless process
+      this.logDebug(`Editor RPC unavailable, falling back to headless Godot: ${error?.message}`);
+      return null;
+    }
+
+    if (response.error) {
+      return { stdout: '', stderr: `Failed to ${operation}: ${response.error.message}` };
+    }
+
+    return { stdout: `Completed in the running editor: ${JSON.stringify(response.result)}`, stderr: '' };
+  }
+
   /**
    * Get the structure of a Godot project
    * @param projectPath Path to the Godot project
@@ -7,10 +7,22 @@ def configure(env):
 def get_doc_classes():
     return [
         "VectorAI",
+        "VectorAIBatch",
         "VectorAIDock",
         "GeminiClient",
         "SceneAnalyzer",
         "SceneModifier",
+        "SceneSpatialIndex",
+        "ScriptSummaryCache",
+        "TileGridCodec",
+        "ModelRouter",
+        "ModificationJournal",
+        "ProjectIndex",
+        "TokenEstimator",
+        "UsageLedger",
+        "VectorAIProfiler",
+        "VectorAIRPCServer",
+        "VectorAITracer",
     ]
 
 def get_doc_path():
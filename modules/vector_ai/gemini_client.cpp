@@ -34,79 +34,269 @@
 #include "core/io/file_access.h"
 #include "core/io/http_request.h"
 #include "core/io/json.h"
+#include "core/os/os.h"
 #include "editor/editor_paths.h"
+#include "gemini_response_reader.h"
+#include "vector_ai_profiler.h"
+#include "vector_ai_tracer.h"
 
 void GeminiClient::_notification(int p_what) {
     switch (p_what) {
-        case NOTIFICATION_READY: {
-            http_request = memnew(HTTPRequest);
-            http_request->connect("request_completed", callable_mp(this, &GeminiClient::_on_request_completed));
-            add_child(http_request);
+        case NOTIFICATION_PROCESS: {
+            if (stream_state != STREAM_NONE) {
+                _poll_stream();
+            } else {
+                _update_trace_stage();
+            }
+        } break;
+    }
+}
+
+void GeminiClient::_set_trace_stage(TraceStage p_stage) {
+    static const char *stage_names[] = { "", "queueing", "connect", "first_byte", "last_byte" };
+
+    if (p_stage == trace_stage) {
+        return;
+    }
+
+    VectorAITracer *tracer = VectorAITracer::get_singleton();
+    if (tracer) {
+        if (trace_stage != TRACE_STAGE_NONE) {
+            tracer->end_span(stage_names[trace_stage]);
+        }
+        if (p_stage == TRACE_STAGE_LAST_BYTE) {
+            tracer->instant("first_byte_received");
+        }
+        if (p_stage != TRACE_STAGE_NONE) {
+            tracer->begin_span(stage_names[p_stage]);
+        }
+    }
+
+    trace_stage = p_stage;
+    set_process(trace_stage != TRACE_STAGE_NONE || stream_state != STREAM_NONE);
+}
+
+void GeminiClient::_update_trace_stage() {
+    if (trace_stage == TRACE_STAGE_NONE || !http_request) {
+        return;
+    }
+
+    // HTTPRequest has no per-stage signals, so stages are sampled once per frame
+    switch (http_request->get_http_client_status()) {
+        case HTTPClient::STATUS_RESOLVING:
+        case HTTPClient::STATUS_CONNECTING: {
+            _set_trace_stage(TRACE_STAGE_CONNECT);
+        } break;
+        case HTTPClient::STATUS_CONNECTED:
+        case HTTPClient::STATUS_REQUESTING: {
+            _set_trace_stage(TRACE_STAGE_FIRST_BYTE);
+        } break;
+        case HTTPClient::STATUS_BODY: {
+            if (http_request->get_downloaded_bytes() > 0) {
+                _set_trace_stage(TRACE_STAGE_LAST_BYTE);
+            } else {
+                _set_trace_stage(TRACE_STAGE_FIRST_BYTE);
+            }
+        } break;
+        default: {
         } break;
     }
 }
 
 void GeminiClient::_bind_methods() {
     ClassDB::bind_method(D_METHOD("load_settings"), &GeminiClient::load_settings);
+    ClassDB::bind_static_method("GeminiClient", D_METHOD("get_shared_settings"), &GeminiClient::get_shared_settings);
     ClassDB::bind_method(D_METHOD("save_settings", "settings"), &GeminiClient::save_settings);
     ClassDB::bind_method(D_METHOD("send_request", "user_input", "scene_info", "callback"), &GeminiClient::send_request);
+    ClassDB::bind_method(D_METHOD("estimate_prompt_tokens", "user_input", "scene_info"), &GeminiClient::estimate_prompt_tokens);
+    ClassDB::bind_method(D_METHOD("get_last_token_breakdown"), &GeminiClient::get_last_token_breakdown);
+    ClassDB::bind_method(D_METHOD("get_token_estimator"), &GeminiClient::get_token_estimator);
+    ClassDB::bind_method(D_METHOD("get_usage_ledger"), &GeminiClient::get_usage_ledger);
+    ClassDB::bind_method(D_METHOD("get_model_router"), &GeminiClient::get_model_router);
+    ClassDB::bind_method(D_METHOD("get_last_routing"), &GeminiClient::get_last_routing);
+    ClassDB::bind_method(D_METHOD("get_last_usage"), &GeminiClient::get_last_usage);
+    ClassDB::bind_method(D_METHOD("set_tool_handler", "handler", "declarations"), &GeminiClient::set_tool_handler);
+    ClassDB::bind_method(D_METHOD("is_tool_calling_active"), &GeminiClient::is_tool_calling_active);
+    ClassDB::bind_method(D_METHOD("is_request_active"), &GeminiClient::is_request_active);
+    ClassDB::bind_method(D_METHOD("set_modification_handler", "handler"), &GeminiClient::set_modification_handler);
+    ClassDB::bind_method(D_METHOD("is_streaming_active"), &GeminiClient::is_streaming_active);
+    ClassDB::bind_method(D_METHOD("set_candidate_validator", "validator"), &GeminiClient::set_candidate_validator);
+    ClassDB::bind_method(D_METHOD("is_multi_candidate_active"), &GeminiClient::is_multi_candidate_active);
+    ClassDB::bind_method(D_METHOD("set_project_index", "index"), &GeminiClient::set_project_index);
+    ClassDB::bind_method(D_METHOD("get_project_index"), &GeminiClient::get_project_index);
     ClassDB::bind_method(D_METHOD("_on_request_completed"), &GeminiClient::_on_request_completed);
+    ClassDB::bind_method(D_METHOD("_on_classifier_completed"), &GeminiClient::_on_classifier_completed);
+    ClassDB::bind_method(D_METHOD("_on_count_tokens_completed"), &GeminiClient::_on_count_tokens_completed);
+}
+
+HTTPRequest *GeminiClient::_get_request(HTTPRequest *&r_request, void (GeminiClient::*p_callback)(int, int, const PackedStringArray &, const PackedByteArray &)) {
+    // HTTP nodes are only built once a request actually needs them
+    if (!r_request) {
+        r_request = memnew(HTTPRequest);
+        r_request->connect("request_completed", callable_mp(this, p_callback));
+        add_child(r_request);
+    }
+    return r_request;
 }
 
-String GeminiClient::_get_settings_path() const {
+String GeminiClient::_get_settings_path() {
     return EditorPaths::get_singleton()->get_config_dir().path_join("vector_ai_settings.json");
 }
 
+Dictionary *GeminiClient::shared_settings = nullptr;
+
+Dictionary GeminiClient::get_shared_settings() {
+    // The settings file is read once per editor session; clients share the parsed copy
+    if (!shared_settings) {
+        shared_settings = memnew(Dictionary);
+
+        Ref<FileAccess> f = FileAccess::open(_get_settings_path(), FileAccess::READ);
+        if (f.is_valid()) {
+            JSON json;
+            if (json.parse(f->get_as_text()) == OK && json.get_data().get_type() == Variant::DICTIONARY) {
+                *shared_settings = json.get_data();
+            }
+        }
+    }
+
+    return shared_settings->duplicate();
+}
+
+void GeminiClient::free_shared_settings() {
+    if (shared_settings) {
+        memdelete(shared_settings);
+        shared_settings = nullptr;
+    }
+}
+
 Dictionary GeminiClient::load_settings() {
-    Dictionary settings;
+    Dictionary settings = get_shared_settings();
+    settings_loaded = true;
 
-    String settings_path = _get_settings_path();
-    Ref<FileAccess> f = FileAccess::open(settings_path, FileAccess::READ);
+    if (!settings.is_empty()) {
+        if (settings.has("model")) {
+            model = settings["model"];
+        }
 
-    if (f.is_valid()) {
-        String json_text = f->get_as_text();
+        if (settings.has("fast_model")) {
+            fast_model = settings["fast_model"];
+        }
 
-        JSON json;
-        Error err = json.parse(json_text);
+        if (settings.has("routing_mode")) {
+            routing_mode = settings["routing_mode"];
+        }
 
-        if (err == OK) {
-            settings = json.get_data();
+        if (settings.has("temperature")) {
+            temperature = settings["temperature"];
+        }
 
-            if (settings.has("model")) {
-                model = settings["model"];
-            }
+        if (settings.has("max_output_tokens")) {
+            max_output_tokens = settings["max_output_tokens"];
+        }
 
-            if (settings.has("temperature")) {
-                temperature = settings["temperature"];
-            }
+        if (settings.has("prompt_token_budget")) {
+            prompt_token_budget = settings["prompt_token_budget"];
+        }
 
-            if (settings.has("max_output_tokens")) {
-                max_output_tokens = settings["max_output_tokens"];
-            }
+        if (settings.has("dev_mode")) {
+            dev_mode = settings["dev_mode"];
+        }
 
-            if (settings.has("dev_mode")) {
-                dev_mode = settings["dev_mode"];
-            }
+        if (settings.has("trace_enabled")) {
+            trace_enabled = settings["trace_enabled"];
+        }
 
-            if (settings.has("api_key")) {
-                api_key = settings["api_key"];
-            }
+        if (settings.has("tool_calling")) {
+            tool_calling = settings["tool_calling"];
+        }
 
-            if (settings.has("proxy_url")) {
-                proxy_url = settings["proxy_url"];
-            }
+        if (settings.has("max_tool_rounds")) {
+            max_tool_rounds = settings["max_tool_rounds"];
+        }
+
+        if (settings.has("rpc_enabled")) {
+            rpc_enabled = settings["rpc_enabled"];
+        }
+
+        if (settings.has("rpc_port")) {
+            rpc_port = settings["rpc_port"];
+        }
+
+        if (settings.has("float_precision")) {
+            float_precision = settings["float_precision"];
+        }
+
+        if (settings.has("retrieval_enabled")) {
+            retrieval_enabled = settings["retrieval_enabled"];
+        }
+
+        if (settings.has("retrieval_token_budget")) {
+            retrieval_token_budget = settings["retrieval_token_budget"];
+        }
+
+        if (settings.has("stream_responses")) {
+            stream_responses = settings["stream_responses"];
+        }
+
+        if (settings.has("max_continuations")) {
+            max_continuations = settings["max_continuations"];
+        }
+
+        if (settings.has("candidate_count")) {
+            candidate_count = settings["candidate_count"];
+        }
+
+        if (settings.has("undo_memory_cap_mb")) {
+            undo_memory_cap_mb = settings["undo_memory_cap_mb"];
+        }
+
+        if (settings.has("api_key")) {
+            api_key = settings["api_key"];
+        }
+
+        if (settings.has("proxy_url")) {
+            proxy_url = settings["proxy_url"];
+        }
+
+        if (settings.has("pricing") && settings["pricing"].get_type() == Variant::DICTIONARY) {
+            pricing_overrides = settings["pricing"];
+            usage_ledger->set_pricing(pricing_overrides);
+        }
+
+        if (settings.has("debug_dictionary_body")) {
+            debug_dictionary_body = settings["debug_dictionary_body"];
         }
     } else {
         // Create default settings
         settings["model"] = model;
+        settings["fast_model"] = fast_model;
+        settings["routing_mode"] = routing_mode;
         settings["temperature"] = temperature;
         settings["max_output_tokens"] = max_output_tokens;
+        settings["prompt_token_budget"] = prompt_token_budget;
         settings["dev_mode"] = dev_mode;
+        settings["trace_enabled"] = trace_enabled;
+        settings["tool_calling"] = tool_calling;
+        settings["max_tool_rounds"] = max_tool_rounds;
+        settings["rpc_enabled"] = rpc_enabled;
+        settings["rpc_port"] = rpc_port;
+        settings["float_precision"] = float_precision;
+        settings["retrieval_enabled"] = retrieval_enabled;
+        settings["retrieval_token_budget"] = retrieval_token_budget;
+        settings["stream_responses"] = stream_responses;
+        settings["max_continuations"] = max_continuations;
+        settings["candidate_count"] = candidate_count;
+        settings["undo_memory_cap_mb"] = undo_memory_cap_mb;
         settings["proxy_url"] = proxy_url;
 
         save_settings(settings);
     }
 
+    VectorAITracer *tracer = VectorAITracer::get_singleton();
+    if (tracer) {
+        tracer->set_enabled(trace_enabled);
+    }
+
     return settings;
 }
 
@@ -115,6 +305,14 @@ void GeminiClient::save_settings(const Dictionary &p_settings) {
         model = p_settings["model"];
     }
 
+    if (p_settings.has("fast_model")) {
+        fast_model = p_settings["fast_model"];
+    }
+
+    if (p_settings.has("routing_mode")) {
+        routing_mode = p_settings["routing_mode"];
+    }
+
     if (p_settings.has("temperature")) {
         temperature = p_settings["temperature"];
     }
@@ -123,29 +321,118 @@ void GeminiClient::save_settings(const Dictionary &p_settings) {
         max_output_tokens = p_settings["max_output_tokens"];
     }
 
+    if (p_settings.has("prompt_token_budget")) {
+        prompt_token_budget = p_settings["prompt_token_budget"];
+    }
+
     if (p_settings.has("dev_mode")) {
         dev_mode = p_settings["dev_mode"];
     }
 
+    if (p_settings.has("trace_enabled")) {
+        trace_enabled = p_settings["trace_enabled"];
+    }
+
+    if (p_settings.has("tool_calling")) {
+        tool_calling = p_settings["tool_calling"];
+    }
+
+    if (p_settings.has("max_tool_rounds")) {
+        max_tool_rounds = p_settings["max_tool_rounds"];
+    }
+
+    if (p_settings.has("rpc_enabled")) {
+        rpc_enabled = p_settings["rpc_enabled"];
+    }
+
+    if (p_settings.has("rpc_port")) {
+        rpc_port = p_settings["rpc_port"];
+    }
+
+    if (p_settings.has("float_precision")) {
+        float_precision = p_settings["float_precision"];
+    }
+
+    if (p_settings.has("retrieval_enabled")) {
+        retrieval_enabled = p_settings["retrieval_enabled"];
+    }
+
+    if (p_settings.has("retrieval_token_budget")) {
+        retrieval_token_budget = p_settings["retrieval_token_budget"];
+    }
+
+    if (p_settings.has("stream_responses")) {
+        stream_responses = p_settings["stream_responses"];
+    }
+
+    if (p_settings.has("max_continuations")) {
+        max_continuations = p_settings["max_continuations"];
+    }
+
+    if (p_settings.has("candidate_count")) {
+        candidate_count = p_settings["candidate_count"];
+    }
+
+    if (p_settings.has("undo_memory_cap_mb")) {
+        undo_memory_cap_mb = p_settings["undo_memory_cap_mb"];
+    }
+
     if (p_settings.has("api_key")) {
         api_key = p_settings["api_key"];
     }
 
+    VectorAITracer *tracer = VectorAITracer::get_singleton();
+    if (tracer) {
+        tracer->set_enabled(trace_enabled);
+    }
+
     if (p_settings.has("proxy_url")) {
         proxy_url = p_settings["proxy_url"];
     }
 
+    if (p_settings.has("pricing") && p_settings["pricing"].get_type() == Variant::DICTIONARY) {
+        pricing_overrides = p_settings["pricing"];
+        usage_ledger->set_pricing(pricing_overrides);
+    }
+
+    if (p_settings.has("debug_dictionary_body")) {
+        debug_dictionary_body = p_settings["debug_dictionary_body"];
+    }
+
     String settings_path = _get_settings_path();
     Ref<FileAccess> f = FileAccess::open(settings_path, FileAccess::WRITE);
 
     if (f.is_valid()) {
         Dictionary settings_to_save;
         settings_to_save["model"] = model;
+        settings_to_save["fast_model"] = fast_model;
+        settings_to_save["routing_mode"] = routing_mode;
         settings_to_save["temperature"] = temperature;
         settings_to_save["max_output_tokens"] = max_output_tokens;
+        settings_to_save["prompt_token_budget"] = prompt_token_budget;
         settings_to_save["dev_mode"] = dev_mode;
+        settings_to_save["trace_enabled"] = trace_enabled;
+        settings_to_save["tool_calling"] = tool_calling;
+        settings_to_save["max_tool_rounds"] = max_tool_rounds;
+        settings_to_save["rpc_enabled"] = rpc_enabled;
+        settings_to_save["rpc_port"] = rpc_port;
+        settings_to_save["float_precision"] = float_precision;
+        settings_to_save["retrieval_enabled"] = retrieval_enabled;
+        settings_to_save["retrieval_token_budget"] = retrieval_token_budget;
+        settings_to_save["stream_responses"] = stream_responses;
+        settings_to_save["max_continuations"] = max_continuations;
+        settings_to_save["candidate_count"] = candidate_count;
+        settings_to_save["undo_memory_cap_mb"] = undo_memory_cap_mb;
         settings_to_save["proxy_url"] = proxy_url;
 
+        if (!pricing_overrides.is_empty()) {
+            settings_to_save["pricing"] = pricing_overrides;
+        }
+
+        if (debug_dictionary_body) {
+            settings_to_save["debug_dictionary_body"] = true;
+        }
+
         if (dev_mode && !api_key.is_empty()) {
             settings_to_save["api_key"] = api_key;
         }
@@ -153,20 +440,19 @@ void GeminiClient::save_settings(const Dictionary &p_settings) {
         JSON json;
         String json_text = json.stringify(settings_to_save, "    ");
         f->store_string(json_text);
-    }
-}
 
-void GeminiClient::send_request(const String &p_user_input, const String &p_scene_info, const Callable &p_callback) {
-    if (dev_mode && api_key.is_empty()) {
-        Dictionary response;
-        p_callback.call(response, "API key not set. Please set it in the settings.");
-        return;
+        if (!shared_settings) {
+            shared_settings = memnew(Dictionary);
+        }
+        *shared_settings = settings_to_save;
     }
+}
 
-    current_callback = p_callback;
+static const char *SCENE_HEADER = "Current scene structure:\n";
+static const char *CONTINUE_PROMPT = "Your answer was cut off by the output limit. Continue exactly where it stopped, without repeating anything already written.";
 
-    // Prepare the prompt
-    String system_prompt = R"(
+String GeminiClient::_get_system_prompt() {
+    return R"(
 You are Vector AI, an AI assistant that helps users modify their Godot scenes based on natural language prompts.
 You have access to the current scene structure and can suggest modifications to it.
 
@@ -180,63 +466,702 @@ MODIFICATIONS:
 
 EXPLANATION:
 [Explanation of why these modifications were made and how they address the user's request]
+
+Tile layers are listed with a palette and run-length rows written as "y[..y2] @x: id*count", where "." is an empty cell.
+To change tiles, write one modification line per layer with the changed rows separated by ";", for example:
+Level/Ground: tile_rle=8..9 @0: 1*3 .*2 2*10; 12 @4: .
+Use tile_rle/<layer> for the layers of a TileMap node. Ids come from the layer's palette; a tile can also be given as source:atlas_x,atlas_y.
+Integer grids are shown as Grid(WxH; y[..y2]: value*count ...) and can be set back in the same notation.
+To change many nodes at once, write one rule line instead of one line per node:
+@select class=Sprite2D group=enemies: modulate=#ff0000; scale=(2, 2)
+Selector terms (all optional, combined with AND): class=<type, subclasses included>, group=<group>, name=<glob such as Enemy*>,
+under=<node path whose subtree is searched>, region=(x, y, w, h) in 2D or region=(x, y, z, w, h, d) in 3D.
 )";
+}
+
+Dictionary GeminiClient::_enforce_token_budget(const String &p_system_prompt, String &r_scene_info, const String &p_user_input) {
+    Dictionary breakdown;
+
+    int system_tokens = token_estimator->estimate_tokens(p_system_prompt);
+    int user_tokens = token_estimator->estimate_tokens(p_user_input);
+    int scene_tokens = token_estimator->estimate_tokens(r_scene_info);
+    int original_scene_tokens = scene_tokens;
+    int trimmed_lines = 0;
+    bool over_budget = false;
+
+    if (prompt_token_budget > 0 && system_tokens + scene_tokens + user_tokens > prompt_token_budget) {
+        int scene_budget = prompt_token_budget - system_tokens - user_tokens;
+
+        if (scene_budget <= 0) {
+            over_budget = true;
+        } else {
+            Dictionary trim = token_estimator->trim_outline_to_budget(r_scene_info, scene_budget);
+            r_scene_info = trim["text"];
+            scene_tokens = trim["tokens"];
+            trimmed_lines = trim["trimmed_lines"];
+        }
+    }
+
+    breakdown["system"] = system_tokens;
+    breakdown["scene"] = scene_tokens;
+    breakdown["scene_untrimmed"] = original_scene_tokens;
+    breakdown["user"] = user_tokens;
+    breakdown["total"] = system_tokens + scene_tokens + user_tokens;
+    breakdown["budget"] = prompt_token_budget;
+    breakdown["trimmed_lines"] = trimmed_lines;
+    breakdown["over_budget"] = over_budget;
+    breakdown["calibration_factor"] = token_estimator->get_calibration_factor();
+
+    return breakdown;
+}
+
+void GeminiClient::_request_token_count(const String &p_prompt) {
+    HTTPRequest *request = _get_request(count_tokens_request, &GeminiClient::_on_count_tokens_completed);
+    if (request->get_http_client_status() != HTTPClient::STATUS_DISCONNECTED) {
+        return;
+    }
+
+    String url = "https://generativelanguage.googleapis.com/v1/models/" + current_model + ":countTokens?key=" + api_key;
+    PackedStringArray headers;
+    headers.push_back("Content-Type: application/json");
 
-    String scene_prompt = "Current scene structure:\n" + p_scene_info;
+    Dictionary part;
+    part["text"] = p_prompt;
+    Array parts;
+    parts.push_back(part);
+    Dictionary message;
+    message["role"] = "user";
+    message["parts"] = parts;
+    Array contents;
+    contents.push_back(message);
 
     Dictionary request_data;
+    request_data["contents"] = contents;
+
+    count_tokens_estimate_raw = token_estimator->estimate_raw(p_prompt);
+
+    JSON json;
+    request->request(url, headers, HTTPClient::METHOD_POST, json.stringify(request_data));
+}
+
+void GeminiClient::_on_count_tokens_completed(int p_result, int p_code, const PackedStringArray &p_headers, const PackedByteArray &p_body) {
+    if (p_result != HTTPRequest::RESULT_SUCCESS || p_code != 200) {
+        return;
+    }
+
+    JSON json;
+    if (json.parse(String::utf8((const char *)p_body.ptr(), p_body.size())) != OK || json.get_data().get_type() != Variant::DICTIONARY) {
+        return;
+    }
+
+    Dictionary response_data = json.get_data();
+    if (response_data.has("totalTokens")) {
+        token_estimator->add_calibration_sample(count_tokens_estimate_raw, response_data["totalTokens"]);
+    }
+}
+
+Dictionary GeminiClient::estimate_prompt_tokens(const String &p_user_input, const String &p_scene_info) {
+    if (!settings_loaded) {
+        load_settings();
+    }
+
+    String scene_info = p_scene_info;
+    return _enforce_token_budget(_get_system_prompt(), scene_info, p_user_input);
+}
+
+Dictionary GeminiClient::get_last_token_breakdown() const {
+    return last_token_breakdown;
+}
+
+Ref<TokenEstimator> GeminiClient::get_token_estimator() const {
+    return token_estimator;
+}
+
+Dictionary GeminiClient::_extract_usage(const Dictionary &p_response_data) const {
+    Dictionary usage;
+
+    if (p_response_data.has("usageMetadata") && p_response_data["usageMetadata"].get_type() == Variant::DICTIONARY) {
+        // Direct Gemini API (or a proxy passing the metadata through)
+        Dictionary metadata = p_response_data["usageMetadata"];
+        int64_t prompt_tokens = metadata.get("promptTokenCount", 0);
+        int64_t candidates_tokens = metadata.get("candidatesTokenCount", 0);
+
+        usage["source"] = "api";
+        usage["prompt_tokens"] = prompt_tokens;
+        usage["candidates_tokens"] = candidates_tokens;
+        usage["cached_tokens"] = metadata.get("cachedContentTokenCount", 0);
+        usage["total_tokens"] = metadata.get("totalTokenCount", prompt_tokens + candidates_tokens);
+    } else if (p_response_data.has("usage") && p_response_data["usage"].get_type() == Variant::DICTIONARY) {
+        // Counts reported by our proxy server
+        Dictionary proxy_usage = p_response_data["usage"];
+        int64_t prompt_tokens = proxy_usage.get("prompt_tokens", proxy_usage.get("input_tokens", 0));
+        int64_t candidates_tokens = proxy_usage.get("candidates_tokens", proxy_usage.get("completion_tokens", proxy_usage.get("output_tokens", 0)));
+
+        usage["source"] = "proxy";
+        usage["prompt_tokens"] = prompt_tokens;
+        usage["candidates_tokens"] = candidates_tokens;
+        usage["cached_tokens"] = proxy_usage.get("cached_tokens", 0);
+        usage["total_tokens"] = proxy_usage.get("total_tokens", prompt_tokens + candidates_tokens);
+
+        if (proxy_usage.has("cost")) {
+            usage["cost"] = proxy_usage["cost"];
+        }
+    }
+
+    return usage;
+}
+
+void GeminiClient::_record_usage(const Dictionary &p_response_data) {
+    // Account for the tokens used; the actual prompt size also keeps the local estimator calibrated
+    Dictionary usage = _extract_usage(p_response_data);
+    if (!usage.is_empty()) {
+        last_usage = usage_ledger->record(current_model, usage, current_user_input);
+
+        if ((int64_t)usage["prompt_tokens"] > 0 && last_prompt_estimate_raw > 0) {
+            token_estimator->add_calibration_sample(last_prompt_estimate_raw, usage["prompt_tokens"]);
+        }
+    }
+}
+
+Ref<UsageLedger> GeminiClient::get_usage_ledger() const {
+    return usage_ledger;
+}
+
+Dictionary GeminiClient::get_last_usage() const {
+    return last_usage;
+}
+
+Ref<ModelRouter> GeminiClient::get_model_router() const {
+    return model_router;
+}
+
+Dictionary GeminiClient::get_last_routing() const {
+    return current_routing;
+}
+
+void GeminiClient::set_tool_handler(const Callable &p_handler, const Array &p_declarations) {
+    tool_handler = p_handler;
+    tool_declarations = p_declarations;
+}
+
+bool GeminiClient::is_tool_calling_active() const {
+    // The proxy has no function calling support, so this needs direct API access
+    return tool_calling && dev_mode && tool_handler.is_valid() && !tool_declarations.is_empty();
+}
+
+bool GeminiClient::is_request_active() const {
+    // The callback is held from send_request until the final response or error
+    return current_callback.is_valid();
+}
+
+void GeminiClient::set_project_index(const Ref<ProjectIndex> &p_index) {
+    project_index = p_index;
+}
+
+Ref<ProjectIndex> GeminiClient::get_project_index() const {
+    return project_index;
+}
+
+void GeminiClient::send_request(const String &p_user_input, const String &p_scene_info, const Callable &p_callback) {
+    // Settings are applied on first use rather than at construction
+    if (!settings_loaded) {
+        load_settings();
+    }
+
+    if (dev_mode && api_key.is_empty()) {
+        Dictionary response;
+        p_callback.call(response, "API key not set. Please set it in the settings.");
+        return;
+    }
+
+    // One request at a time: a second one would take over the stream, the callback and the timings
+    if (is_request_active()) {
+        Dictionary response;
+        p_callback.call(response, "A request is already in progress.");
+        return;
+    }
+
+    current_callback = p_callback;
+    current_user_input = p_user_input;
+    current_scene_info = p_scene_info;
+    last_usage = Dictionary();
+    tool_conversation.clear();
+    tool_log.clear();
+    tool_rounds = 0;
+    continuation_text = String();
+    continuation_rounds = 0;
+    candidate_retries = 0;
+    last_candidate_choice = Dictionary();
+    request_start_usec = 0;
+
+    // Pick the model tier for this request
+    if (routing_mode == "off") {
+        current_routing = Dictionary();
+        current_routing["tier"] = ModelRouter::get_tier_name(ModelRouter::TIER_HEAVY);
+        current_routing["source"] = "fixed";
+    } else {
+        current_routing = model_router->classify(p_user_input, p_scene_info);
+
+        // An unsure heuristic asks the fast model to classify; only possible with direct API access
+        if (routing_mode == "classifier" && dev_mode && !(bool)current_routing["confident"]) {
+            _request_classification();
+            return;
+        }
+    }
+
+    _dispatch_request(_get_routed_model());
+}
+
+String GeminiClient::_get_routed_model() const {
+    if (String(current_routing.get("tier", "")) == ModelRouter::get_tier_name(ModelRouter::TIER_FAST) && !fast_model.is_empty()) {
+        return fast_model;
+    }
+    return model;
+}
+
+void GeminiClient::_request_classification() {
+    String url = "https://generativelanguage.googleapis.com/v1/models/" + fast_model + ":generateContent?key=" + api_key;
+    PackedStringArray headers;
+    headers.push_back("Content-Type: application/json");
+
+    Dictionary part;
+    part["text"] = model_router->get_classifier_prompt(current_user_input);
+    Array parts;
+    parts.push_back(part);
+    Dictionary message;
+    message["role"] = "user";
+    message["parts"] = parts;
+    Array contents;
+    contents.push_back(message);
+
+    Dictionary generation_config;
+    generation_config["temperature"] = 0.0;
+    generation_config["maxOutputTokens"] = 4;
+
+    Dictionary request_data;
+    request_data["contents"] = contents;
+    request_data["generationConfig"] = generation_config;
+
+    classifier_start_usec = OS::get_singleton()->get_ticks_usec();
+
+    Error err = _get_request(classifier_request, &GeminiClient::_on_classifier_completed)->request(url, headers, HTTPClient::METHOD_POST, JSON::stringify(request_data));
+    if (err != OK) {
+        // Fall back to the heuristic decision
+        _dispatch_request(_get_routed_model());
+    }
+}
+
+void GeminiClient::_on_classifier_completed(int p_result, int p_code, const PackedStringArray &p_headers, const PackedByteArray &p_body) {
+    if (current_callback.is_null()) {
+        return;
+    }
+
+    double classifier_msec = (OS::get_singleton()->get_ticks_usec() - classifier_start_usec) / 1000.0;
+
+    String answer;
+    if (p_result == HTTPRequest::RESULT_SUCCESS && p_code == 200) {
+        GeminiResponseReader response_reader;
+        if (response_reader.feed(p_body.ptr(), p_body.size()) == OK && response_reader.finish() == OK) {
+            answer = response_reader.get_text();
+        }
+    }
+
+    bool valid = false;
+    ModelRouter::Tier tier = model_router->parse_classifier_response(answer, valid);
+    if (valid) {
+        current_routing["tier"] = ModelRouter::get_tier_name(tier);
+        current_routing["source"] = "classifier";
+    }
+    current_routing["classifier_ms"] = classifier_msec;
+
+    _dispatch_request(_get_routed_model());
+}
+
+void GeminiClient::_dispatch_request(const String &p_model) {
+    current_model = p_model;
+    current_routing["model"] = p_model;
+
+    VectorAIProfiler *profiler = VectorAIProfiler::get_singleton();
+    if (profiler) {
+        profiler->begin_phase(VectorAIProfiler::PHASE_SERIALIZE);
+    }
+
+    VectorAITracer *tracer = VectorAITracer::get_singleton();
+    if (tracer) {
+        tracer->begin_span("serialization");
+    }
+
+    // Prepare the prompt
+    String system_prompt = _get_system_prompt();
+
+    // Estimate the prompt locally and trim the scene context before anything is uploaded
+    String scene_info = current_scene_info;
+    last_token_breakdown = _enforce_token_budget(system_prompt, scene_info, current_user_input);
+
+    if (last_token_breakdown["over_budget"]) {
+        if (tracer) {
+            tracer->end_span("serialization");
+        }
+
+        Dictionary response;
+        Callable callback = current_callback;
+        current_callback = Callable();
+        callback.call(response, vformat("Prompt exceeds the token budget (%d estimated, %d allowed) even without scene context.", (int)last_token_breakdown["total"], prompt_token_budget));
+        return;
+    }
+
+    // Related files from the project index, within whatever the scene context left of the budget
+    if (retrieval_enabled && project_index.is_valid() && project_index->is_started()) {
+        int retrieval_budget = retrieval_token_budget;
+        if (prompt_token_budget > 0) {
+            retrieval_budget = MIN(retrieval_budget, prompt_token_budget - (int)last_token_breakdown["total"]);
+        }
+
+        String related = retrieval_budget > 0 ? project_index->build_context(current_user_input, retrieval_budget, token_estimator) : String();
+        if (!related.is_empty()) {
+            scene_info += "\n\nRelated project files (retrieved by relevance to the request):\n" + related;
+            int retrieval_tokens = token_estimator->estimate_tokens(related);
+            last_token_breakdown["retrieval"] = retrieval_tokens;
+            last_token_breakdown["total"] = (int)last_token_breakdown["total"] + retrieval_tokens;
+        }
+    }
+
+    // The prompt is sent as one user message since the system role isn't supported; its pieces are
+    // kept apart and only joined where a String is actually needed
+    current_system_prompt = system_prompt;
+    current_prompt_scene = scene_info;
+    current_prompt_intro = system_prompt + "\n\n";
+    if (dev_mode && is_tool_calling_active()) {
+        current_prompt_intro = system_prompt + "\nThe scene structure below is only an outline. Call the provided functions to inspect children, properties and scripts before modifying nodes you have not seen.\n\n";
+    }
+
+    if (dev_mode) {
+        last_prompt_estimate_raw = token_estimator->estimate_raw(current_prompt_intro) + token_estimator->estimate_raw(SCENE_HEADER) + token_estimator->estimate_raw(scene_info) + token_estimator->estimate_raw(current_user_input);
+
+        if (token_estimator->needs_calibration()) {
+            _request_token_count(current_prompt_intro + SCENE_HEADER + scene_info + "\n\n" + current_user_input);
+        }
+
+        if (is_tool_calling_active()) {
+            // Kept so follow-up rounds can replay the conversation
+            tool_conversation.clear();
+            tool_conversation.push_back(_make_prompt_message());
+            tool_generation_config = _make_generation_config();
+        }
+    } else {
+        last_prompt_estimate_raw = token_estimator->estimate_raw(system_prompt) + token_estimator->estimate_raw(SCENE_HEADER) + token_estimator->estimate_raw(scene_info) + token_estimator->estimate_raw(current_user_input);
+    }
+
+    Error err = _send_generation();
+    if (err != OK) {
+        Dictionary response;
+        Callable callback = current_callback;
+        current_callback = Callable();
+        callback.call(response, "HTTP Request Error: " + itos(err));
+    }
+}
+
+Dictionary GeminiClient::_make_prompt_message() const {
+    Dictionary user_message;
+    user_message["role"] = "user";
+    Array user_parts;
+    Dictionary user_part;
+    user_part["text"] = current_prompt_intro + SCENE_HEADER + current_prompt_scene + "\n\n" + current_user_input;
+    user_parts.push_back(user_part);
+    user_message["parts"] = user_parts;
+    return user_message;
+}
+
+Dictionary GeminiClient::_make_generation_config() const {
+    Dictionary generation_config;
+    generation_config["temperature"] = temperature;
+    generation_config["maxOutputTokens"] = max_output_tokens;
+    generation_config["topP"] = 0.95;
+    generation_config["topK"] = 64;
+
+    // Continuations extend the one candidate that was chosen
+    if (is_multi_candidate_active() && continuation_text.is_empty()) {
+        generation_config["candidateCount"] = candidate_count;
+    }
+    return generation_config;
+}
+
+Error GeminiClient::_send_generation() {
     String url;
     PackedStringArray headers;
     headers.push_back("Content-Type: application/json");
 
+    bool use_tools = dev_mode && is_tool_calling_active();
+    Dictionary generation_config;
+    Array tool_list;
+
     if (dev_mode) {
         // Direct API call for development/testing
-        url = "https://generativelanguage.googleapis.com/v1/models/" + model + ":generateContent?key=" + api_key;
-
-        // Prepare the direct API request body
-        Array contents;
-
-        // Combine all prompts into a single user message since system role isn't supported
-        String combined_prompt = system_prompt + "\n\n" + scene_prompt + "\n\n" + p_user_input;
-
-        Dictionary user_message;
-        user_message["role"] = "user";
-        Array user_parts;
-        Dictionary user_part;
-        user_part["text"] = combined_prompt;
-        user_parts.push_back(user_part);
-        user_message["parts"] = user_parts;
-        contents.push_back(user_message);
-
-        Dictionary generation_config;
-        generation_config["temperature"] = temperature;
-        generation_config["maxOutputTokens"] = max_output_tokens;
-        generation_config["topP"] = 0.95;
-        generation_config["topK"] = 64;
-
-        request_data["contents"] = contents;
-        request_data["generationConfig"] = generation_config;
+        url = "https://generativelanguage.googleapis.com/" + String(use_tools ? "v1beta" : "v1") + "/models/" + current_model + ":generateContent?key=" + api_key;
+        if (is_streaming_active()) {
+            url = "https://generativelanguage.googleapis.com/v1/models/" + current_model + ":streamGenerateContent?alt=sse&key=" + api_key;
+        }
+
+        generation_config = _make_generation_config();
+
+        if (use_tools) {
+            Dictionary tools;
+            tools["functionDeclarations"] = tool_declarations;
+            tool_list.push_back(tools);
+        }
     } else {
         // Proxy server call for production
         url = proxy_url;
+    }
+
+    // Continuation rounds resend the prompt unchanged, so the API can serve it from its prefix
+    // cache, followed by the answer so far and a request to go on
+    bool continuing = !continuation_text.is_empty();
+
+    String json_body;
+    if (debug_dictionary_body) {
+        // Reference path: the body built as Variants and serialized by JSON::stringify
+        Dictionary request_data;
+        if (dev_mode) {
+            Array contents;
+            contents.push_back(_make_prompt_message());
+            if (continuing) {
+                Dictionary model_message;
+                model_message["role"] = "model";
+                Array model_parts;
+                Dictionary model_part;
+                model_part["text"] = continuation_text;
+                model_parts.push_back(model_part);
+                model_message["parts"] = model_parts;
+                contents.push_back(model_message);
+
+                Dictionary continue_message;
+                continue_message["role"] = "user";
+                Array continue_parts;
+                Dictionary continue_part;
+                continue_part["text"] = CONTINUE_PROMPT;
+                continue_parts.push_back(continue_part);
+                continue_message["parts"] = continue_parts;
+                contents.push_back(continue_message);
+            }
+
+            request_data["contents"] = contents;
+            request_data["generationConfig"] = generation_config;
+            if (use_tools) {
+                request_data["tools"] = tool_list;
+            }
+        } else {
+            request_data["model"] = current_model;
+            request_data["temperature"] = temperature;
+            request_data["max_output_tokens"] = max_output_tokens;
+            request_data["system_prompt"] = current_system_prompt;
+            request_data["scene_info"] = current_prompt_scene;
+            request_data["user_input"] = current_user_input;
+        }
+
+        json_body = JSON::stringify(request_data);
+    } else {
+        body_writer.begin();
+        body_writer.begin_object();
+        if (dev_mode) {
+            body_writer.key("contents");
+            body_writer.begin_array();
+            body_writer.begin_object();
+            body_writer.key("role");
+            body_writer.write_string("user");
+            body_writer.key("parts");
+            body_writer.begin_array();
+            body_writer.begin_object();
+            body_writer.key("text");
+            body_writer.begin_string();
+            body_writer.append_string(current_prompt_intro);
+            body_writer.append_string(SCENE_HEADER);
+            body_writer.append_string(current_prompt_scene);
+            body_writer.append_string("\n\n");
+            body_writer.append_string(current_user_input);
+            body_writer.end_string();
+            body_writer.end_object();
+            body_writer.end_array();
+            body_writer.end_object();
+
+            if (continuing) {
+                body_writer.begin_object();
+                body_writer.key("role");
+                body_writer.write_string("model");
+                body_writer.key("parts");
+                body_writer.begin_array();
+                body_writer.begin_object();
+                body_writer.key("text");
+                body_writer.write_string(continuation_text);
+                body_writer.end_object();
+                body_writer.end_array();
+                body_writer.end_object();
+
+                body_writer.begin_object();
+                body_writer.key("role");
+                body_writer.write_string("user");
+                body_writer.key("parts");
+                body_writer.begin_array();
+                body_writer.begin_object();
+                body_writer.key("text");
+                body_writer.write_string(CONTINUE_PROMPT);
+                body_writer.end_object();
+                body_writer.end_array();
+                body_writer.end_object();
+            }
+            body_writer.end_array();
 
-        request_data["model"] = model;
-        request_data["temperature"] = temperature;
-        request_data["max_output_tokens"] = max_output_tokens;
-        request_data["system_prompt"] = system_prompt;
-        request_data["scene_info"] = p_scene_info;
-        request_data["user_input"] = p_user_input;
+            body_writer.key("generationConfig");
+            body_writer.write_variant(generation_config);
+            if (use_tools) {
+                body_writer.key("tools");
+                body_writer.write_variant(tool_list);
+            }
+        } else {
+            body_writer.key("model");
+            body_writer.write_string(current_model);
+            body_writer.key("temperature");
+            body_writer.write_number(temperature);
+            body_writer.key("max_output_tokens");
+            body_writer.write_int(max_output_tokens);
+            body_writer.key("system_prompt");
+            body_writer.write_string(current_system_prompt);
+            body_writer.key("scene_info");
+            body_writer.write_string(current_prompt_scene);
+            body_writer.key("user_input");
+            body_writer.write_string(current_user_input);
+        }
+        body_writer.end_object();
     }
 
-    JSON json;
-    String json_body = json.stringify(request_data);
+    VectorAIProfiler *profiler = VectorAIProfiler::get_singleton();
+    if (profiler) {
+        profiler->end_phase(VectorAIProfiler::PHASE_SERIALIZE);
+        profiler->begin_phase(VectorAIProfiler::PHASE_NETWORK);
+    }
 
-    Error err = http_request->request(url, headers, HTTPClient::METHOD_POST, json_body);
+    VectorAITracer *tracer = VectorAITracer::get_singleton();
+    if (tracer) {
+        tracer->end_span("serialization");
+    }
 
-    if (err != OK) {
-        Dictionary response;
-        p_callback.call(response, "HTTP Request Error: " + itos(err));
+    // The written body is handed over as-is; HTTPRequest shares the buffer rather than copying it
+    Error err;
+    if (is_streaming_active()) {
+        err = _start_stream(url, headers, debug_dictionary_body ? json_body.to_utf8_buffer() : body_writer.finish());
+    } else {
+        HTTPRequest *request = _get_request(http_request, &GeminiClient::_on_request_completed);
+        err = debug_dictionary_body ? request->request(url, headers, HTTPClient::METHOD_POST, json_body) : request->request_raw(url, headers, HTTPClient::METHOD_POST, body_writer.finish());
+    }
+
+    if (err == OK && tracer && tracer->is_enabled()) {
+        _set_trace_stage(TRACE_STAGE_QUEUEING);
+    }
+
+    // Timed from the first round, so routing latency covers continuation and candidate rounds too
+    if (err == OK && request_start_usec == 0) {
+        request_start_usec = OS::get_singleton()->get_ticks_usec();
     }
+    return err;
+}
+
+bool GeminiClient::_needs_continuation(const String &p_text, const String &p_finish_reason) const {
+    if (!dev_mode || is_tool_calling_active() || continuation_rounds >= max_continuations) {
+        return false;
+    }
+
+    // Cut off by the output limit, or stopped inside the modifications section
+    int section_start = p_text.find("MODIFICATIONS:");
+    return p_finish_reason == "MAX_TOKENS" || (section_start != -1 && p_text.find("EXPLANATION:", section_start) == -1);
+}
+
+String GeminiClient::_trim_overlap(const String &p_previous, const String &p_next) {
+    // Continuations often restart the line that was cut; drop the repeated part
+    static const int MAX_OVERLAP = 512;
+    static const int MIN_OVERLAP = 8;
+
+    int longest = MIN(MAX_OVERLAP, MIN(p_previous.length(), p_next.length()));
+    for (int length = longest; length >= MIN_OVERLAP; length--) {
+        if (p_previous.ends_with(p_next.substr(0, length))) {
+            return p_next.substr(length);
+        }
+    }
+    return p_next;
+}
+
+Error GeminiClient::_send_continuation(const String &p_text) {
+    continuation_text = p_text;
+    continuation_rounds++;
+
+    // The resent prompt no longer matches the local estimate, so it can't calibrate it
+    last_prompt_estimate_raw = 0;
+
+    return _resend_generation();
+}
+
+Error GeminiClient::_resend_generation() {
+    VectorAIProfiler *profiler = VectorAIProfiler::get_singleton();
+    if (profiler) {
+        profiler->begin_phase(VectorAIProfiler::PHASE_SERIALIZE);
+    }
+
+    VectorAITracer *tracer = VectorAITracer::get_singleton();
+    if (tracer) {
+        tracer->begin_span("serialization");
+    }
+
+    return _send_generation();
+}
+
+double GeminiClient::_end_network_phase() {
+    VectorAIProfiler *profiler = VectorAIProfiler::get_singleton();
+    if (profiler) {
+        profiler->end_phase(VectorAIProfiler::PHASE_NETWORK);
+        profiler->begin_phase(VectorAIProfiler::PHASE_PARSE);
+    }
+
+    _set_trace_stage(TRACE_STAGE_NONE);
+
+    VectorAITracer *tracer = VectorAITracer::get_singleton();
+    if (tracer) {
+        tracer->instant("last_byte_received");
+        tracer->begin_span("parse");
+    }
+    parse_phase_open = true;
+
+    // Latency per routed model feeds back into tuning the routing rules
+    return (OS::get_singleton()->get_ticks_usec() - request_start_usec) / 1000.0;
+}
+
+void GeminiClient::_end_parse_phase() {
+    if (!parse_phase_open) {
+        return;
+    }
+    parse_phase_open = false;
+
+    VectorAIProfiler *profiler = VectorAIProfiler::get_singleton();
+    if (profiler) {
+        profiler->end_phase(VectorAIProfiler::PHASE_PARSE);
+    }
+
+    VectorAITracer *tracer = VectorAITracer::get_singleton();
+    if (tracer) {
+        tracer->end_span("parse");
+    }
+}
+
+void GeminiClient::_resume_parse_phase() {
+    // A follow-up round could not be sent; the response at hand is parsed after all
+    VectorAIProfiler *profiler = VectorAIProfiler::get_singleton();
+    if (profiler) {
+        profiler->begin_phase(VectorAIProfiler::PHASE_PARSE);
+    }
+
+    VectorAITracer *tracer = VectorAITracer::get_singleton();
+    if (tracer) {
+        tracer->begin_span("parse");
+    }
+    parse_phase_open = true;
 }
 
 void GeminiClient::_on_request_completed(int p_result, int p_code, const PackedStringArray &p_headers, const PackedByteArray &p_body) {
@@ -244,6 +1169,12 @@ void GeminiClient::_on_request_completed(int p_result, int p_code, const PackedS
         return;
     }
 
+    double latency_msec = _end_network_phase();
+    ParsePhaseScope parse_scope{ this };
+    if (p_result != HTTPRequest::RESULT_SUCCESS || p_code != 200) {
+        model_router->record_decision(current_routing, latency_msec, false);
+    }
+
     if (p_result != HTTPRequest::RESULT_SUCCESS) {
         Dictionary response;
         current_callback.call(response, "HTTP Request Failed: " + itos(p_result));
@@ -259,46 +1190,116 @@ void GeminiClient::_on_request_completed(int p_result, int p_code, const PackedS
         return;
     }
 
-    // Parse the response
-    String response_text = String::utf8((const char *)p_body.ptr(), p_body.size());
-    JSON json;
-    Error err = json.parse(response_text);
+    // Parse the response straight from the body bytes, keeping only the fields used below
+    GeminiResponseReader response_reader;
+    if (is_multi_candidate_active()) {
+        response_reader.set_max_candidates(candidate_count);
+    }
+    Error err = response_reader.feed(p_body.ptr(), p_body.size());
+    if (err == OK) {
+        err = response_reader.finish();
+    }
 
     if (err != OK) {
+        model_router->record_decision(current_routing, latency_msec, false);
+
         Dictionary response;
-        current_callback.call(response, "JSON Parse Error: " + itos(err));
+        current_callback.call(response, "JSON Parse Error: " + itos(err) + " " + response_reader.get_error());
         current_callback = Callable();
         return;
     }
 
-    Dictionary response_data = json.get_data();
+    int candidate = 0;
+    if (response_reader.get_candidate_count() > 1) {
+        candidate = _choose_candidate(response_reader);
+        if (candidate < 0) {
+            // Nothing would apply cleanly; a new set of candidates is on its way
+            return;
+        }
+    }
 
-    // Extract the response text
-    String ai_response_text;
-
-    // Check if this is a direct Gemini API response
-    if (response_data.has("candidates") && response_data["candidates"].get_type() == Variant::ARRAY) {
-        Array candidates = response_data["candidates"];
-        if (candidates.size() > 0) {
-            Dictionary candidate = candidates[0];
-            if (candidate.has("content") && candidate["content"].get_type() == Variant::DICTIONARY) {
-                Dictionary content = candidate["content"];
-                if (content.has("parts") && content["parts"].get_type() == Variant::ARRAY) {
-                    Array parts = content["parts"];
-                    for (int i = 0; i < parts.size(); i++) {
-                        Dictionary part = parts[i];
-                        if (part.has("text")) {
-                            ai_response_text += String(part["text"]);
-                        }
-                    }
-                }
-            }
+    if (candidate > 0) {
+        _complete_response(response_reader.get_response_data(), response_reader.get_candidate_text(candidate), response_reader.get_candidate_finish_reason(candidate), latency_msec, false);
+    } else {
+        _complete_response(response_reader.get_response_data(), response_reader.get_text(), response_reader.get_finish_reason(), latency_msec, false);
+    }
+}
+
+int GeminiClient::_choose_candidate(const GeminiResponseReader &p_reader) {
+    // One fresh set of candidates is asked for when none of the first set applies cleanly
+    static const int MAX_CANDIDATE_RETRIES = 1;
+
+    int best = 0;
+    int best_applicable = -1;
+    int best_failed = 0;
+    bool any_passes = false;
+    for (int i = 0; i < p_reader.get_candidate_count(); i++) {
+        // Dry run against the edited scene: nodes resolved, properties present, values of a fitting type
+        Dictionary check = candidate_validator.call(_parse_modifications(p_reader.get_candidate_text(i)));
+        int applicable = check.get("applicable", 0);
+        int failed = check.get("failed", 0);
+        any_passes = any_passes || failed == 0;
+
+        // Most edits that would apply, then fewest that wouldn't
+        if (applicable > best_applicable || (applicable == best_applicable && failed < best_failed)) {
+            best = i;
+            best_applicable = applicable;
+            best_failed = failed;
         }
     }
-    // Check if this is our proxy server response format
-    else if (response_data.has("response")) {
-        ai_response_text = response_data["response"];
+
+    last_candidate_choice = Dictionary();
+    last_candidate_choice["index"] = best;
+    last_candidate_choice["count"] = p_reader.get_candidate_count();
+    last_candidate_choice["applicable"] = best_applicable;
+    last_candidate_choice["failed"] = best_failed;
+    last_candidate_choice["retries"] = candidate_retries;
+
+    if (!any_passes && candidate_retries < MAX_CANDIDATE_RETRIES) {
+        // The discarded round still used tokens
+        _record_usage(p_reader.get_response_data());
+        candidate_retries++;
+
+        _end_parse_phase();
+        if (_resend_generation() == OK) {
+            return -1;
+        }
+        _resume_parse_phase();
     }
+    return best;
+}
+
+void GeminiClient::_complete_response(const Dictionary &p_response_data, const String &p_text, const String &p_finish_reason, double p_latency_msec, bool p_streamed) {
+    _record_usage(p_response_data);
+
+    // The model asked for scene details; answer locally and keep the conversation going
+    if (is_tool_calling_active() && _run_tool_calls(p_response_data)) {
+        _end_parse_phase();
+        return;
+    }
+
+    // Text of the first candidate's parts, or the proxy's "response" field; a streamed
+    // text already has earlier rounds stitched in
+    String ai_response_text = p_text;
+    if (!p_streamed && !continuation_text.is_empty()) {
+        ai_response_text = continuation_text + _trim_overlap(continuation_text, p_text);
+    }
+
+    // Cut off before the end: ask for the rest instead of dropping the tail
+    if (_needs_continuation(ai_response_text, p_finish_reason)) {
+        _end_parse_phase();
+        if (_send_continuation(ai_response_text) == OK) {
+            return;
+        }
+        _resume_parse_phase();
+        if (p_streamed) {
+            stream_parser.finish();
+            _take_streamed_modifications();
+        }
+    }
+
+    // Routing latency covers every tool and continuation round of the request
+    model_router->record_decision(current_routing, p_latency_msec, true);
 
     if (ai_response_text.is_empty()) {
         Dictionary response;
@@ -307,136 +1308,428 @@ void GeminiClient::_on_request_completed(int p_result, int p_code, const PackedS
         return;
     }
 
-    // Parse modifications from the response
-    Dictionary modifications = _parse_modifications(ai_response_text);
+    // Streamed records were parsed (and handed out) as they arrived
+    Dictionary modifications;
+    if (p_streamed) {
+        modifications["list"] = stream_modifications;
+    } else {
+        modifications = _parse_modifications(ai_response_text);
+    }
 
     // Create the response object
     Dictionary response;
     response["text"] = ai_response_text;
     response["modifications"] = modifications;
+    response["token_estimate"] = last_token_breakdown;
+    response["usage"] = last_usage;
+    response["routing"] = current_routing;
+    response["finish_reason"] = p_finish_reason;
+    response["streamed"] = p_streamed;
+    response["continuations"] = continuation_rounds;
+    if (!last_candidate_choice.is_empty()) {
+        response["candidate"] = last_candidate_choice;
+    }
+    if (!tool_log.is_empty()) {
+        response["tool_calls"] = tool_log;
+    }
+
+    _end_parse_phase();
 
     // Call the callback
     current_callback.call(response, "");
     current_callback = Callable();
 }
 
-Dictionary GeminiClient::_parse_modifications(const String &p_response_text) {
-    Dictionary modifications;
-    Array mod_list;
+Error GeminiClient::_start_stream(const String &p_url, const Vector<String> &p_headers, const PackedByteArray &p_body) {
+    int path_start = p_url.find("/", p_url.find("://") + 3);
+    String host = p_url.substr(0, path_start);
 
-    // Look for the MODIFICATIONS section
-    int modifications_start = p_response_text.find("MODIFICATIONS:");
-    int modifications_end = p_response_text.find("EXPLANATION:");
+    if (stream_client.is_null()) {
+        stream_client = Ref<HTTPClient>(HTTPClient::create());
+    }
+    stream_client->close();
 
-    if (modifications_start != -1 && modifications_end != -1) {
-        String modifications_text = p_response_text.substr(modifications_start + 14, modifications_end - modifications_start - 14).strip_edges();
-        Vector<String> lines = modifications_text.split("\n");
+    Error err = stream_client->connect_to_host(host);
+    if (err != OK) {
+        return err;
+    }
 
-        String current_node_path = "";
-        String current_property_value = "";
-        bool in_property_block = false;
+    stream_path = p_url.substr(path_start);
+    stream_headers = p_headers;
+    stream_body = p_body;
+    stream_response_code = 0;
+    stream_line.clear();
+    stream_event.clear();
+    stream_error_body.clear();
+    stream_finish_reason = String();
+    stream_response_data = Dictionary();
+
+    // A continuation round extends the text and records of the rounds before it
+    stream_holdback = String();
+    stream_trim_overlap = !continuation_text.is_empty();
+    if (continuation_text.is_empty()) {
+        stream_text = String();
+        stream_modifications = Array();
+        stream_parser.reset();
+    }
 
-        for (int i = 0; i < lines.size(); i++) {
-            String line = lines[i].strip_edges();
+    stream_state = STREAM_CONNECTING;
+    set_process(true);
+    return OK;
+}
 
-            // Skip empty lines and bullet points
-            if (line.is_empty() || line == "-" || line == "*") {
-                continue;
+void GeminiClient::_poll_stream() {
+    // HTTPRequest only reports the whole body, so the streamed request drives HTTPClient itself
+    stream_client->poll();
+    bool tracing = VectorAITracer::get_singleton() && VectorAITracer::get_singleton()->is_enabled();
+
+    HTTPClient::Status status = stream_client->get_status();
+    switch (status) {
+        case HTTPClient::STATUS_RESOLVING:
+        case HTTPClient::STATUS_CONNECTING: {
+            if (tracing) {
+                _set_trace_stage(TRACE_STAGE_CONNECT);
             }
-
-            // Check if this is a numbered step (like "1. Create Node:" or "2. Set Property:")
-            bool is_numbered_step = false;
-            if (line.begins_with("1.") || line.begins_with("2.") || line.begins_with("3.")) {
-                is_numbered_step = true;
-                in_property_block = false;
-
-                // If we have a complete modification from before, add it
-                if (!current_node_path.is_empty() && !current_property_value.is_empty()) {
-                    Dictionary mod;
-                    mod["node_path"] = current_node_path;
-                    mod["property_value"] = current_property_value;
-                    mod_list.push_back(mod);
-
-                    // Reset for the next modification
-                    current_node_path = "";
-                    current_property_value = "";
+        } break;
+        case HTTPClient::STATUS_CONNECTED: {
+            if (stream_state == STREAM_CONNECTING) {
+                Error err = stream_client->request(HTTPClient::METHOD_POST, stream_path, stream_headers, stream_body.ptr(), stream_body.size());
+                if (err != OK) {
+                    _finish_stream("HTTP Request Error: " + itos(err));
+                    return;
+                }
+                stream_state = STREAM_REQUESTING;
+                if (tracing) {
+                    _set_trace_stage(TRACE_STAGE_FIRST_BYTE);
                 }
+            } else if (stream_state == STREAM_BODY) {
+                // Body fully read; the connection is kept for the next request
+                _finish_stream(String());
             }
-
-            // Check if this is a property line (like "- Path: Main/Triangle")
-            if (line.begins_with("- Path:")) {
-                String path_value = line.substr(7).strip_edges();
-                current_node_path = path_value;
-                continue;
+        } break;
+        case HTTPClient::STATUS_REQUESTING: {
+        } break;
+        case HTTPClient::STATUS_BODY: {
+            if (stream_state != STREAM_BODY) {
+                stream_state = STREAM_BODY;
+                stream_response_code = stream_client->get_response_code();
             }
 
-            // Check if this is a property type line (like "- Type: Polygon2D")
-            if (line.begins_with("- Type:")) {
-                current_property_value = line.substr(2).strip_edges(); // Keep the "Type:" prefix
-                continue;
+            // Everything that arrived since the last frame
+            while (stream_client->get_status() == HTTPClient::STATUS_BODY) {
+                PackedByteArray chunk = stream_client->read_response_body_chunk();
+                if (chunk.is_empty()) {
+                    break;
+                }
+                if (tracing) {
+                    _set_trace_stage(TRACE_STAGE_LAST_BYTE);
+                }
+                if (!_read_stream_chunk(chunk)) {
+                    return;
+                }
             }
-
-            // Check if this is a property name line (like "- Property: polygon")
-            if (line.begins_with("- Property:")) {
-                in_property_block = true;
-                String property_name = line.substr(11).strip_edges();
-                current_property_value = "property: " + property_name;
-                continue;
+        } break;
+        case HTTPClient::STATUS_DISCONNECTED: {
+            if (stream_state == STREAM_BODY) {
+                _finish_stream(String());
+            } else {
+                _finish_stream("HTTP Request Failed: connection closed");
             }
+        } break;
+        default: {
+            _finish_stream("HTTP Request Failed: " + itos(status));
+        } break;
+    }
+}
 
-            // Check if this is a property value line (like "- Value: PoolVector2Array(...)")
-            if (line.begins_with("- Value:")) {
-                String value = line.substr(8).strip_edges();
-
-                // If we're in a property block, append the value to the current property
-                if (in_property_block && !current_property_value.is_empty()) {
-                    current_property_value += ": " + value;
-
-                    // Add this complete property modification
-                    if (!current_node_path.is_empty()) {
-                        Dictionary mod;
-                        mod["node_path"] = current_node_path;
-                        mod["property_value"] = current_property_value;
-                        mod_list.push_back(mod);
-                    }
-
-                    // Reset for the next property (but keep the node path)
-                    current_property_value = "";
-                    in_property_block = false;
-                }
-                continue;
-            }
+bool GeminiClient::_read_stream_chunk(const PackedByteArray &p_chunk) {
+    if (stream_response_code != 200) {
+        // Error bodies are plain JSON, kept whole for the message
+        stream_error_body.append_array(p_chunk);
+        return true;
+    }
 
-            // For lines that don't match any of the above patterns, try the original parsing
-            if (!is_numbered_step && !line.begins_with("-")) {
-                Vector<String> parts = line.split(":", true, 1);
-                if (parts.size() >= 2) {
-                    String node_path = parts[0].strip_edges();
-                    String property_value = parts[1].strip_edges();
-
-                    Dictionary mod;
-                    mod["node_path"] = node_path;
-                    mod["property_value"] = property_value;
-                    mod_list.push_back(mod);
-                }
+    // Server-sent events: "data:" lines, each event ended by an empty line
+    const uint8_t *ptr = p_chunk.ptr();
+    int size = p_chunk.size();
+    int from = 0;
+    while (from < size) {
+        const uint8_t *newline = (const uint8_t *)memchr(ptr + from, '\n', size - from);
+        int to = newline ? (int)(newline - ptr) : size;
+
+        uint32_t offset = stream_line.size();
+        stream_line.resize(offset + to - from);
+        memcpy(stream_line.ptr() + offset, ptr + from, to - from);
+        from = to + 1;
+
+        if (!newline) {
+            break;
+        }
+
+        if (!stream_line.is_empty() && stream_line[stream_line.size() - 1] == '\r') {
+            stream_line.resize(stream_line.size() - 1);
+        }
+
+        if (stream_line.is_empty()) {
+            if (!stream_event.is_empty() && !_dispatch_stream_event()) {
+                return false;
             }
+        } else if (stream_line.size() >= 5 && memcmp(stream_line.ptr(), "data:", 5) == 0) {
+            uint32_t skip = stream_line.size() > 5 && stream_line[5] == ' ' ? 6 : 5;
+            if (!stream_event.is_empty()) {
+                stream_event.push_back('\n');
+            }
+            uint32_t event_offset = stream_event.size();
+            stream_event.resize(event_offset + stream_line.size() - skip);
+            memcpy(stream_event.ptr() + event_offset, stream_line.ptr() + skip, stream_line.size() - skip);
         }
+        stream_line.clear();
+    }
+    return true;
+}
+
+bool GeminiClient::_dispatch_stream_event() {
+    // Each event is a complete generateContent response holding the next piece of text
+    GeminiResponseReader event_reader;
+    Error err = event_reader.feed(stream_event.ptr(), stream_event.size());
+    if (err == OK) {
+        err = event_reader.finish();
+    }
+    stream_event.clear();
+
+    if (err != OK) {
+        _finish_stream("JSON Parse Error: " + itos(err) + " " + event_reader.get_error());
+        return false;
+    }
+
+    // Usage arrives with the last events
+    Dictionary data = event_reader.get_response_data();
+    if (data.has("usageMetadata")) {
+        stream_response_data["usageMetadata"] = data["usageMetadata"];
+    }
+    if (!event_reader.get_finish_reason().is_empty()) {
+        stream_finish_reason = event_reader.get_finish_reason();
+    }
+
+    String delta = event_reader.get_text();
+    if (stream_trim_overlap) {
+        // Enough of a continuation's start is held back to recognize text it repeats
+        stream_holdback += delta;
+        if (stream_holdback.length() < 512) {
+            return true;
+        }
+        delta = _flush_stream_holdback();
+    }
+    _append_stream_text(delta);
+    return true;
+}
+
+String GeminiClient::_flush_stream_holdback() {
+    String text = _trim_overlap(stream_text, stream_holdback);
+    stream_holdback = String();
+    stream_trim_overlap = false;
+    return text;
+}
+
+void GeminiClient::_append_stream_text(const String &p_text) {
+    if (p_text.is_empty()) {
+        return;
+    }
+    stream_text += p_text;
+    stream_parser.feed(p_text);
+    _take_streamed_modifications();
+}
+
+void GeminiClient::_take_streamed_modifications() {
+    Array records = stream_parser.take_records();
+    for (int i = 0; i < records.size(); i++) {
+        stream_modifications.push_back(records[i]);
+        if (modification_handler.is_valid()) {
+            modification_handler.call(records[i]);
+        }
+    }
+}
 
-        // Add the last modification if there's one pending
-        if (!current_node_path.is_empty() && !current_property_value.is_empty()) {
-            Dictionary mod;
-            mod["node_path"] = current_node_path;
-            mod["property_value"] = current_property_value;
-            mod_list.push_back(mod);
+void GeminiClient::_finish_stream(const String &p_error) {
+    stream_state = STREAM_NONE;
+    stream_body = PackedByteArray();
+    stream_line.clear();
+    stream_event.clear();
+    set_process(trace_stage != TRACE_STAGE_NONE);
+
+    if (current_callback.is_null()) {
+        return;
+    }
+
+    double latency_msec = _end_network_phase();
+    ParsePhaseScope parse_scope{ this };
+
+    String error = p_error;
+    if (error.is_empty() && stream_response_code != 200) {
+        error = "HTTP Error: " + itos(stream_response_code) + "\n" + String::utf8((const char *)stream_error_body.ptr(), stream_error_body.size());
+    }
+    stream_error_body.clear();
+
+    if (!error.is_empty()) {
+        model_router->record_decision(current_routing, latency_msec, false);
+
+        Dictionary response;
+        Callable callback = current_callback;
+        current_callback = Callable();
+        callback.call(response, error);
+        return;
+    }
+
+    if (stream_trim_overlap) {
+        _append_stream_text(_flush_stream_holdback());
+    }
+
+    // A last record may have been waiting for the end of the text; a continuation picks it up instead
+    if (!_needs_continuation(stream_text, stream_finish_reason)) {
+        stream_parser.finish();
+        _take_streamed_modifications();
+    }
+
+    _complete_response(stream_response_data, stream_text, stream_finish_reason, latency_msec, true);
+}
+
+bool GeminiClient::is_streaming_active() const {
+    // Streaming needs direct API access; tool rounds need the whole response first
+    return stream_responses && dev_mode && !is_tool_calling_active();
+}
+
+void GeminiClient::set_modification_handler(const Callable &p_handler) {
+    modification_handler = p_handler;
+}
+
+void GeminiClient::set_candidate_validator(const Callable &p_validator) {
+    candidate_validator = p_validator;
+}
+
+bool GeminiClient::is_multi_candidate_active() const {
+    // Candidates are compared once complete, which rules out streaming and tool rounds
+    return candidate_count > 1 && dev_mode && candidate_validator.is_valid() && !is_streaming_active() && !is_tool_calling_active();
+}
+
+bool GeminiClient::_run_tool_calls(const Dictionary &p_response_data) {
+    Array candidates = p_response_data.get("candidates", Array());
+    if (candidates.is_empty() || tool_rounds >= max_tool_rounds) {
+        return false;
+    }
+
+    Dictionary content = Dictionary(candidates[0]).get("content", Dictionary());
+    Array parts = content.get("parts", Array());
+
+    Array response_parts;
+    for (int i = 0; i < parts.size(); i++) {
+        Dictionary part = parts[i];
+        if (!part.has("functionCall") || part["functionCall"].get_type() != Variant::DICTIONARY) {
+            continue;
         }
+
+        Dictionary call = part["functionCall"];
+        String name = call.get("name", "");
+        Dictionary args = call.get("args", Dictionary());
+        Dictionary result = tool_handler.call(name, args);
+
+        Dictionary function_response;
+        function_response["name"] = name;
+        function_response["response"] = result;
+        Dictionary response_part;
+        response_part["functionResponse"] = function_response;
+        response_parts.push_back(response_part);
+
+        Dictionary log_entry;
+        log_entry["name"] = name;
+        log_entry["args"] = args;
+        log_entry["round"] = tool_rounds;
+        tool_log.push_back(log_entry);
+    }
+
+    if (response_parts.is_empty()) {
+        return false;
+    }
+
+    content["role"] = "model";
+    tool_conversation.push_back(content);
+
+    Dictionary tool_message;
+    tool_message["role"] = "user";
+    tool_message["parts"] = response_parts;
+    tool_conversation.push_back(tool_message);
+
+    tool_rounds++;
+
+    Error err = _send_tool_followup();
+    if (err != OK) {
+        Dictionary response;
+        Callable callback = current_callback;
+        current_callback = Callable();
+        callback.call(response, "HTTP Request Error: " + itos(err));
+    }
+    return true;
+}
+
+Error GeminiClient::_send_tool_followup() {
+    // The follow-up carries the tool conversation, not the estimated prompt
+    last_prompt_estimate_raw = 0;
+
+    String url = "https://generativelanguage.googleapis.com/v1beta/models/" + current_model + ":generateContent?key=" + api_key;
+    PackedStringArray headers;
+    headers.push_back("Content-Type: application/json");
+
+    Dictionary tools;
+    tools["functionDeclarations"] = tool_declarations;
+    Array tool_list;
+    tool_list.push_back(tools);
+
+    Dictionary request_data;
+    request_data["contents"] = tool_conversation;
+    request_data["generationConfig"] = tool_generation_config;
+    request_data["tools"] = tool_list;
+
+    // Out of rounds: the model has to answer with what it has
+    if (tool_rounds >= max_tool_rounds) {
+        Dictionary function_calling_config;
+        function_calling_config["mode"] = "NONE";
+        Dictionary tool_config;
+        tool_config["functionCallingConfig"] = function_calling_config;
+        request_data["toolConfig"] = tool_config;
+    }
+
+    VectorAIProfiler *profiler = VectorAIProfiler::get_singleton();
+    if (profiler) {
+        profiler->begin_phase(VectorAIProfiler::PHASE_NETWORK);
+    }
+
+    Error err = _get_request(http_request, &GeminiClient::_on_request_completed)->request(url, headers, HTTPClient::METHOD_POST, JSON::stringify(request_data));
+
+    VectorAITracer *tracer = VectorAITracer::get_singleton();
+    if (err == OK && tracer && tracer->is_enabled()) {
+        _set_trace_stage(TRACE_STAGE_QUEUEING);
+    }
+
+    return err;
+}
+
+Dictionary GeminiClient::_parse_modifications(const String &p_response_text) {
+    Dictionary modifications;
+
+    // Look for the MODIFICATIONS section; without its EXPLANATION: end there is nothing to apply
+    ModificationParser parser;
+    if (p_response_text.contains("MODIFICATIONS:") && p_response_text.contains("EXPLANATION:")) {
+        parser.feed(p_response_text);
+        parser.finish();
     }
 
-    modifications["list"] = mod_list;
+    modifications["list"] = parser.take_records();
     return modifications;
 }
 
 GeminiClient::GeminiClient() {
-    load_settings();
+    token_estimator.instantiate();
+    usage_ledger.instantiate();
+    model_router.instantiate();
 }
 
 GeminiClient::~GeminiClient() {
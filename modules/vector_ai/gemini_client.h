@@ -32,7 +32,15 @@
 
 #include "core/io/http_client.h"
 #include "core/io/json.h"
+#include "json_body_writer.h"
+#include "model_router.h"
+#include "modification_parser.h"
+#include "project_index.h"
 #include "scene/main/node.h"
+#include "token_estimator.h"
+#include "usage_ledger.h"
+
+class GeminiResponseReader;
 
 class GeminiClient : public Node {
     GDCLASS(GeminiClient, Node);
@@ -40,33 +48,213 @@ class GeminiClient : public Node {
 private:
     // Gemini API configuration
     String model = "gemini-2.5-flash-preview-04-17";
+    String fast_model = "gemini-2.0-flash-lite";
+    String routing_mode = "heuristic";
     double temperature = 0.7;
     int max_output_tokens = 2048;
+    int prompt_token_budget = 120000;
     bool dev_mode = false;
+    bool trace_enabled = false;
+    bool tool_calling = false;
+    int max_tool_rounds = 4;
+    bool rpc_enabled = false;
+    int rpc_port = 9510;
+    int float_precision = 3;
+    bool retrieval_enabled = false;
+    int retrieval_token_budget = 4000;
+    bool stream_responses = false;
+    int max_continuations = 2;
+    int candidate_count = 1;
+    int undo_memory_cap_mb = 64;
     String api_key;
     String proxy_url = "https://vector-ai-proxy.example.com/api/gemini";
+    Dictionary pricing_overrides;
+    // Builds request bodies as Variants through JSON::stringify instead of the body writer
+    bool debug_dictionary_body = false;
+
+    // Parsed settings file shared by all clients; each client applies it on first use
+    static Dictionary *shared_settings;
+    bool settings_loaded = false;
 
     // HTTP request
-    HTTPClient *http_client = nullptr;
     HTTPRequest *http_request = nullptr;
+    HTTPRequest *count_tokens_request = nullptr;
+    HTTPRequest *classifier_request = nullptr;
 
     // Callback for response
     Callable current_callback;
 
-    String _get_settings_path() const;
+    // Request body storage, reused across requests
+    JSONBodyWriter body_writer;
+
+    // Request in flight and the model it was routed to
+    String current_user_input;
+    String current_scene_info;
+    String current_model;
+    Dictionary current_routing;
+
+    // Prompt of the request in flight, resent by continuation rounds
+    String current_system_prompt;
+    String current_prompt_intro;
+    String current_prompt_scene;
+
+    // Answer so far when earlier rounds were cut off by max_output_tokens
+    String continuation_text;
+    int continuation_rounds = 0;
+
+    // Several candidates per request, checked against the scene before one is used
+    Callable candidate_validator;
+    int candidate_retries = 0;
+    Dictionary last_candidate_choice;
+    uint64_t request_start_usec = 0;
+    uint64_t classifier_start_usec = 0;
+    Ref<ModelRouter> model_router;
+
+    // Streamed responses (streamGenerateContent as server-sent events), read once per frame
+    enum StreamState {
+        STREAM_NONE,
+        STREAM_CONNECTING,
+        STREAM_REQUESTING,
+        STREAM_BODY,
+    };
+
+    StreamState stream_state = STREAM_NONE;
+    Ref<HTTPClient> stream_client;
+    String stream_path;
+    Vector<String> stream_headers;
+    PackedByteArray stream_body;
+    int stream_response_code = 0;
+    LocalVector<uint8_t> stream_line;
+    LocalVector<uint8_t> stream_event;
+    PackedByteArray stream_error_body;
+    String stream_text;
+    String stream_holdback;
+    bool stream_trim_overlap = false;
+    String stream_finish_reason;
+    Dictionary stream_response_data;
+
+    // Modification records handed out as soon as the stream completes them
+    ModificationParser stream_parser;
+    Array stream_modifications;
+    Callable modification_handler;
+
+    // Function calling: locally served tools answer the model's follow-up questions
+    Callable tool_handler;
+    Array tool_declarations;
+    Array tool_conversation;
+    Dictionary tool_generation_config;
+    int tool_rounds = 0;
+    Array tool_log;
+
+    // Network stage currently traced while a request is in flight
+    enum TraceStage {
+        TRACE_STAGE_NONE,
+        TRACE_STAGE_QUEUEING,
+        TRACE_STAGE_CONNECT,
+        TRACE_STAGE_FIRST_BYTE,
+        TRACE_STAGE_LAST_BYTE,
+    };
+
+    TraceStage trace_stage = TRACE_STAGE_NONE;
+
+    // Parse phase and span opened when a response arrives; closed once on whichever path ends it
+    bool parse_phase_open = false;
+
+    struct ParsePhaseScope {
+        GeminiClient *client = nullptr;
+        ~ParsePhaseScope() { client->_end_parse_phase(); }
+    };
+
+    // Local token estimation, calibrated against countTokens and usageMetadata
+    Ref<TokenEstimator> token_estimator;
+    Dictionary last_token_breakdown;
+    int last_prompt_estimate_raw = 0;
+    int count_tokens_estimate_raw = 0;
+
+    // Related project files pulled into the prompt
+    Ref<ProjectIndex> project_index;
+
+    // Token usage and cost accounting
+    Ref<UsageLedger> usage_ledger;
+    Dictionary last_usage;
+
+    void _set_trace_stage(TraceStage p_stage);
+    void _update_trace_stage();
+
+    static String _get_settings_path();
+    HTTPRequest *_get_request(HTTPRequest *&r_request, void (GeminiClient::*p_callback)(int, int, const PackedStringArray &, const PackedByteArray &));
+    String _get_routed_model() const;
+    void _request_classification();
+    void _dispatch_request(const String &p_model);
+    Dictionary _make_prompt_message() const;
+    Dictionary _make_generation_config() const;
+    Error _send_generation();
+    bool _needs_continuation(const String &p_text, const String &p_finish_reason) const;
+    static String _trim_overlap(const String &p_previous, const String &p_next);
+    Error _send_continuation(const String &p_text);
+    Error _resend_generation();
+    int _choose_candidate(const GeminiResponseReader &p_reader);
+    static String _get_system_prompt();
+    Dictionary _enforce_token_budget(const String &p_system_prompt, String &r_scene_info, const String &p_user_input);
+    void _request_token_count(const String &p_prompt);
+    Dictionary _extract_usage(const Dictionary &p_response_data) const;
+    void _record_usage(const Dictionary &p_response_data);
+    bool _run_tool_calls(const Dictionary &p_response_data);
+    Error _send_tool_followup();
     Dictionary _parse_modifications(const String &p_response_text);
+    double _end_network_phase();
+    void _end_parse_phase();
+    void _resume_parse_phase();
+    void _complete_response(const Dictionary &p_response_data, const String &p_text, const String &p_finish_reason, double p_latency_msec, bool p_streamed);
+
+    Error _start_stream(const String &p_url, const Vector<String> &p_headers, const PackedByteArray &p_body);
+    void _poll_stream();
+    bool _read_stream_chunk(const PackedByteArray &p_chunk);
+    bool _dispatch_stream_event();
+    void _take_streamed_modifications();
+    String _flush_stream_holdback();
+    void _append_stream_text(const String &p_text);
+    void _finish_stream(const String &p_error);
 
 protected:
     void _notification(int p_what);
     static void _bind_methods();
 
     void _on_request_completed(int p_result, int p_code, const PackedStringArray &p_headers, const PackedByteArray &p_body);
+    void _on_classifier_completed(int p_result, int p_code, const PackedStringArray &p_headers, const PackedByteArray &p_body);
+    void _on_count_tokens_completed(int p_result, int p_code, const PackedStringArray &p_headers, const PackedByteArray &p_body);
 
 public:
+    static Dictionary get_shared_settings();
+    static void free_shared_settings();
     Dictionary load_settings();
     void save_settings(const Dictionary &p_settings);
     void send_request(const String &p_user_input, const String &p_scene_info, const Callable &p_callback);
 
+    Dictionary estimate_prompt_tokens(const String &p_user_input, const String &p_scene_info);
+    Dictionary get_last_token_breakdown() const;
+    Ref<TokenEstimator> get_token_estimator() const;
+
+    Ref<UsageLedger> get_usage_ledger() const;
+    Ref<ModelRouter> get_model_router() const;
+    Dictionary get_last_routing() const;
+    Dictionary get_last_usage() const;
+
+    void set_tool_handler(const Callable &p_handler, const Array &p_declarations);
+    bool is_tool_calling_active() const;
+    bool is_request_active() const;
+
+    // Called with each modification record while a streamed response is still arriving
+    void set_modification_handler(const Callable &p_handler);
+    bool is_streaming_active() const;
+
+    // Called with a parsed modifications dictionary; returns its "applicable" and "failed" counts
+    void set_candidate_validator(const Callable &p_validator);
+    bool is_multi_candidate_active() const;
+
+    void set_project_index(const Ref<ProjectIndex> &p_index);
+    Ref<ProjectIndex> get_project_index() const;
+
     GeminiClient();
     ~GeminiClient();
 };
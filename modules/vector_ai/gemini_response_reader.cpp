@@ -0,0 +1,253 @@
+/**************************************************************************/
+/*  gemini_response_reader.cpp                                            */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "gemini_response_reader.h"
+
+Error GeminiResponseReader::feed(const uint8_t *p_data, int p_size) {
+    reader.feed(p_data, p_size);
+    return _pump();
+}
+
+Error GeminiResponseReader::finish() {
+    reader.finish();
+    Error err = _pump();
+    if (err == OK && !done) {
+        return ERR_PARSE_ERROR;
+    }
+    return err;
+}
+
+void GeminiResponseReader::reset() {
+    reader.reset();
+    frames.clear();
+    pending_key = String();
+    done = false;
+    candidates.clear();
+    current_candidate = 0;
+    proxy_text = String();
+    has_proxy_response = false;
+    extra = Dictionary();
+}
+
+bool GeminiResponseReader::_wants_value(JSONPullReader::Token p_token, bool &r_materialize, FrameKind &r_push) const {
+    bool is_object = p_token == JSONPullReader::TOKEN_OBJECT_BEGIN;
+    bool is_array = p_token == JSONPullReader::TOKEN_ARRAY_BEGIN;
+    r_materialize = false;
+
+    if (frames.is_empty()) {
+        r_push = is_array ? FRAME_ROOT_ARRAY : FRAME_ROOT;
+        return is_array || is_object;
+    }
+
+    const Frame &top = frames[frames.size() - 1];
+    switch (top.kind) {
+        case FRAME_ROOT_ARRAY: {
+            r_push = FRAME_ROOT;
+            return is_object;
+        }
+        case FRAME_ROOT: {
+            if (pending_key == "candidates") {
+                r_push = FRAME_CANDIDATES;
+                return is_array;
+            }
+            r_materialize = pending_key == "usageMetadata" || pending_key == "usage" || pending_key == "error" || pending_key == "response";
+            return r_materialize;
+        }
+        case FRAME_CANDIDATES: {
+            r_push = FRAME_CANDIDATE;
+            return is_object && top.index < max_candidates;
+        }
+        case FRAME_CANDIDATE: {
+            if (pending_key == "content") {
+                r_push = FRAME_CONTENT;
+                return is_object;
+            }
+            r_materialize = pending_key == "finishReason";
+            return r_materialize;
+        }
+        case FRAME_CONTENT: {
+            if (pending_key == "parts") {
+                r_push = FRAME_PARTS;
+                return is_array;
+            }
+            r_materialize = pending_key == "role";
+            return r_materialize;
+        }
+        case FRAME_PARTS: {
+            // Parts are small; each is built whole so tool calls can be replayed as-is
+            r_materialize = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+void GeminiResponseReader::_take_value(const Variant &p_value) {
+    FrameKind kind = frames[frames.size() - 1].kind;
+    if (kind == FRAME_PARTS) {
+        if (p_value.get_type() != Variant::DICTIONARY) {
+            return;
+        }
+        Dictionary part = p_value;
+        if (part.has("text")) {
+            candidates[current_candidate].text += String(part["text"]);
+        }
+        candidates[current_candidate].parts.push_back(part);
+    } else if (kind == FRAME_CANDIDATE) {
+        candidates[current_candidate].finish_reason = p_value;
+    } else if (kind == FRAME_CONTENT) {
+        candidates[current_candidate].role = p_value;
+    } else if (pending_key == "response") {
+        // Proxy responses carry the text directly
+        proxy_text += String(p_value);
+        has_proxy_response = true;
+    } else {
+        // Later chunks of a stream carry the final usage
+        extra[pending_key] = p_value;
+    }
+}
+
+Error GeminiResponseReader::_pump() {
+    while (true) {
+        JSONPullReader::Mark mark = reader.mark();
+        JSONPullReader::Token token = reader.next();
+
+        switch (token) {
+            case JSONPullReader::TOKEN_NEED_MORE: {
+                return OK;
+            }
+            case JSONPullReader::TOKEN_ERROR: {
+                return ERR_PARSE_ERROR;
+            }
+            case JSONPullReader::TOKEN_END: {
+                done = true;
+                return OK;
+            }
+            case JSONPullReader::TOKEN_KEY: {
+                pending_key = reader.get_string();
+                continue;
+            }
+            case JSONPullReader::TOKEN_OBJECT_END:
+            case JSONPullReader::TOKEN_ARRAY_END: {
+                frames.resize(frames.size() - 1);
+                continue;
+            }
+            default: {
+            } break;
+        }
+
+        bool materialize = false;
+        FrameKind push = FRAME_ROOT;
+        bool wanted = _wants_value(token, materialize, push);
+
+        JSONPullReader::Token result = token;
+        if (wanted && materialize) {
+            Variant value;
+            result = reader.read_value(token, value);
+            if (result != JSONPullReader::TOKEN_NEED_MORE && result != JSONPullReader::TOKEN_ERROR) {
+                _take_value(value);
+            }
+        } else if (!wanted) {
+            result = reader.skip_value(token);
+        }
+
+        if (result == JSONPullReader::TOKEN_NEED_MORE) {
+            // The value is cut off; it is read again from its first token once more bytes arrive
+            reader.rewind(mark);
+            return OK;
+        }
+        if (result == JSONPullReader::TOKEN_ERROR) {
+            return ERR_PARSE_ERROR;
+        }
+
+        int index = 0;
+        if (!frames.is_empty() && frames[frames.size() - 1].kind == FRAME_CANDIDATES) {
+            index = frames[frames.size() - 1].index++;
+        }
+
+        if (wanted && !materialize) {
+            Frame frame;
+            frame.kind = push;
+            frames.push_back(frame);
+
+            // Each chunk of a stream lists its candidates again; text is appended per position
+            if (push == FRAME_CANDIDATE) {
+                current_candidate = index;
+                if ((int)candidates.size() <= index) {
+                    candidates.resize(index + 1);
+                }
+            }
+        }
+    }
+}
+
+String GeminiResponseReader::get_text() const {
+    if (has_proxy_response) {
+        return proxy_text;
+    }
+    return candidates.is_empty() ? String() : candidates[0].text;
+}
+
+String GeminiResponseReader::get_finish_reason() const {
+    return candidates.is_empty() ? String() : candidates[0].finish_reason;
+}
+
+Array GeminiResponseReader::get_parts() const {
+    return candidates.is_empty() ? Array() : candidates[0].parts;
+}
+
+Dictionary GeminiResponseReader::get_response_data() const {
+    Dictionary response_data = extra.duplicate();
+
+    if (!candidates.is_empty()) {
+        Array candidate_list;
+        for (const Candidate &entry : candidates) {
+            Dictionary content;
+            content["parts"] = entry.parts;
+            if (!entry.role.is_empty()) {
+                content["role"] = entry.role;
+            }
+
+            Dictionary candidate;
+            candidate["content"] = content;
+            if (!entry.finish_reason.is_empty()) {
+                candidate["finishReason"] = entry.finish_reason;
+            }
+            candidate_list.push_back(candidate);
+        }
+        response_data["candidates"] = candidate_list;
+    }
+
+    if (has_proxy_response) {
+        response_data["response"] = proxy_text;
+    }
+
+    return response_data;
+}
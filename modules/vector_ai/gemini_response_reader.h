@@ -0,0 +1,102 @@
+/**************************************************************************/
+/*  gemini_response_reader.h                                              */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/variant/array.h"
+#include "core/variant/dictionary.h"
+#include "json_pull_reader.h"
+
+// Pulls the parts of a generateContent response that the client uses (candidate parts,
+// finishReason, usage) straight from the body bytes and steps over everything else. Accepts a
+// single response object, the array form returned by streamGenerateContent, or the proxy format.
+class GeminiResponseReader {
+    enum FrameKind {
+        FRAME_ROOT_ARRAY,
+        FRAME_ROOT,
+        FRAME_CANDIDATES,
+        FRAME_CANDIDATE,
+        FRAME_CONTENT,
+        FRAME_PARTS,
+    };
+
+    struct Frame {
+        FrameKind kind = FRAME_ROOT;
+        int index = 0;
+    };
+
+    struct Candidate {
+        String text;
+        String finish_reason;
+        String role;
+        Array parts;
+    };
+
+    JSONPullReader reader;
+    LocalVector<Frame> frames;
+    String pending_key;
+    bool done = false;
+
+    // Candidates past this count are skipped unread
+    int max_candidates = 1;
+    LocalVector<Candidate> candidates;
+    int current_candidate = 0;
+
+    String proxy_text;
+    bool has_proxy_response = false;
+    Dictionary extra;
+
+    bool _wants_value(JSONPullReader::Token p_token, bool &r_materialize, FrameKind &r_push) const;
+    void _take_value(const Variant &p_value);
+    Error _pump();
+
+public:
+    // Both return ERR_PARSE_ERROR once the body is known to be malformed; see get_error()
+    Error feed(const uint8_t *p_data, int p_size);
+    Error finish();
+    void reset();
+
+    void set_max_candidates(int p_count) { max_candidates = MAX(p_count, 1); }
+
+    // First candidate, or the proxy's text
+    String get_text() const;
+    String get_finish_reason() const;
+    Array get_parts() const;
+
+    int get_candidate_count() const { return candidates.size(); }
+    const String &get_candidate_text(int p_index) const { return candidates[p_index].text; }
+    const String &get_candidate_finish_reason(int p_index) const { return candidates[p_index].finish_reason; }
+
+    bool is_empty() const { return candidates.is_empty() && !has_proxy_response && extra.is_empty(); }
+    String get_error() const { return reader.get_error(); }
+
+    // Compact stand-in for the parsed body: only the fields that were kept, in the API's layout
+    Dictionary get_response_data() const;
+};
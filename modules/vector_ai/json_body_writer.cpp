@@ -0,0 +1,213 @@
+/**************************************************************************/
+/*  json_body_writer.cpp                                                  */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "json_body_writer.h"
+
+#include "core/io/json.h"
+
+void JSONBodyWriter::begin() {
+    length = 0;
+    needs_comma.clear();
+    after_key = false;
+}
+
+const PackedByteArray &JSONBodyWriter::finish() {
+    // Shrinking keeps the allocation, so the next body grows back into it
+    buffer.resize(length);
+    return buffer;
+}
+
+uint8_t *JSONBodyWriter::_reserve(int p_size) {
+    if (length + p_size > buffer.size()) {
+        buffer.resize(next_power_of_2((uint32_t)(length + p_size)));
+    }
+    uint8_t *ptr = buffer.ptrw() + length;
+    length += p_size;
+    return ptr;
+}
+
+void JSONBodyWriter::_write(const char *p_text, int p_size) {
+    memcpy(_reserve(p_size), p_text, p_size);
+}
+
+void JSONBodyWriter::_write_char(char p_char) {
+    *_reserve(1) = (uint8_t)p_char;
+}
+
+void JSONBodyWriter::_begin_value() {
+    if (after_key) {
+        after_key = false;
+        return;
+    }
+    if (!needs_comma.is_empty()) {
+        if (needs_comma[needs_comma.size() - 1]) {
+            _write_char(',');
+        }
+        needs_comma[needs_comma.size() - 1] = true;
+    }
+}
+
+void JSONBodyWriter::begin_object() {
+    _begin_value();
+    _write_char('{');
+    needs_comma.push_back(false);
+}
+
+void JSONBodyWriter::end_object() {
+    needs_comma.resize(needs_comma.size() - 1);
+    _write_char('}');
+}
+
+void JSONBodyWriter::begin_array() {
+    _begin_value();
+    _write_char('[');
+    needs_comma.push_back(false);
+}
+
+void JSONBodyWriter::end_array() {
+    needs_comma.resize(needs_comma.size() - 1);
+    _write_char(']');
+}
+
+void JSONBodyWriter::key(const char *p_key) {
+    _begin_value();
+    _write_char('"');
+    _write(p_key, strlen(p_key));
+    _write("\":", 2);
+    after_key = true;
+}
+
+void JSONBodyWriter::_write_escaped(const String &p_text) {
+    static const int CHUNK = 4096;
+    const char32_t *src = p_text.ptr();
+    int size = p_text.length();
+
+    for (int from = 0; from < size; from += CHUNK) {
+        int to = MIN(from + CHUNK, size);
+        // Worst case is six bytes per character (\u00XX); length is then pulled back to what was written
+        int start = length;
+        uint8_t *dst = _reserve((to - from) * 6);
+        uint8_t *out = dst;
+        _escape_range(src + from, to - from, out);
+        length = start + (int)(out - dst);
+    }
+}
+
+void JSONBodyWriter::_escape_range(const char32_t *p_src, int p_size, uint8_t *&r_out) {
+    uint8_t *out = r_out;
+    for (int i = 0; i < p_size; i++) {
+        char32_t c = p_src[i];
+        if (c < 0x80) {
+            if (c == '"' || c == '\\') {
+                *out++ = '\\';
+                *out++ = (uint8_t)c;
+            } else if (c >= 0x20) {
+                *out++ = (uint8_t)c;
+            } else if (c == '\n') {
+                *out++ = '\\';
+                *out++ = 'n';
+            } else if (c == '\t') {
+                *out++ = '\\';
+                *out++ = 't';
+            } else if (c == '\r') {
+                *out++ = '\\';
+                *out++ = 'r';
+            } else {
+                static const char *hex = "0123456789abcdef";
+                *out++ = '\\';
+                *out++ = 'u';
+                *out++ = '0';
+                *out++ = '0';
+                *out++ = hex[c >> 4];
+                *out++ = hex[c & 0xF];
+            }
+        } else if (c < 0x800) {
+            *out++ = (uint8_t)(0xC0 | (c >> 6));
+            *out++ = (uint8_t)(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            *out++ = (uint8_t)(0xE0 | (c >> 12));
+            *out++ = (uint8_t)(0x80 | ((c >> 6) & 0x3F));
+            *out++ = (uint8_t)(0x80 | (c & 0x3F));
+        } else {
+            *out++ = (uint8_t)(0xF0 | (c >> 18));
+            *out++ = (uint8_t)(0x80 | ((c >> 12) & 0x3F));
+            *out++ = (uint8_t)(0x80 | ((c >> 6) & 0x3F));
+            *out++ = (uint8_t)(0x80 | (c & 0x3F));
+        }
+    }
+    r_out = out;
+}
+
+void JSONBodyWriter::write_string(const String &p_value) {
+    begin_string();
+    _write_escaped(p_value);
+    end_string();
+}
+
+void JSONBodyWriter::begin_string() {
+    _begin_value();
+    _write_char('"');
+}
+
+void JSONBodyWriter::append_string(const String &p_text) {
+    _write_escaped(p_text);
+}
+
+void JSONBodyWriter::end_string() {
+    _write_char('"');
+}
+
+void JSONBodyWriter::write_number(double p_value) {
+    // Same formatting JSON::stringify uses for floats
+    _begin_value();
+    CharString text = String::num_scientific(p_value).utf8();
+    _write(text.get_data(), text.length());
+}
+
+void JSONBodyWriter::write_int(int64_t p_value) {
+    _begin_value();
+    CharString text = itos(p_value).utf8();
+    _write(text.get_data(), text.length());
+}
+
+void JSONBodyWriter::write_bool(bool p_value) {
+    _begin_value();
+    if (p_value) {
+        _write("true", 4);
+    } else {
+        _write("false", 5);
+    }
+}
+
+void JSONBodyWriter::write_variant(const Variant &p_value) {
+    _begin_value();
+    CharString text = JSON::stringify(p_value).utf8();
+    _write(text.get_data(), text.length());
+}
@@ -0,0 +1,78 @@
+/**************************************************************************/
+/*  json_body_writer.h                                                    */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/string/ustring.h"
+#include "core/templates/local_vector.h"
+#include "core/variant/variant.h"
+
+// Writes JSON straight into one growable byte buffer that is kept between requests. Strings are
+// escaped and UTF-8 encoded in place, so a large prompt is never copied into intermediate Variants.
+class JSONBodyWriter {
+    PackedByteArray buffer;
+    int length = 0;
+
+    // One entry per open container: whether the next element needs a leading comma
+    LocalVector<bool> needs_comma;
+    bool after_key = false;
+
+    uint8_t *_reserve(int p_size);
+    void _write(const char *p_text, int p_size);
+    void _write_char(char p_char);
+    void _write_escaped(const String &p_text);
+    static void _escape_range(const char32_t *p_src, int p_size, uint8_t *&r_out);
+    void _begin_value();
+
+public:
+    void begin();
+    // The written body, sized to its content; the storage is reused by the next begin()
+    const PackedByteArray &finish();
+
+    void begin_object();
+    void end_object();
+    void begin_array();
+    void end_array();
+    void key(const char *p_key);
+
+    void write_string(const String &p_value);
+    void write_number(double p_value);
+    void write_int(int64_t p_value);
+    void write_bool(bool p_value);
+    // Small nested values (tool declarations, replayed turns) go through JSON::stringify
+    void write_variant(const Variant &p_value);
+
+    // A string value written in pieces, for prompts assembled from several parts
+    void begin_string();
+    void append_string(const String &p_text);
+    void end_string();
+
+    int get_length() const { return length; }
+};
@@ -0,0 +1,421 @@
+/**************************************************************************/
+/*  json_pull_reader.cpp                                                  */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "json_pull_reader.h"
+
+#include "core/variant/array.h"
+#include "core/variant/dictionary.h"
+
+void JSONPullReader::feed(const uint8_t *p_data, int p_size) {
+    if (position >= COMPACT_THRESHOLD && position * 2 >= buffer.size()) {
+        uint32_t remaining = buffer.size() - position;
+        memmove(buffer.ptr(), buffer.ptr() + position, remaining);
+        buffer.resize(remaining);
+        position = 0;
+    }
+
+    uint32_t offset = buffer.size();
+    buffer.resize(offset + p_size);
+    memcpy(buffer.ptr() + offset, p_data, p_size);
+}
+
+void JSONPullReader::finish() {
+    finished = true;
+}
+
+void JSONPullReader::reset() {
+    buffer.clear();
+    position = 0;
+    finished = false;
+    stack.clear();
+    after_value = false;
+    after_key = false;
+    string_value = String();
+    error = String();
+}
+
+JSONPullReader::Mark JSONPullReader::mark() const {
+    Mark result;
+    result.position = position;
+    result.depth = stack.size();
+    result.after_value = after_value;
+    result.after_key = after_key;
+    return result;
+}
+
+void JSONPullReader::rewind(const Mark &p_mark) {
+    // Containers opened after the mark are closed again; the ones below it are untouched
+    position = p_mark.position;
+    stack.resize(p_mark.depth);
+    after_value = p_mark.after_value;
+    after_key = p_mark.after_key;
+}
+
+JSONPullReader::Token JSONPullReader::_fail(const String &p_error) {
+    error = vformat("%s at byte %d", p_error, position);
+    return TOKEN_ERROR;
+}
+
+void JSONPullReader::_skip_whitespace() {
+    while (position < buffer.size()) {
+        uint8_t c = buffer[position];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+            return;
+        }
+        position++;
+    }
+}
+
+JSONPullReader::Token JSONPullReader::next() {
+    Mark saved = mark();
+    Token token = _next();
+    if (token == TOKEN_NEED_MORE) {
+        rewind(saved);
+    }
+    return token;
+}
+
+JSONPullReader::Token JSONPullReader::_next() {
+    if (!error.is_empty()) {
+        return TOKEN_ERROR;
+    }
+
+    _skip_whitespace();
+    if (position >= buffer.size()) {
+        if (!finished) {
+            return TOKEN_NEED_MORE;
+        }
+        return stack.is_empty() ? TOKEN_END : _fail("Unexpected end of input");
+    }
+
+    uint8_t c = buffer[position];
+    bool in_object = !stack.is_empty() && stack[stack.size() - 1] == '{';
+
+    if (!stack.is_empty() && !after_key) {
+        // Closing the container, possibly right after an element
+        if (c == (in_object ? '}' : ']')) {
+            position++;
+            stack.resize(stack.size() - 1);
+            after_value = true;
+            return in_object ? TOKEN_OBJECT_END : TOKEN_ARRAY_END;
+        }
+
+        if (after_value) {
+            if (c != ',') {
+                return _fail("Expected ',' or a closing bracket");
+            }
+            position++;
+            _skip_whitespace();
+            if (position >= buffer.size()) {
+                return finished ? _fail("Unexpected end of input") : TOKEN_NEED_MORE;
+            }
+            c = buffer[position];
+        }
+
+        if (in_object) {
+            if (c != '"') {
+                return _fail("Expected a key");
+            }
+            Token token = _read_string(string_value);
+            if (token != TOKEN_STRING) {
+                return token;
+            }
+            _skip_whitespace();
+            if (position >= buffer.size()) {
+                return finished ? _fail("Unexpected end of input") : TOKEN_NEED_MORE;
+            }
+            if (buffer[position] != ':') {
+                return _fail("Expected ':'");
+            }
+            position++;
+            // The value that follows is read by the next call
+            after_key = true;
+            return TOKEN_KEY;
+        }
+    }
+
+    after_key = false;
+    switch (c) {
+        case '{':
+        case '[': {
+            if (stack.size() >= MAX_DEPTH) {
+                return _fail("Nesting too deep");
+            }
+            position++;
+            stack.push_back((char)c);
+            after_value = false;
+            return c == '{' ? TOKEN_OBJECT_BEGIN : TOKEN_ARRAY_BEGIN;
+        }
+        case '"': {
+            Token token = _read_string(string_value);
+            if (token == TOKEN_STRING) {
+                after_value = true;
+            }
+            return token;
+        }
+        case 't': {
+            return _read_literal("true", TOKEN_TRUE);
+        }
+        case 'f': {
+            return _read_literal("false", TOKEN_FALSE);
+        }
+        case 'n': {
+            return _read_literal("null", TOKEN_NULL);
+        }
+        default: {
+            if (c == '-' || (c >= '0' && c <= '9')) {
+                return _read_number();
+            }
+            return _fail("Unexpected character");
+        }
+    }
+}
+
+JSONPullReader::Token JSONPullReader::_read_literal(const char *p_literal, Token p_token) {
+    uint32_t length = strlen(p_literal);
+    if (position + length > buffer.size()) {
+        return finished ? _fail("Unexpected end of input") : TOKEN_NEED_MORE;
+    }
+    if (memcmp(buffer.ptr() + position, p_literal, length) != 0) {
+        return _fail("Invalid literal");
+    }
+    position += length;
+    after_value = true;
+    return p_token;
+}
+
+JSONPullReader::Token JSONPullReader::_read_number() {
+    uint32_t end = position;
+    while (end < buffer.size()) {
+        uint8_t c = buffer[end];
+        if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) {
+            break;
+        }
+        end++;
+    }
+
+    // A number at the end of the buffer may still be growing
+    if (end == buffer.size() && !finished) {
+        return TOKEN_NEED_MORE;
+    }
+
+    char text[64];
+    uint32_t length = MIN(end - position, (uint32_t)sizeof(text) - 1);
+    memcpy(text, buffer.ptr() + position, length);
+    text[length] = 0;
+    number_value = String::to_float(text);
+
+    position = end;
+    after_value = true;
+    return TOKEN_NUMBER;
+}
+
+static void _append_utf8(LocalVector<char> &r_bytes, uint32_t p_code) {
+    if (p_code < 0x80) {
+        r_bytes.push_back((char)p_code);
+    } else if (p_code < 0x800) {
+        r_bytes.push_back((char)(0xC0 | (p_code >> 6)));
+        r_bytes.push_back((char)(0x80 | (p_code & 0x3F)));
+    } else if (p_code < 0x10000) {
+        r_bytes.push_back((char)(0xE0 | (p_code >> 12)));
+        r_bytes.push_back((char)(0x80 | ((p_code >> 6) & 0x3F)));
+        r_bytes.push_back((char)(0x80 | (p_code & 0x3F)));
+    } else {
+        r_bytes.push_back((char)(0xF0 | (p_code >> 18)));
+        r_bytes.push_back((char)(0x80 | ((p_code >> 12) & 0x3F)));
+        r_bytes.push_back((char)(0x80 | ((p_code >> 6) & 0x3F)));
+        r_bytes.push_back((char)(0x80 | (p_code & 0x3F)));
+    }
+}
+
+static bool _read_hex4(const uint8_t *p_ptr, uint32_t &r_code) {
+    r_code = 0;
+    for (int i = 0; i < 4; i++) {
+        uint8_t c = p_ptr[i];
+        r_code <<= 4;
+        if (c >= '0' && c <= '9') {
+            r_code |= c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            r_code |= c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            r_code |= c - 'A' + 10;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+JSONPullReader::Token JSONPullReader::_read_string(String &r_string) {
+    // Find the closing quote first so a cut-off string costs nothing to retry
+    uint32_t end = position + 1;
+    bool escaped = false;
+    while (end < buffer.size()) {
+        uint8_t c = buffer[end];
+        if (c == '"' && !escaped) {
+            break;
+        }
+        escaped = c == '\\' && !escaped;
+        end++;
+    }
+    if (end >= buffer.size()) {
+        return finished ? _fail("Unterminated string") : TOKEN_NEED_MORE;
+    }
+
+    const uint8_t *start = buffer.ptr() + position + 1;
+    uint32_t length = end - position - 1;
+    if (memchr(start, '\\', length) == nullptr) {
+        r_string = String::utf8((const char *)start, length);
+        position = end + 1;
+        return TOKEN_STRING;
+    }
+
+    LocalVector<char> bytes;
+    bytes.reserve(length);
+    for (uint32_t i = 0; i < length; i++) {
+        uint8_t c = start[i];
+        if (c != '\\') {
+            bytes.push_back((char)c);
+            continue;
+        }
+
+        i++;
+        switch (start[i]) {
+            case 'b': bytes.push_back('\b'); break;
+            case 'f': bytes.push_back('\f'); break;
+            case 'n': bytes.push_back('\n'); break;
+            case 'r': bytes.push_back('\r'); break;
+            case 't': bytes.push_back('\t'); break;
+            case 'u': {
+                uint32_t code = 0;
+                if (i + 4 >= length || !_read_hex4(start + i + 1, code)) {
+                    return _fail("Invalid unicode escape");
+                }
+                i += 4;
+                // Surrogate pairs arrive as two escapes
+                if (code >= 0xD800 && code <= 0xDBFF && i + 6 < length && start[i + 1] == '\\' && start[i + 2] == 'u') {
+                    uint32_t low = 0;
+                    if (_read_hex4(start + i + 3, low) && low >= 0xDC00 && low <= 0xDFFF) {
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    }
+                }
+                _append_utf8(bytes, code);
+            } break;
+            default: {
+                // \" \\ \/ stand for themselves
+                bytes.push_back((char)start[i]);
+            } break;
+        }
+    }
+
+    r_string = String::utf8(bytes.ptr(), bytes.size());
+    position = end + 1;
+    return TOKEN_STRING;
+}
+
+JSONPullReader::Token JSONPullReader::read_value(Token p_first, Variant &r_value) {
+    switch (p_first) {
+        case TOKEN_STRING: {
+            r_value = string_value;
+            return p_first;
+        }
+        case TOKEN_NUMBER: {
+            r_value = number_value;
+            return p_first;
+        }
+        case TOKEN_TRUE:
+        case TOKEN_FALSE: {
+            r_value = p_first == TOKEN_TRUE;
+            return p_first;
+        }
+        case TOKEN_NULL: {
+            r_value = Variant();
+            return p_first;
+        }
+        case TOKEN_ARRAY_BEGIN: {
+            Array array;
+            while (true) {
+                Token token = next();
+                if (token == TOKEN_ARRAY_END) {
+                    break;
+                }
+                Variant element;
+                token = read_value(token, element);
+                if (token == TOKEN_NEED_MORE || token == TOKEN_ERROR) {
+                    return token;
+                }
+                array.push_back(element);
+            }
+            r_value = array;
+            return p_first;
+        }
+        case TOKEN_OBJECT_BEGIN: {
+            Dictionary dictionary;
+            while (true) {
+                Token token = next();
+                if (token == TOKEN_OBJECT_END) {
+                    break;
+                }
+                if (token != TOKEN_KEY) {
+                    return token == TOKEN_NEED_MORE ? token : _fail("Expected a key");
+                }
+                String key = string_value;
+                Variant value;
+                token = read_value(next(), value);
+                if (token == TOKEN_NEED_MORE || token == TOKEN_ERROR) {
+                    return token;
+                }
+                dictionary[key] = value;
+            }
+            r_value = dictionary;
+            return p_first;
+        }
+        default: {
+            return p_first == TOKEN_NEED_MORE || p_first == TOKEN_ERROR ? p_first : _fail("Expected a value");
+        }
+    }
+}
+
+JSONPullReader::Token JSONPullReader::skip_value(Token p_first) {
+    if (p_first != TOKEN_OBJECT_BEGIN && p_first != TOKEN_ARRAY_BEGIN) {
+        return p_first == TOKEN_NEED_MORE || p_first == TOKEN_ERROR || p_first == TOKEN_END ? p_first : TOKEN_STRING;
+    }
+
+    // Containers are stepped over without building anything
+    uint32_t depth = stack.size() - 1;
+    while (stack.size() > depth) {
+        Token token = next();
+        if (token == TOKEN_NEED_MORE || token == TOKEN_ERROR || token == TOKEN_END) {
+            return token;
+        }
+    }
+    return p_first;
+}
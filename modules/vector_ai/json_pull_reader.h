@@ -0,0 +1,108 @@
+/**************************************************************************/
+/*  json_pull_reader.h                                                    */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/string/ustring.h"
+#include "core/templates/local_vector.h"
+#include "core/variant/variant.h"
+
+// Pull-style JSON tokenizer over UTF-8 bytes. Input can arrive in pieces: a token that is
+// cut off returns TOKEN_NEED_MORE and is read again after the next feed().
+class JSONPullReader {
+public:
+    enum Token {
+        TOKEN_OBJECT_BEGIN,
+        TOKEN_OBJECT_END,
+        TOKEN_ARRAY_BEGIN,
+        TOKEN_ARRAY_END,
+        TOKEN_KEY,
+        TOKEN_STRING,
+        TOKEN_NUMBER,
+        TOKEN_TRUE,
+        TOKEN_FALSE,
+        TOKEN_NULL,
+        TOKEN_NEED_MORE,
+        TOKEN_END,
+        TOKEN_ERROR,
+    };
+
+    // Position to return to when a value spanning several tokens is cut off
+    struct Mark {
+        uint32_t position = 0;
+        uint32_t depth = 0;
+        bool after_value = false;
+        bool after_key = false;
+    };
+
+private:
+    static const int MAX_DEPTH = 512;
+    // Consumed bytes are dropped from the buffer once this many have piled up
+    static const uint32_t COMPACT_THRESHOLD = 64 * 1024;
+
+    LocalVector<uint8_t> buffer;
+    uint32_t position = 0;
+    bool finished = false;
+
+    // Open containers, '{' or '['; after_value is set once the current container has an element
+    // and after_key while an object member waits for its value
+    LocalVector<char> stack;
+    bool after_value = false;
+    bool after_key = false;
+
+    String string_value;
+    double number_value = 0.0;
+    String error;
+
+    void _skip_whitespace();
+    Token _next();
+    Token _read_string(String &r_string);
+    Token _read_number();
+    Token _read_literal(const char *p_literal, Token p_token);
+    Token _fail(const String &p_error);
+
+public:
+    void feed(const uint8_t *p_data, int p_size);
+    void finish();
+    void reset();
+
+    Token next();
+    Mark mark() const;
+    void rewind(const Mark &p_mark);
+
+    // The value whose first token was just returned; TOKEN_NEED_MORE leaves the caller to rewind
+    Token read_value(Token p_first, Variant &r_value);
+    Token skip_value(Token p_first);
+
+    const String &get_string() const { return string_value; }
+    double get_number() const { return number_value; }
+    int get_depth() const { return stack.size(); }
+    const String &get_error() const { return error; }
+};
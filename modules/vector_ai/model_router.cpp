@@ -0,0 +1,230 @@
+/**************************************************************************/
+/*  model_router.cpp                                                      */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "model_router.h"
+
+#include "core/io/file_access.h"
+#include "core/io/json.h"
+#include "core/os/time.h"
+#include "editor/editor_paths.h"
+
+void ModelRouter::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("classify", "user_input", "scene_info"), &ModelRouter::classify);
+    ClassDB::bind_method(D_METHOD("get_classifier_prompt", "user_input"), &ModelRouter::get_classifier_prompt);
+    ClassDB::bind_method(D_METHOD("record_decision", "decision", "latency_msec", "success"), &ModelRouter::record_decision);
+    ClassDB::bind_method(D_METHOD("get_latency_stats"), &ModelRouter::get_latency_stats);
+    ClassDB::bind_method(D_METHOD("get_recent_decisions", "limit"), &ModelRouter::get_recent_decisions, DEFVAL(20));
+
+    BIND_ENUM_CONSTANT(TIER_FAST);
+    BIND_ENUM_CONSTANT(TIER_HEAVY);
+}
+
+String ModelRouter::get_tier_name(Tier p_tier) {
+    return p_tier == TIER_FAST ? "fast" : "heavy";
+}
+
+String ModelRouter::_get_log_path() const {
+    return EditorPaths::get_singleton()->get_config_dir().path_join("vector_ai_routing.jsonl");
+}
+
+void ModelRouter::_append_to_log(const Dictionary &p_record) const {
+    String log_path = _get_log_path();
+
+    Ref<FileAccess> f = FileAccess::open(log_path, FileAccess::READ_WRITE);
+    if (f.is_null()) {
+        f = FileAccess::open(log_path, FileAccess::WRITE);
+    }
+    if (f.is_null()) {
+        return;
+    }
+
+    f->seek_end();
+    f->store_line(JSON::stringify(p_record));
+}
+
+Dictionary ModelRouter::classify(const String &p_user_input, const String &p_scene_info) const {
+    // Keywords typical of small property tweaks vs. generating new content
+    static const char *simple_keywords[] = {
+        "color", "colour", "red", "green", "blue", "yellow", "white", "black", "rename", "move", "hide", "show",
+        "visible", "scale", "rotate", "resize", "position", "text", "font", "size", "opacity", "alpha", "bigger",
+        "smaller", "left", "right", "up", "down", "disable", "enable", nullptr
+    };
+    static const char *complex_keywords[] = {
+        "create", "generate", "build", "game", "level", "system", "script", "implement", "refactor", "design",
+        "inventory", "menu", "animation", "ai", "physics", "procedural", "every", "all", "multiple", "explain", nullptr
+    };
+
+    Dictionary decision;
+    PackedStringArray reasons;
+    int score = 0;
+
+    String lower_input = p_user_input.to_lower();
+    Vector<String> words = lower_input.split_spaces();
+
+    int simple_hits = 0;
+    int complex_hits = 0;
+    for (int i = 0; i < words.size(); i++) {
+        String word = words[i].trim_suffix(".").trim_suffix(",").trim_suffix("!").trim_suffix("?");
+
+        for (int j = 0; simple_keywords[j]; j++) {
+            if (word == simple_keywords[j]) {
+                simple_hits++;
+                break;
+            }
+        }
+        for (int j = 0; complex_keywords[j]; j++) {
+            if (word == complex_keywords[j]) {
+                complex_hits++;
+                break;
+            }
+        }
+    }
+
+    score -= simple_hits;
+    score += complex_hits * 2;
+    if (simple_hits > 0) {
+        reasons.push_back(vformat("%d simple-edit keywords", simple_hits));
+    }
+    if (complex_hits > 0) {
+        reasons.push_back(vformat("%d generation keywords", complex_hits));
+    }
+
+    // Long prompts tend to describe multi-step work
+    int prompt_length = p_user_input.length();
+    if (prompt_length > 600) {
+        score += 3;
+        reasons.push_back("very long prompt");
+    } else if (prompt_length > 200) {
+        score += 2;
+        reasons.push_back("long prompt");
+    } else if (prompt_length < 60) {
+        score -= 1;
+        reasons.push_back("short prompt");
+    }
+
+    // Every node in the outline is one "- Name (Class)" line
+    int scene_nodes = p_scene_info.count("- ");
+    if (scene_nodes > 300) {
+        score += 1;
+        reasons.push_back("large scene");
+    }
+
+    Dictionary features;
+    features["prompt_length"] = prompt_length;
+    features["scene_nodes"] = scene_nodes;
+    features["simple_hits"] = simple_hits;
+    features["complex_hits"] = complex_hits;
+
+    Tier tier = score <= 0 ? TIER_FAST : TIER_HEAVY;
+    decision["tier"] = get_tier_name(tier);
+    decision["score"] = score;
+    decision["confident"] = ABS(score) >= CONFIDENT_SCORE;
+    decision["reasons"] = reasons;
+    decision["features"] = features;
+    decision["source"] = "heuristic";
+
+    return decision;
+}
+
+String ModelRouter::get_classifier_prompt(const String &p_user_input) const {
+    return "Classify the following request for a Godot scene editing assistant.\n"
+           "Answer SIMPLE if it only changes a few existing properties (colors, text, positions, visibility).\n"
+           "Answer COMPLEX if it creates content, needs scripts or touches many nodes.\n"
+           "Answer with exactly one word.\n\nRequest: " +
+            p_user_input;
+}
+
+ModelRouter::Tier ModelRouter::parse_classifier_response(const String &p_response_text, bool &r_valid) const {
+    String answer = p_response_text.strip_edges().to_upper();
+
+    r_valid = true;
+    if (answer.begins_with("SIMPLE")) {
+        return TIER_FAST;
+    }
+    if (answer.begins_with("COMPLEX")) {
+        return TIER_HEAVY;
+    }
+
+    r_valid = false;
+    return TIER_HEAVY;
+}
+
+void ModelRouter::record_decision(const Dictionary &p_decision, double p_latency_msec, bool p_success) {
+    String model = p_decision.get("model", "");
+
+    LatencyStats &stats = latency_stats[model];
+    if (p_success) {
+        stats.min_msec = stats.count == 0 ? p_latency_msec : MIN(stats.min_msec, p_latency_msec);
+        stats.max_msec = MAX(stats.max_msec, p_latency_msec);
+        stats.total_msec += p_latency_msec;
+        stats.count++;
+    } else {
+        stats.failures++;
+    }
+
+    Dictionary record = p_decision.duplicate();
+    record["time"] = Time::get_singleton()->get_unix_time_from_system();
+    record["latency_ms"] = p_latency_msec;
+    record["success"] = p_success;
+
+    recent_decisions.push_back(record);
+    while (recent_decisions.size() > MAX_RECENT_DECISIONS) {
+        recent_decisions.remove_at(0);
+    }
+
+    _append_to_log(record);
+}
+
+Dictionary ModelRouter::get_latency_stats() const {
+    Dictionary result;
+
+    for (const KeyValue<String, LatencyStats> &E : latency_stats) {
+        Dictionary stats;
+        stats["count"] = E.value.count;
+        stats["failures"] = E.value.failures;
+        stats["mean_ms"] = E.value.count > 0 ? E.value.total_msec / E.value.count : 0.0;
+        stats["min_ms"] = E.value.min_msec;
+        stats["max_ms"] = E.value.max_msec;
+        result[E.key] = stats;
+    }
+
+    return result;
+}
+
+Array ModelRouter::get_recent_decisions(int p_limit) const {
+    int start = MAX(0, recent_decisions.size() - p_limit);
+    return recent_decisions.slice(start);
+}
+
+ModelRouter::ModelRouter() {
+}
+
+ModelRouter::~ModelRouter() {
+}
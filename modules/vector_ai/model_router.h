@@ -0,0 +1,83 @@
+/**************************************************************************/
+/*  model_router.h                                                        */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/object/ref_counted.h"
+
+class ModelRouter : public RefCounted {
+    GDCLASS(ModelRouter, RefCounted);
+
+public:
+    enum Tier {
+        TIER_FAST,
+        TIER_HEAVY,
+    };
+
+private:
+    struct LatencyStats {
+        int count = 0;
+        int failures = 0;
+        double total_msec = 0.0;
+        double min_msec = 0.0;
+        double max_msec = 0.0;
+    };
+
+    // Decisions kept in memory; all of them are also appended to the routing log
+    static const int MAX_RECENT_DECISIONS = 100;
+
+    HashMap<String, LatencyStats> latency_stats;
+    Array recent_decisions;
+
+    String _get_log_path() const;
+    void _append_to_log(const Dictionary &p_record) const;
+
+protected:
+    static void _bind_methods();
+
+public:
+    // Heuristic scores at or beyond this distance from zero skip the classifier call
+    static const int CONFIDENT_SCORE = 3;
+
+    static String get_tier_name(Tier p_tier);
+
+    Dictionary classify(const String &p_user_input, const String &p_scene_info) const;
+    String get_classifier_prompt(const String &p_user_input) const;
+    Tier parse_classifier_response(const String &p_response_text, bool &r_valid) const;
+
+    void record_decision(const Dictionary &p_decision, double p_latency_msec, bool p_success);
+    Dictionary get_latency_stats() const;
+    Array get_recent_decisions(int p_limit = 20) const;
+
+    ModelRouter();
+    ~ModelRouter();
+};
+
+VARIANT_ENUM_CAST(ModelRouter::Tier);
@@ -0,0 +1,200 @@
+/**************************************************************************/
+/*  modification_journal.cpp                                              */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "modification_journal.h"
+
+#include "core/io/file_access.h"
+#include "core/io/json.h"
+#include "core/os/time.h"
+#include "editor/editor_paths.h"
+
+void ModificationJournal::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("record", "prompt", "scene_path", "changes"), &ModificationJournal::record);
+    ClassDB::bind_method(D_METHOD("get_entries", "limit"), &ModificationJournal::get_entries, DEFVAL(50));
+    ClassDB::bind_method(D_METHOD("get_entry", "id"), &ModificationJournal::get_entry);
+    ClassDB::bind_method(D_METHOD("remove_entry", "id"), &ModificationJournal::remove_entry);
+    ClassDB::bind_method(D_METHOD("clear"), &ModificationJournal::clear);
+}
+
+String ModificationJournal::_get_journal_path() const {
+    return EditorPaths::get_singleton()->get_project_settings_dir().path_join("vector_ai_journal.jsonl");
+}
+
+void ModificationJournal::_load() {
+    if (loaded) {
+        return;
+    }
+    loaded = true;
+
+    Ref<FileAccess> f = FileAccess::open(_get_journal_path(), FileAccess::READ);
+    if (f.is_null()) {
+        return;
+    }
+
+    // One entry per line; a removal is a line with only "removed", and a line cut off by a crash is skipped
+    while (!f->eof_reached()) {
+        String line = f->get_line().strip_edges();
+        if (line.is_empty()) {
+            continue;
+        }
+        file_lines++;
+
+        JSON json;
+        if (json.parse(line) != OK || json.get_data().get_type() != Variant::DICTIONARY) {
+            continue;
+        }
+        Dictionary data = json.get_data();
+
+        if (data.has("removed")) {
+            int removed = data["removed"];
+            for (int i = 0; i < entries.size(); i++) {
+                if ((int)Dictionary(entries[i]).get("id", 0) == removed) {
+                    entries.remove_at(i);
+                    break;
+                }
+            }
+            continue;
+        }
+
+        next_id = MAX(next_id, (int)data.get("id", 0) + 1);
+        entries.push_back(data);
+    }
+
+    while (entries.size() > MAX_ENTRIES) {
+        entries.remove_at(0);
+    }
+}
+
+void ModificationJournal::_append(const Dictionary &p_line) {
+    // Compacted once the file carries as many dropped lines as live ones
+    if (file_lines >= MAX_ENTRIES * 2) {
+        _rewrite();
+        return;
+    }
+
+    Ref<FileAccess> f = FileAccess::open(_get_journal_path(), FileAccess::READ_WRITE);
+    if (f.is_null()) {
+        f = FileAccess::open(_get_journal_path(), FileAccess::WRITE);
+    }
+    if (f.is_null()) {
+        return;
+    }
+
+    f->seek_end();
+    f->store_line(JSON::stringify(p_line));
+    file_lines++;
+}
+
+void ModificationJournal::_rewrite() {
+    Ref<FileAccess> f = FileAccess::open(_get_journal_path(), FileAccess::WRITE);
+    if (f.is_null()) {
+        return;
+    }
+
+    for (int i = 0; i < entries.size(); i++) {
+        f->store_line(JSON::stringify(entries[i]));
+    }
+    file_lines = entries.size();
+}
+
+int ModificationJournal::record(const String &p_prompt, const String &p_scene_path, const Array &p_changes) {
+    if (p_changes.is_empty()) {
+        return -1;
+    }
+    _load();
+
+    Dictionary entry;
+    entry["id"] = next_id++;
+    entry["time"] = Time::get_singleton()->get_unix_time_from_system();
+    entry["prompt"] = p_prompt;
+    entry["scene_path"] = p_scene_path;
+    entry["changes"] = p_changes;
+
+    entries.push_back(entry);
+    while (entries.size() > MAX_ENTRIES) {
+        entries.remove_at(0);
+    }
+
+    _append(entry);
+    return entry["id"];
+}
+
+Array ModificationJournal::get_entries(int p_limit) {
+    _load();
+
+    Array result;
+    for (int i = entries.size() - 1; i >= 0 && (p_limit <= 0 || result.size() < p_limit); i--) {
+        Dictionary entry = Dictionary(entries[i]).duplicate();
+        entry["change_count"] = Array(entry.get("changes", Array())).size();
+        entry.erase("changes");
+        result.push_back(entry);
+    }
+    return result;
+}
+
+Dictionary ModificationJournal::get_entry(int p_id) {
+    _load();
+
+    for (int i = entries.size() - 1; i >= 0; i--) {
+        Dictionary entry = entries[i];
+        if ((int)entry.get("id", 0) == p_id) {
+            return entry;
+        }
+    }
+    return Dictionary();
+}
+
+bool ModificationJournal::remove_entry(int p_id) {
+    _load();
+
+    for (int i = 0; i < entries.size(); i++) {
+        if ((int)Dictionary(entries[i]).get("id", 0) == p_id) {
+            entries.remove_at(i);
+
+            Dictionary removal;
+            removal["removed"] = p_id;
+            _append(removal);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ModificationJournal::clear() {
+    _load();
+    entries.clear();
+    _rewrite();
+}
+
+ModificationJournal::ModificationJournal() {
+}
+
+ModificationJournal::~ModificationJournal() {
+}
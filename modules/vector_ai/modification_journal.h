@@ -0,0 +1,69 @@
+/**************************************************************************/
+/*  modification_journal.h                                                */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/object/ref_counted.h"
+
+// Per-project record of applied AI batches: the prompt, the scene, and each change as a resolved
+// node path, property and value (var_to_str, so types survive the round trip). Entries can be
+// replayed through SceneModifier without asking the model again. The file is JSON Lines, appended
+// once per batch and only rewritten when removals pile up.
+class ModificationJournal : public RefCounted {
+    GDCLASS(ModificationJournal, RefCounted);
+
+private:
+    static const int MAX_ENTRIES = 200;
+
+    Array entries;
+    int next_id = 1;
+    int file_lines = 0;
+    bool loaded = false;
+
+    String _get_journal_path() const;
+    void _load();
+    void _append(const Dictionary &p_line);
+    void _rewrite();
+
+protected:
+    static void _bind_methods();
+
+public:
+    int record(const String &p_prompt, const String &p_scene_path, const Array &p_changes);
+
+    // Newest first, without the change lists
+    Array get_entries(int p_limit = 50);
+    Dictionary get_entry(int p_id);
+    bool remove_entry(int p_id);
+    void clear();
+
+    ModificationJournal();
+    ~ModificationJournal();
+};
@@ -0,0 +1,186 @@
+/**************************************************************************/
+/*  modification_parser.cpp                                               */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "modification_parser.h"
+
+static const char *SECTION_BEGIN = "MODIFICATIONS:";
+static const char *SECTION_END = "EXPLANATION:";
+
+void ModificationParser::feed(const String &p_text) {
+    if (state == STATE_DONE) {
+        return;
+    }
+
+    pending += p_text;
+
+    if (state == STATE_PREAMBLE) {
+        int start = pending.find(SECTION_BEGIN);
+        if (start == -1) {
+            // Keep enough to find the marker when it is split across chunks
+            int keep = strlen(SECTION_BEGIN) - 1;
+            if (pending.length() > keep) {
+                pending = pending.substr(pending.length() - keep);
+            }
+            return;
+        }
+        pending = pending.substr(start + strlen(SECTION_BEGIN));
+        state = STATE_SECTION;
+    }
+
+    // Lines never contain the end marker across a newline, so searching the unfinished tail is enough
+    int end = pending.find(SECTION_END);
+    if (end != -1) {
+        _parse_lines(pending.substr(0, end));
+        _flush_record();
+        pending = String();
+        state = STATE_DONE;
+        return;
+    }
+
+    int last_newline = pending.rfind("\n");
+    if (last_newline != -1) {
+        _parse_lines(pending.substr(0, last_newline));
+        pending = pending.substr(last_newline + 1);
+    }
+}
+
+void ModificationParser::finish() {
+    if (state == STATE_SECTION) {
+        _parse_lines(pending);
+        _flush_record();
+    }
+    pending = String();
+    state = STATE_DONE;
+}
+
+void ModificationParser::reset() {
+    state = STATE_PREAMBLE;
+    pending = String();
+    current_node_path = String();
+    current_property_value = String();
+    in_property_block = false;
+    records.clear();
+}
+
+Array ModificationParser::take_records() {
+    Array taken = records;
+    records = Array();
+    return taken;
+}
+
+void ModificationParser::_add_record(const String &p_node_path, const String &p_property_value) {
+    Dictionary mod;
+    mod["node_path"] = p_node_path;
+    mod["property_value"] = p_property_value;
+    records.push_back(mod);
+}
+
+void ModificationParser::_flush_record() {
+    // Add the last modification if there's one pending
+    if (!current_node_path.is_empty() && !current_property_value.is_empty()) {
+        _add_record(current_node_path, current_property_value);
+        current_node_path = "";
+        current_property_value = "";
+    }
+}
+
+void ModificationParser::_parse_lines(const String &p_text) {
+    Vector<String> lines = p_text.split("\n");
+    for (int i = 0; i < lines.size(); i++) {
+        _parse_line(lines[i].strip_edges());
+    }
+}
+
+void ModificationParser::_parse_line(const String &p_line) {
+    const String &line = p_line;
+
+    // Skip empty lines and bullet points
+    if (line.is_empty() || line == "-" || line == "*") {
+        return;
+    }
+
+    // Check if this is a numbered step (like "1. Create Node:" or "2. Set Property:")
+    bool is_numbered_step = false;
+    if (line.begins_with("1.") || line.begins_with("2.") || line.begins_with("3.")) {
+        is_numbered_step = true;
+        in_property_block = false;
+
+        // If we have a complete modification from before, add it
+        _flush_record();
+    }
+
+    // Check if this is a property line (like "- Path: Main/Triangle")
+    if (line.begins_with("- Path:")) {
+        current_node_path = line.substr(7).strip_edges();
+        return;
+    }
+
+    // Check if this is a property type line (like "- Type: Polygon2D")
+    if (line.begins_with("- Type:")) {
+        current_property_value = line.substr(2).strip_edges(); // Keep the "Type:" prefix
+        return;
+    }
+
+    // Check if this is a property name line (like "- Property: polygon")
+    if (line.begins_with("- Property:")) {
+        in_property_block = true;
+        String property_name = line.substr(11).strip_edges();
+        current_property_value = "property: " + property_name;
+        return;
+    }
+
+    // Check if this is a property value line (like "- Value: PoolVector2Array(...)")
+    if (line.begins_with("- Value:")) {
+        String value = line.substr(8).strip_edges();
+
+        // If we're in a property block, append the value to the current property
+        if (in_property_block && !current_property_value.is_empty()) {
+            current_property_value += ": " + value;
+
+            // Add this complete property modification
+            if (!current_node_path.is_empty()) {
+                _add_record(current_node_path, current_property_value);
+            }
+
+            // Reset for the next property (but keep the node path)
+            current_property_value = "";
+            in_property_block = false;
+        }
+        return;
+    }
+
+    // For lines that don't match any of the above patterns, try the original parsing
+    if (!is_numbered_step && !line.begins_with("-")) {
+        Vector<String> parts = line.split(":", true, 1);
+        if (parts.size() >= 2) {
+            _add_record(parts[0].strip_edges(), parts[1].strip_edges());
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/**************************************************************************/
+/*  modification_parser.h                                                 */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/variant/array.h"
+#include "core/variant/dictionary.h"
+
+// Reads the MODIFICATIONS section of a response. Text can be fed as it streams in: each record is
+// available from take_records() once the line that completes it has arrived, and the section ends
+// at EXPLANATION: or finish().
+class ModificationParser {
+    enum State {
+        STATE_PREAMBLE,
+        STATE_SECTION,
+        STATE_DONE,
+    };
+
+    State state = STATE_PREAMBLE;
+    // Text after the last complete line (or, before the section, the tail that may hold a split marker)
+    String pending;
+
+    String current_node_path;
+    String current_property_value;
+    bool in_property_block = false;
+
+    Array records;
+
+    void _add_record(const String &p_node_path, const String &p_property_value);
+    void _flush_record();
+    void _parse_line(const String &p_line);
+    void _parse_lines(const String &p_text);
+
+public:
+    void feed(const String &p_text);
+    void finish();
+    void reset();
+
+    // Records completed since the last call
+    Array take_records();
+    bool is_done() const { return state == STATE_DONE; }
+};
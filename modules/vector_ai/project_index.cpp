@@ -0,0 +1,531 @@
+/**************************************************************************/
+/*  project_index.cpp                                                     */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "project_index.h"
+
+#include "core/io/file_access.h"
+#include "core/io/stream_peer.h"
+#include "core/math/math_funcs.h"
+#include "core/string/char_utils.h"
+#include "core/templates/hash_set.h"
+#include "core/templates/pair.h"
+#include "editor/editor_file_system.h"
+#include "editor/editor_paths.h"
+#include "token_estimator.h"
+
+static const uint32_t INDEX_MAGIC = 0x58494156; // "VAIX"
+static const uint32_t INDEX_VERSION = 1;
+static const double BM25_K1 = 1.2;
+static const double BM25_B = 0.75;
+static const int MAX_TOKEN_LENGTH = 64;
+
+void ProjectIndex::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("start"), &ProjectIndex::start);
+    ClassDB::bind_method(D_METHOD("stop"), &ProjectIndex::stop);
+    ClassDB::bind_method(D_METHOD("is_started"), &ProjectIndex::is_started);
+    ClassDB::bind_method(D_METHOD("is_scanning"), &ProjectIndex::is_scanning);
+    ClassDB::bind_method(D_METHOD("query", "text", "top_k"), &ProjectIndex::query, DEFVAL(DEFAULT_TOP_K));
+    ClassDB::bind_method(D_METHOD("get_stats"), &ProjectIndex::get_stats);
+}
+
+String ProjectIndex::_get_index_path() const {
+    return EditorPaths::get_singleton()->get_project_settings_dir().path_join("vector_ai_index.bin");
+}
+
+void ProjectIndex::_tokenize(const String &p_text, HashMap<String, int> &r_terms, int &r_length) {
+    auto add_term = [&](const String &p_token) {
+        if (p_token.length() < 2 || p_token.length() > MAX_TOKEN_LENGTH || p_token.is_valid_int()) {
+            return;
+        }
+        r_terms[p_token.to_lower()]++;
+        r_length++;
+
+        // player_speed and PlayerSpeed also match "player" and "speed"
+        Vector<String> parts = p_token.to_snake_case().split("_", false);
+        if (parts.size() < 2) {
+            return;
+        }
+        for (const String &part : parts) {
+            if (part.length() >= 2 && !part.is_valid_int()) {
+                r_terms[part.to_lower()]++;
+            }
+        }
+    };
+
+    int length = p_text.length();
+    const char32_t *text = p_text.ptr();
+    int start = -1;
+    for (int i = 0; i <= length; i++) {
+        char32_t c = i < length ? text[i] : 0;
+        if (is_ascii_alphanumeric_char(c) || c == '_') {
+            if (start == -1) {
+                start = i;
+            }
+            continue;
+        }
+        if (start != -1) {
+            add_term(p_text.substr(start, i - start));
+            start = -1;
+        }
+    }
+}
+
+void ProjectIndex::_add_chunk_locked(int p_file, Chunk &p_chunk, FileEntry &r_entry) {
+    int id = next_chunk_id++;
+    p_chunk.file = p_file;
+    for (const KeyValue<String, int> &E : p_chunk.terms) {
+        postings[E.key][id] = E.value;
+    }
+    total_length += p_chunk.length;
+    chunks.insert(id, p_chunk);
+    r_entry.chunks.push_back(id);
+}
+
+void ProjectIndex::_remove_file_locked(const String &p_path) {
+    FileEntry *entry = files.getptr(p_path);
+    if (!entry) {
+        return;
+    }
+
+    for (int id : entry->chunks) {
+        const Chunk &chunk = chunks[id];
+        for (const KeyValue<String, int> &E : chunk.terms) {
+            HashMap<int, int> *posting = postings.getptr(E.key);
+            if (posting) {
+                posting->erase(id);
+                if (posting->is_empty()) {
+                    postings.erase(E.key);
+                }
+            }
+        }
+        total_length -= chunk.length;
+        chunks.erase(id);
+    }
+
+    file_paths.erase(entry->id);
+    files.erase(p_path);
+}
+
+void ProjectIndex::_index_file(const String &p_path, uint64_t p_modified_time) {
+    // Tokenized without the lock; only the swap below blocks queries
+    Vector<Chunk> new_chunks;
+    Ref<FileAccess> f = FileAccess::open(p_path, FileAccess::READ);
+    if (f.is_valid() && f->get_length() <= (uint64_t)MAX_FILE_SIZE) {
+        Chunk chunk;
+        int line_number = 0;
+        while (!f->eof_reached()) {
+            _tokenize(f->get_line(), chunk.terms, chunk.length);
+            line_number++;
+            chunk.line_count++;
+            if (chunk.line_count == CHUNK_LINES) {
+                if (chunk.length > 0) {
+                    new_chunks.push_back(chunk);
+                }
+                chunk = Chunk();
+                chunk.line = line_number;
+            }
+            if (stopping.is_set()) {
+                return;
+            }
+        }
+        if (chunk.length > 0) {
+            new_chunks.push_back(chunk);
+        }
+    }
+
+    // Unreadable and oversized files keep an empty entry so they are not retried until they change
+    MutexLock lock(mutex);
+    _remove_file_locked(p_path);
+
+    FileEntry entry;
+    entry.id = next_file_id++;
+    entry.modified_time = p_modified_time;
+    file_paths.insert(entry.id, p_path);
+    for (Chunk &chunk : new_chunks) {
+        _add_chunk_locked(entry.id, chunk, entry);
+    }
+    files.insert(p_path, entry);
+}
+
+void ProjectIndex::_load() {
+    if (loaded) {
+        return;
+    }
+    loaded = true;
+
+    Error err = OK;
+    Vector<uint8_t> data = FileAccess::get_file_as_bytes(_get_index_path(), &err);
+    if (err != OK || data.is_empty()) {
+        return;
+    }
+
+    Ref<StreamPeerBuffer> buffer;
+    buffer.instantiate();
+    buffer->set_data_array(data);
+    if (buffer->get_u32() != INDEX_MAGIC || buffer->get_u32() != INDEX_VERSION) {
+        return;
+    }
+
+    MutexLock lock(mutex);
+    uint32_t file_count = buffer->get_u32();
+    for (uint32_t i = 0; i < file_count && buffer->get_available_bytes() > 0; i++) {
+        String path = buffer->get_utf8_string();
+        FileEntry entry;
+        entry.id = next_file_id++;
+        entry.modified_time = buffer->get_u64();
+        file_paths.insert(entry.id, path);
+
+        uint32_t chunk_count = buffer->get_u32();
+        for (uint32_t j = 0; j < chunk_count && buffer->get_available_bytes() > 0; j++) {
+            Chunk chunk;
+            chunk.line = buffer->get_u32();
+            chunk.line_count = buffer->get_u32();
+            chunk.length = buffer->get_u32();
+            uint32_t term_count = buffer->get_u32();
+            for (uint32_t k = 0; k < term_count && buffer->get_available_bytes() > 0; k++) {
+                String term = buffer->get_utf8_string();
+                chunk.terms[term] = buffer->get_u32();
+            }
+            _add_chunk_locked(entry.id, chunk, entry);
+        }
+        files.insert(path, entry);
+    }
+}
+
+void ProjectIndex::_save() {
+    // Serialized in memory under the lock, written to disk after it is released
+    Ref<StreamPeerBuffer> buffer;
+    buffer.instantiate();
+    {
+        MutexLock lock(mutex);
+        buffer->put_u32(INDEX_MAGIC);
+        buffer->put_u32(INDEX_VERSION);
+        buffer->put_u32(files.size());
+        for (const KeyValue<String, FileEntry> &E : files) {
+            buffer->put_utf8_string(E.key);
+            buffer->put_u64(E.value.modified_time);
+            buffer->put_u32(E.value.chunks.size());
+            for (int id : E.value.chunks) {
+                const Chunk &chunk = chunks[id];
+                buffer->put_u32(chunk.line);
+                buffer->put_u32(chunk.line_count);
+                buffer->put_u32(chunk.length);
+                buffer->put_u32(chunk.terms.size());
+                for (const KeyValue<String, int> &T : chunk.terms) {
+                    buffer->put_utf8_string(T.key);
+                    buffer->put_u32(T.value);
+                }
+            }
+        }
+    }
+
+    Ref<FileAccess> f = FileAccess::open(_get_index_path(), FileAccess::WRITE);
+    if (f.is_valid()) {
+        f->store_buffer(buffer->get_data_array());
+    }
+}
+
+void ProjectIndex::_collect_paths(EditorFileSystemDirectory *p_dir, Vector<String> &r_paths) const {
+    for (int i = 0; i < p_dir->get_file_count(); i++) {
+        String path = p_dir->get_file_path(i);
+        String extension = path.get_extension();
+        if (extension == "gd" || extension == "tscn" || extension == "tres") {
+            r_paths.push_back(path);
+        }
+    }
+    for (int i = 0; i < p_dir->get_subdir_count(); i++) {
+        _collect_paths(p_dir->get_subdir(i), r_paths);
+    }
+}
+
+void ProjectIndex::_on_filesystem_changed() {
+    EditorFileSystem *file_system = EditorFileSystem::get_singleton();
+    if (!started || !file_system || !file_system->get_filesystem()) {
+        return;
+    }
+
+    // The editor's in-memory file tree is cheap to walk; reading and tokenizing happen on the worker
+    Vector<String> paths;
+    _collect_paths(file_system->get_filesystem(), paths);
+
+    bool launch = false;
+    {
+        MutexLock lock(mutex);
+        pending_paths = paths;
+        scan_pending = true;
+        launch = !scan_running;
+        scan_running = true;
+    }
+
+    // A running worker picks the new snapshot up when it finishes its current one
+    if (launch) {
+        WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+        if (task_id != WorkerThreadPool::INVALID_TASK_ID) {
+            pool->wait_for_task_completion(task_id);
+        }
+        task_id = pool->add_template_task(this, &ProjectIndex::_run_scans, nullptr, false, "Vector AI project index");
+    }
+}
+
+void ProjectIndex::_run_scans(void *p_userdata) {
+    _load();
+
+    while (true) {
+        Vector<String> paths;
+        {
+            MutexLock lock(mutex);
+            if (!scan_pending || stopping.is_set()) {
+                scan_running = false;
+                return;
+            }
+            paths = pending_paths;
+            pending_paths.clear();
+            scan_pending = false;
+        }
+
+        bool changed = false;
+        HashSet<String> present;
+        for (const String &path : paths) {
+            if (stopping.is_set()) {
+                break;
+            }
+            present.insert(path);
+
+            uint64_t modified_time = FileAccess::get_modified_time(path);
+            bool up_to_date = false;
+            {
+                MutexLock lock(mutex);
+                const FileEntry *entry = files.getptr(path);
+                up_to_date = entry && entry->modified_time == modified_time;
+            }
+            if (!up_to_date) {
+                _index_file(path, modified_time);
+                changed = true;
+            }
+        }
+
+        if (!stopping.is_set()) {
+            // Files that are no longer in the project
+            MutexLock lock(mutex);
+            Vector<String> removed;
+            for (const KeyValue<String, FileEntry> &E : files) {
+                if (!present.has(E.key)) {
+                    removed.push_back(E.key);
+                }
+            }
+            for (const String &path : removed) {
+                _remove_file_locked(path);
+            }
+            changed = changed || !removed.is_empty();
+        }
+
+        if (changed) {
+            _save();
+        }
+    }
+}
+
+void ProjectIndex::start() {
+    if (started) {
+        return;
+    }
+    started = true;
+
+    EditorFileSystem *file_system = EditorFileSystem::get_singleton();
+    ERR_FAIL_NULL(file_system);
+    file_system->connect("filesystem_changed", callable_mp(this, &ProjectIndex::_on_filesystem_changed));
+
+    // Before the first editor scan finishes, the signal starts the indexing instead
+    if (!file_system->is_scanning()) {
+        _on_filesystem_changed();
+    }
+}
+
+void ProjectIndex::stop() {
+    if (!started) {
+        return;
+    }
+    started = false;
+
+    EditorFileSystem *file_system = EditorFileSystem::get_singleton();
+    if (file_system && file_system->is_connected("filesystem_changed", callable_mp(this, &ProjectIndex::_on_filesystem_changed))) {
+        file_system->disconnect("filesystem_changed", callable_mp(this, &ProjectIndex::_on_filesystem_changed));
+    }
+
+    if (task_id != WorkerThreadPool::INVALID_TASK_ID) {
+        stopping.set();
+        WorkerThreadPool::get_singleton()->wait_for_task_completion(task_id);
+        task_id = WorkerThreadPool::INVALID_TASK_ID;
+        stopping.clear();
+    }
+
+    MutexLock lock(mutex);
+    scan_pending = false;
+    scan_running = false;
+}
+
+bool ProjectIndex::is_started() const {
+    return started;
+}
+
+bool ProjectIndex::is_scanning() {
+    MutexLock lock(mutex);
+    return scan_running;
+}
+
+struct ProjectIndexHitSort {
+    _FORCE_INLINE_ bool operator()(const Pair<int, double> &p_a, const Pair<int, double> &p_b) const {
+        return p_a.second > p_b.second;
+    }
+};
+
+Array ProjectIndex::query(const String &p_text, int p_top_k) {
+    HashMap<String, int> query_terms;
+    int query_length = 0;
+    _tokenize(p_text, query_terms, query_length);
+
+    Array results;
+    {
+        MutexLock lock(mutex);
+        if (chunks.is_empty() || query_terms.is_empty()) {
+            return results;
+        }
+
+        // BM25 over line chunks
+        double chunk_count = chunks.size();
+        double average_length = MAX(1.0, (double)total_length / chunk_count);
+        HashMap<int, double> scores;
+        for (const KeyValue<String, int> &T : query_terms) {
+            const HashMap<int, int> *posting = postings.getptr(T.key);
+            if (!posting) {
+                continue;
+            }
+            double document_frequency = posting->size();
+            double idf = Math::log(1.0 + (chunk_count - document_frequency + 0.5) / (document_frequency + 0.5));
+            for (const KeyValue<int, int> &P : *posting) {
+                double term_frequency = P.value;
+                double norm = BM25_K1 * (1.0 - BM25_B + BM25_B * chunks[P.key].length / average_length);
+                scores[P.key] += idf * term_frequency * (BM25_K1 + 1.0) / (term_frequency + norm);
+            }
+        }
+
+        Vector<Pair<int, double>> hits;
+        for (const KeyValue<int, double> &S : scores) {
+            hits.push_back(Pair<int, double>(S.key, S.value));
+        }
+        hits.sort_custom<ProjectIndexHitSort>();
+
+        // A few chunks per file at most, so one large scene does not crowd out the rest
+        HashMap<int, int> per_file;
+        for (const Pair<int, double> &hit : hits) {
+            const Chunk &chunk = chunks[hit.first];
+            int &file_hits = per_file[chunk.file];
+            if (file_hits >= MAX_CHUNKS_PER_FILE_RESULT) {
+                continue;
+            }
+            file_hits++;
+
+            Dictionary result;
+            result["path"] = file_paths[chunk.file];
+            result["line"] = chunk.line + 1;
+            result["line_count"] = chunk.line_count;
+            result["score"] = hit.second;
+            results.push_back(result);
+            if (results.size() >= p_top_k) {
+                break;
+            }
+        }
+    }
+
+    // Snippets are read back from the files, outside the lock
+    for (int i = 0; i < results.size(); i++) {
+        Dictionary result = results[i];
+        Ref<FileAccess> f = FileAccess::open(result["path"], FileAccess::READ);
+        if (f.is_null()) {
+            continue;
+        }
+
+        int first = (int)result["line"] - 1;
+        int count = result["line_count"];
+        PackedStringArray lines;
+        for (int line = 0; line < first + count && !f->eof_reached(); line++) {
+            String text = f->get_line();
+            if (line >= first) {
+                lines.push_back(text.length() > MAX_SNIPPET_LINE_LENGTH ? text.substr(0, MAX_SNIPPET_LINE_LENGTH) + "..." : text);
+            }
+        }
+        result["text"] = String("\n").join(lines).strip_edges(false, true);
+    }
+
+    return results;
+}
+
+String ProjectIndex::build_context(const String &p_text, int p_token_budget, const Ref<TokenEstimator> &p_estimator) {
+    Array hits = query(p_text);
+
+    String context;
+    int used = 0;
+    for (int i = 0; i < hits.size(); i++) {
+        Dictionary hit = hits[i];
+        if (!hit.has("text")) {
+            continue;
+        }
+
+        int line = hit["line"];
+        String snippet = vformat("--- %s (lines %d-%d)\n", hit["path"], line, line + (int)hit["line_count"] - 1) + String(hit["text"]) + "\n";
+        int tokens = p_estimator.is_valid() ? p_estimator->estimate_tokens(snippet) : snippet.length() / 4;
+
+        // Lower-ranked snippets may still fit after a large one is skipped
+        if (used + tokens > p_token_budget) {
+            continue;
+        }
+        context += snippet;
+        used += tokens;
+    }
+
+    return context;
+}
+
+Dictionary ProjectIndex::get_stats() {
+    MutexLock lock(mutex);
+    Dictionary stats;
+    stats["files"] = files.size();
+    stats["chunks"] = chunks.size();
+    stats["terms"] = postings.size();
+    stats["scanning"] = scan_running;
+    return stats;
+}
+
+ProjectIndex::ProjectIndex() {
+}
+
+ProjectIndex::~ProjectIndex() {
+    stop();
+}
@@ -0,0 +1,117 @@
+/**************************************************************************/
+/*  project_index.h                                                       */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/object/ref_counted.h"
+#include "core/object/worker_thread_pool.h"
+#include "core/os/mutex.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/safe_refcount.h"
+
+class EditorFileSystemDirectory;
+class TokenEstimator;
+
+// BM25 inverted index over the project's scenes, scripts and resources.
+// Files are split into line chunks; scans run on the worker thread pool.
+class ProjectIndex : public RefCounted {
+    GDCLASS(ProjectIndex, RefCounted);
+
+private:
+    struct Chunk {
+        int file = -1;
+        int line = 0;
+        int line_count = 0;
+        int length = 0;
+        HashMap<String, int> terms;
+    };
+
+    struct FileEntry {
+        int id = -1;
+        uint64_t modified_time = 0;
+        Vector<int> chunks;
+    };
+
+    // Everything below is guarded by the mutex; the worker holds it only to swap in a file
+    HashMap<String, FileEntry> files;
+    HashMap<int, String> file_paths;
+    HashMap<int, Chunk> chunks;
+    HashMap<String, HashMap<int, int>> postings;
+    int64_t total_length = 0;
+    int next_file_id = 0;
+    int next_chunk_id = 0;
+    Mutex mutex;
+
+    // Paths of the latest filesystem snapshot, waiting for the worker
+    Vector<String> pending_paths;
+    bool scan_pending = false;
+    bool scan_running = false;
+    bool loaded = false;
+    SafeFlag stopping;
+
+    // Main thread only
+    WorkerThreadPool::TaskID task_id = WorkerThreadPool::INVALID_TASK_ID;
+    bool started = false;
+
+    String _get_index_path() const;
+    void _load();
+    void _save();
+
+    void _collect_paths(EditorFileSystemDirectory *p_dir, Vector<String> &r_paths) const;
+    void _on_filesystem_changed();
+    void _run_scans(void *p_userdata);
+    void _index_file(const String &p_path, uint64_t p_modified_time);
+    void _remove_file_locked(const String &p_path);
+    void _add_chunk_locked(int p_file, Chunk &p_chunk, FileEntry &r_entry);
+
+    static void _tokenize(const String &p_text, HashMap<String, int> &r_terms, int &r_length);
+
+protected:
+    static void _bind_methods();
+
+public:
+    static const int CHUNK_LINES = 40;
+    static const int MAX_FILE_SIZE = 4 * 1024 * 1024;
+    static const int MAX_CHUNKS_PER_FILE_RESULT = 2;
+    static const int MAX_SNIPPET_LINE_LENGTH = 200;
+    static const int DEFAULT_TOP_K = 8;
+
+    void start();
+    void stop();
+    bool is_started() const;
+    bool is_scanning();
+
+    Array query(const String &p_text, int p_top_k = DEFAULT_TOP_K);
+    String build_context(const String &p_text, int p_token_budget, const Ref<TokenEstimator> &p_estimator);
+    Dictionary get_stats();
+
+    ProjectIndex();
+    ~ProjectIndex();
+};
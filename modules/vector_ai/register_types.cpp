@@ -32,9 +32,14 @@
 
 #include "core/config/engine.h"
 #include "editor/editor_node.h"
+#include "gemini_client.h"
 #include "vector_ai.h"
+#include "vector_ai_profiler.h"
+#include "vector_ai_tracer.h"
 
 static VectorAI *vector_ai = nullptr;
+static VectorAIProfiler *vector_ai_profiler = nullptr;
+static VectorAITracer *vector_ai_tracer = nullptr;
 
 void initialize_vector_ai_module(ModuleInitializationLevel p_level) {
     if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
@@ -42,6 +47,8 @@ void initialize_vector_ai_module(ModuleInitializationLevel p_level) {
     }
 
     if (Engine::get_singleton()->is_editor_hint()) {
+        vector_ai_profiler = memnew(VectorAIProfiler);
+        vector_ai_tracer = memnew(VectorAITracer);
         vector_ai = memnew(VectorAI);
         EditorNode::get_singleton()->add_child(vector_ai);
     }
@@ -55,4 +62,14 @@ void uninitialize_vector_ai_module(ModuleInitializationLevel p_level) {
     if (vector_ai) {
         memdelete(vector_ai);
     }
+
+    if (vector_ai_profiler) {
+        memdelete(vector_ai_profiler);
+    }
+
+    if (vector_ai_tracer) {
+        memdelete(vector_ai_tracer);
+    }
+
+    GeminiClient::free_shared_settings();
 }
@@ -30,7 +30,16 @@
 
 #include "scene_analyzer.h"
 
+#include "core/io/file_access.h"
+#include "core/io/json.h"
+#include "core/io/resource_loader.h"
+#include "core/object/script_language.h"
+#include "core/templates/pair.h"
+#include "core/variant/variant_utility.h"
+#include "editor/editor_data.h"
+#include "editor/editor_interface.h"
 #include "editor/editor_node.h"
+#include "editor/plugins/canvas_item_editor_plugin.h"
 #include "scene/2d/sprite_2d.h"
 #include "scene/2d/collision_shape_2d.h"
 #include "scene/2d/camera_2d.h"
@@ -38,10 +47,159 @@
 #include "scene/gui/label.h"
 #include "scene/gui/button.h"
 #include "scene/audio/audio_stream_player.h"
+#include "scene/property_utils.h"
+#include "scene/resources/2d/tile_set.h"
 #include "scene/resources/texture.h"
+#include "tile_grid_codec.h"
+#include "vector_ai_tracer.h"
 
 void SceneAnalyzer::_bind_methods() {
     ClassDB::bind_method(D_METHOD("analyze_current_scene"), &SceneAnalyzer::analyze_current_scene);
+    ClassDB::bind_method(D_METHOD("set_context_scope", "scope"), &SceneAnalyzer::set_context_scope);
+    ClassDB::bind_method(D_METHOD("get_context_scope"), &SceneAnalyzer::get_context_scope);
+    ClassDB::bind_method(D_METHOD("set_float_precision", "precision"), &SceneAnalyzer::set_float_precision);
+    ClassDB::bind_method(D_METHOD("get_float_precision"), &SceneAnalyzer::get_float_precision);
+    ClassDB::bind_static_method("SceneAnalyzer", D_METHOD("format_value", "value", "precision"), &SceneAnalyzer::format_value);
+    ClassDB::bind_method(D_METHOD("analyze_scene", "root"), &SceneAnalyzer::analyze_scene);
+    ClassDB::bind_method(D_METHOD("analyze_scene_file", "path"), &SceneAnalyzer::analyze_scene_file);
+    ClassDB::bind_method(D_METHOD("analyze_shallow_outline"), &SceneAnalyzer::analyze_shallow_outline);
+    ClassDB::bind_static_method("SceneAnalyzer", D_METHOD("get_tool_declarations"), &SceneAnalyzer::get_tool_declarations);
+    ClassDB::bind_method(D_METHOD("call_tool", "name", "args"), &SceneAnalyzer::call_tool);
+    ClassDB::bind_method(D_METHOD("clear_tool_cache"), &SceneAnalyzer::clear_tool_cache);
+    ClassDB::bind_method(D_METHOD("get_spatial_index"), &SceneAnalyzer::get_spatial_index);
+    ClassDB::bind_method(D_METHOD("query_nodes_in_rect", "rect"), &SceneAnalyzer::query_nodes_in_rect);
+    ClassDB::bind_method(D_METHOD("query_nodes_in_radius", "center", "radius"), &SceneAnalyzer::query_nodes_in_radius);
+    ClassDB::bind_method(D_METHOD("query_nearest_nodes", "point", "count"), &SceneAnalyzer::query_nearest_nodes);
+
+    BIND_ENUM_CONSTANT(SCOPE_SCENE);
+    BIND_ENUM_CONSTANT(SCOPE_SELECTION);
+    BIND_ENUM_CONSTANT(SCOPE_VIEWPORT);
+}
+
+String SceneAnalyzer::get_scope_name(ContextScope p_scope) {
+    switch (p_scope) {
+        case SCOPE_SELECTION:
+            return "selection";
+        case SCOPE_VIEWPORT:
+            return "viewport";
+        default:
+            return "scene";
+    }
+}
+
+void SceneAnalyzer::set_context_scope(ContextScope p_scope) {
+    context_scope = p_scope;
+}
+
+SceneAnalyzer::ContextScope SceneAnalyzer::get_context_scope() const {
+    return context_scope;
+}
+
+void SceneAnalyzer::set_float_precision(int p_precision) {
+    float_precision = CLAMP(p_precision, -1, 8);
+}
+
+int SceneAnalyzer::get_float_precision() const {
+    return float_precision;
+}
+
+String SceneAnalyzer::format_value(const Variant &p_value, int p_precision) {
+    // Integer grids (level layouts) print run-length encoded, at any precision
+    if (TileGridCodec::is_int_grid(p_value)) {
+        return TileGridCodec::encode_grid(p_value);
+    }
+
+    if (p_precision < 0) {
+        return String(p_value);
+    }
+
+    // Same layout as Variant's own text form, with rounded components
+    auto num = [p_precision](real_t p_number) -> String {
+        String text = String::num(p_number, p_precision);
+        return text == "-0" ? String("0") : text;
+    };
+
+    switch (p_value.get_type()) {
+        case Variant::FLOAT: {
+            return num(p_value);
+        }
+        case Variant::VECTOR2: {
+            Vector2 v = p_value;
+            return "(" + num(v.x) + ", " + num(v.y) + ")";
+        }
+        case Variant::VECTOR3: {
+            Vector3 v = p_value;
+            return "(" + num(v.x) + ", " + num(v.y) + ", " + num(v.z) + ")";
+        }
+        case Variant::VECTOR4: {
+            Vector4 v = p_value;
+            return "(" + num(v.x) + ", " + num(v.y) + ", " + num(v.z) + ", " + num(v.w) + ")";
+        }
+        case Variant::COLOR: {
+            Color c = p_value;
+            return "(" + num(c.r) + ", " + num(c.g) + ", " + num(c.b) + ", " + num(c.a) + ")";
+        }
+        case Variant::RECT2: {
+            Rect2 r = p_value;
+            return "[P: (" + num(r.position.x) + ", " + num(r.position.y) + "), S: (" + num(r.size.x) + ", " + num(r.size.y) + ")]";
+        }
+        case Variant::ARRAY:
+        case Variant::PACKED_FLOAT32_ARRAY:
+        case Variant::PACKED_FLOAT64_ARRAY:
+        case Variant::PACKED_VECTOR2_ARRAY:
+        case Variant::PACKED_VECTOR3_ARRAY: {
+            Array elements = p_value;
+            PackedStringArray parts;
+            for (int i = 0; i < elements.size(); i++) {
+                parts.push_back(format_value(elements[i], p_precision));
+            }
+            return "[" + String(", ").join(parts) + "]";
+        }
+        default: {
+            return String(p_value);
+        }
+    }
+}
+
+bool SceneAnalyzer::_is_class_default(const StringName &p_class, const String &p_key, const Variant &p_value) const {
+    // Output keys that are named differently from the property they show
+    StringName property = p_key;
+    if (p_key == "h_size_flags") {
+        property = "size_flags_horizontal";
+    } else if (p_key == "v_size_flags") {
+        property = "size_flags_vertical";
+    }
+
+    DefaultValue default_value;
+    {
+        MutexLock lock(default_cache_mutex);
+        HashMap<StringName, DefaultValue> &class_defaults = default_cache[p_class];
+        const DefaultValue *cached = class_defaults.getptr(property);
+        if (cached) {
+            default_value = *cached;
+        } else {
+            default_value.value = ClassDB::class_get_default_property_value(p_class, property, &default_value.valid);
+            class_defaults.insert(property, default_value);
+        }
+    }
+
+    // Compared after rounding, so float noise does not count as a change
+    return default_value.valid && p_value.get_type() == default_value.value.get_type() && format_value(p_value, float_precision) == format_value(default_value.value, float_precision);
+}
+
+String SceneAnalyzer::_format_properties(const StringName &p_class, const Dictionary &p_properties, const String &p_indent) const {
+    String lines;
+    for (const KeyValue<Variant, Variant> &E : p_properties) {
+        if (_is_class_default(p_class, E.key, E.value)) {
+            continue;
+        }
+        lines += p_indent + "    " + String(E.key) + ": " + format_value(E.value, float_precision) + "\n";
+    }
+
+    if (lines.is_empty()) {
+        return "";
+    }
+    return p_indent + "  Properties:\n" + lines;
 }
 
 String SceneAnalyzer::analyze_current_scene() {
@@ -55,43 +213,1099 @@ String SceneAnalyzer::analyze_current_scene() {
     // Analyze the scene
     String scene_info = "Scene Name: " + current_scene->get_name() + "\n";
     scene_info += "Scene Path: " + current_scene->get_scene_file_path() + "\n\n";
-    scene_info += "Node Structure:\n";
+
+    // Narrow the context down to what the user is working on
+    ContextFilter filter;
+    bool scoped = false;
+    if (context_scope == SCOPE_SELECTION) {
+        scoped = _build_selection_filter(current_scene, filter);
+    } else if (context_scope == SCOPE_VIEWPORT) {
+        scoped = _build_viewport_filter(current_scene, filter);
+    }
+
+    if (scoped) {
+        scene_info += "Context Scope: " + get_scope_name(context_scope) + " (nodes outside the scope are only summarized)\n";
+    }
+
+    scene_info += "Node Structure (properties at their class default are omitted):\n";
     
     // Recursively analyze the scene
-    scene_info += _analyze_node(current_scene, 0);
+    InstanceTable instances;
+    instances.root = current_scene;
+    scene_info += _analyze_node(current_scene, 0, scoped ? &filter : nullptr, &instances);
+
+    if (scoped) {
+        scene_info += _summarize_omitted(current_scene, filter);
+    }
+
+    scene_info += _summarize_instances(instances);
+    scene_info += _summarize_scripts(instances);
     
     return scene_info;
 }
 
-String SceneAnalyzer::_analyze_node(Node *p_node, int p_indent_level) {
+String SceneAnalyzer::analyze_scene(Node *p_root) {
+    ERR_FAIL_NULL_V(p_root, "");
+
+    // Whole-scene analysis of a root outside the editor; safe on worker threads
+    String scene_info = "Scene Name: " + p_root->get_name() + "\n";
+    scene_info += "Scene Path: " + p_root->get_scene_file_path() + "\n\n";
+    scene_info += "Node Structure (properties at their class default are omitted):\n";
+
+    InstanceTable instances;
+    instances.root = p_root;
+    scene_info += _analyze_node(p_root, 0, nullptr, &instances);
+    scene_info += _summarize_instances(instances);
+    scene_info += _summarize_scripts(instances);
+
+    return scene_info;
+}
+
+String SceneAnalyzer::analyze_scene_file(const String &p_path) {
+    if (!FileAccess::exists(p_path)) {
+        return "Scene file not found: " + p_path;
+    }
+
+    // Huge text scenes are streamed instead of loading every sub-resource
+    if (p_path.get_extension() == "tscn") {
+        Ref<FileAccess> f = FileAccess::open(p_path, FileAccess::READ);
+        if (f.is_valid() && (int64_t)f->get_length() > STREAMING_THRESHOLD) {
+            return _analyze_text_scene(p_path);
+        }
+    }
+
+    Ref<PackedScene> packed_scene = ResourceLoader::load(p_path, "PackedScene");
+    if (packed_scene.is_null()) {
+        return "Could not load scene: " + p_path;
+    }
+
+    Ref<SceneState> state = packed_scene->get_state();
+    if (state.is_null() || state->get_node_count() == 0) {
+        return "Scene is empty: " + p_path;
+    }
+
+    String scene_info = "Scene Name: " + String(state->get_node_name(0)) + "\n";
+    scene_info += "Scene Path: " + p_path + "\n\n";
+    scene_info += "Node Structure (properties at their class default are omitted):\n";
+
+    InstanceTable instances;
+    _analyze_state(state, 0, 0, scene_info, &instances);
+    scene_info += _summarize_instances(instances);
+    scene_info += _summarize_scripts(instances);
+
+    return scene_info;
+}
+
+StringName SceneAnalyzer::_get_state_node_type(const Ref<SceneState> &p_state, int p_index) {
+    StringName type = p_state->get_node_type(p_index);
+    if (type != StringName()) {
+        return type;
+    }
+
+    // Instanced and inherited nodes take their type from the scene they come from
+    Ref<PackedScene> instance = p_state->get_node_instance(p_index);
+    if (instance.is_valid() && instance->get_state().is_valid() && instance->get_state()->get_node_count() > 0) {
+        return _get_state_node_type(instance->get_state(), 0);
+    }
+
+    if (p_index == 0 && p_state->get_base_scene_state().is_valid() && p_state->get_base_scene_state()->get_node_count() > 0) {
+        return _get_state_node_type(p_state->get_base_scene_state(), 0);
+    }
+
+    return "Node";
+}
+
+Variant SceneAnalyzer::_get_state_value(const Ref<SceneState> &p_state, int p_index, const StringName &p_type, const StringName &p_property) {
+    for (int i = 0; i < p_state->get_node_property_count(p_index); i++) {
+        if (p_state->get_node_property_name(p_index, i) == p_property) {
+            return p_state->get_node_property_value(p_index, i);
+        }
+    }
+
+    // Not overridden here: the instanced scene's root, then the class default
+    Ref<PackedScene> instance = p_state->get_node_instance(p_index);
+    if (instance.is_valid() && instance->get_state().is_valid() && instance->get_state()->get_node_count() > 0) {
+        return _get_state_value(instance->get_state(), 0, p_type, p_property);
+    }
+
+    bool valid = false;
+    Variant value = ClassDB::class_get_default_property_value(p_type, p_property, &valid);
+    return valid ? value : Variant();
+}
+
+Dictionary SceneAnalyzer::_get_state_properties(const Ref<SceneState> &p_state, int p_index, const StringName &p_type) const {
+    // Mirrors _get_node_properties() so both paths describe nodes the same way
+    Dictionary properties;
+    String class_name = p_type;
+
+    Variant visible = _get_state_value(p_state, p_index, p_type, "visible");
+    properties["visible"] = visible.get_type() == Variant::NIL ? Variant(true) : visible;
+
+    if (class_name == "Sprite2D") {
+        properties["position"] = _get_state_value(p_state, p_index, p_type, "position");
+        properties["scale"] = _get_state_value(p_state, p_index, p_type, "scale");
+        properties["rotation"] = _get_state_value(p_state, p_index, p_type, "rotation");
+        properties["modulate"] = _get_state_value(p_state, p_index, p_type, "modulate");
+
+        Ref<Resource> texture = _get_state_value(p_state, p_index, p_type, "texture");
+        if (texture.is_valid()) {
+            properties["texture"] = texture->get_path();
+        }
+    } else if (class_name == "Label") {
+        properties["text"] = _get_state_value(p_state, p_index, p_type, "text");
+        Variant font_size = _get_state_value(p_state, p_index, p_type, "theme_override_font_sizes/font_size");
+        if (font_size.get_type() != Variant::NIL) {
+            properties["font_size"] = font_size;
+        }
+        properties["horizontal_alignment"] = _get_state_value(p_state, p_index, p_type, "horizontal_alignment");
+        properties["vertical_alignment"] = _get_state_value(p_state, p_index, p_type, "vertical_alignment");
+        properties["autowrap_mode"] = _get_state_value(p_state, p_index, p_type, "autowrap_mode");
+    } else if (class_name == "Button") {
+        properties["text"] = _get_state_value(p_state, p_index, p_type, "text");
+        properties["disabled"] = _get_state_value(p_state, p_index, p_type, "disabled");
+        properties["toggle_mode"] = _get_state_value(p_state, p_index, p_type, "toggle_mode");
+        properties["button_pressed"] = _get_state_value(p_state, p_index, p_type, "button_pressed");
+    } else if (class_name == "CollisionShape2D") {
+        properties["position"] = _get_state_value(p_state, p_index, p_type, "position");
+        properties["rotation"] = _get_state_value(p_state, p_index, p_type, "rotation");
+        properties["disabled"] = _get_state_value(p_state, p_index, p_type, "disabled");
+
+        Ref<Resource> shape = _get_state_value(p_state, p_index, p_type, "shape");
+        if (shape.is_valid()) {
+            properties["shape_type"] = shape->get_class();
+        }
+    } else if (class_name == "Camera2D") {
+        properties["position"] = _get_state_value(p_state, p_index, p_type, "position");
+        properties["zoom"] = _get_state_value(p_state, p_index, p_type, "zoom");
+        properties["current"] = _get_state_value(p_state, p_index, p_type, "enabled");
+        properties["offset"] = _get_state_value(p_state, p_index, p_type, "offset");
+    } else if (class_name == "AnimatedSprite2D") {
+        properties["position"] = _get_state_value(p_state, p_index, p_type, "position");
+        properties["scale"] = _get_state_value(p_state, p_index, p_type, "scale");
+        properties["rotation"] = _get_state_value(p_state, p_index, p_type, "rotation");
+        properties["modulate"] = _get_state_value(p_state, p_index, p_type, "modulate");
+        properties["animation"] = _get_state_value(p_state, p_index, p_type, "animation");
+        properties["playing"] = false;
+        properties["speed_scale"] = _get_state_value(p_state, p_index, p_type, "speed_scale");
+    } else if (class_name == "AudioStreamPlayer") {
+        properties["volume_db"] = _get_state_value(p_state, p_index, p_type, "volume_db");
+        properties["pitch_scale"] = _get_state_value(p_state, p_index, p_type, "pitch_scale");
+        properties["playing"] = _get_state_value(p_state, p_index, p_type, "playing");
+        properties["autoplay"] = _get_state_value(p_state, p_index, p_type, "autoplay");
+
+        Ref<Resource> stream = _get_state_value(p_state, p_index, p_type, "stream");
+        if (stream.is_valid()) {
+            properties["stream"] = stream->get_path();
+        }
+    }
+
+    if (ClassDB::is_parent_class(p_type, "Node2D")) {
+        properties["position"] = _get_state_value(p_state, p_index, p_type, "position");
+        properties["rotation"] = _get_state_value(p_state, p_index, p_type, "rotation");
+        properties["scale"] = _get_state_value(p_state, p_index, p_type, "scale");
+    }
+
+    if (ClassDB::is_parent_class(p_type, "Control")) {
+        properties["position"] = _get_state_value(p_state, p_index, p_type, "position");
+        properties["size"] = _get_state_value(p_state, p_index, p_type, "size");
+        properties["anchors_preset"] = _get_state_value(p_state, p_index, p_type, "anchors_preset");
+        properties["h_size_flags"] = _get_state_value(p_state, p_index, p_type, "size_flags_horizontal");
+        properties["v_size_flags"] = _get_state_value(p_state, p_index, p_type, "size_flags_vertical");
+    }
+
+    return properties;
+}
+
+PackedStringArray SceneAnalyzer::_get_state_overrides(const Ref<SceneState> &p_state, int p_index) const {
+    // An instancing node only stores the properties it changes, so all of them are overrides
+    PackedStringArray overrides;
+    int total = p_state->get_node_property_count(p_index);
+
+    for (int i = 0; i < total && overrides.size() < MAX_INSTANCE_OVERRIDES; i++) {
+        Variant value = p_state->get_node_property_value(p_index, i);
+        Ref<Resource> resource = value;
+        String text = resource.is_valid() && !resource->get_path().is_empty() ? resource->get_path() : format_value(value, float_precision);
+        overrides.push_back(String(p_state->get_node_property_name(p_index, i)) + "=" + text);
+    }
+
+    if (total > overrides.size()) {
+        overrides.push_back(vformat("... %d more", total - overrides.size()));
+    }
+
+    return overrides;
+}
+
+void SceneAnalyzer::_analyze_state(const Ref<SceneState> &p_state, int p_indent_level, int p_nesting, String &r_info, InstanceTable *p_instances) const {
+    // Nodes are stored parents first, so the path depth gives the indentation.
+    // An instanced scene passes its own root's line to the instancing node.
+    int first_node = p_nesting > 0 ? 1 : 0;
+    Vector<NodePath> editable_instances = p_state->get_editable_instances();
+
+    for (int i = first_node; i < p_state->get_node_count(); i++) {
+        NodePath path = p_state->get_node_path(i);
+        int depth = path == NodePath(".") ? 0 : path.get_name_count();
+        if (p_nesting > 0) {
+            depth -= 1;
+        }
+
+        StringName type = _get_state_node_type(p_state, i);
+        String indent = String("  ").repeat(p_indent_level + depth);
+        Ref<PackedScene> instance = p_state->get_node_instance(i);
+
+        // Same as _analyze_node: instances are described once and only list what differs here
+        bool instanced = p_instances && i > 0 && instance.is_valid() && !instance->get_path().is_empty() && !editable_instances.has(path);
+        if (instanced) {
+            String scene_path = instance->get_path();
+            p_instances->counts[scene_path]++;
+
+            r_info += indent + "- " + String(p_state->get_node_name(i)) + " (" + String(type) + ") [instance of " + scene_path + "]\n";
+            PackedStringArray overrides = _get_state_overrides(p_state, i);
+            if (!overrides.is_empty()) {
+                r_info += indent + "  Overrides: " + String(", ").join(overrides) + "\n";
+            }
+            continue;
+        }
+
+        r_info += indent + "- " + String(p_state->get_node_name(i)) + " (" + String(type) + ")\n";
+
+        r_info += _format_properties(type, _get_state_properties(p_state, i, type), indent);
+
+        Ref<Script> script = _get_state_value(p_state, i, type, "script");
+        if (script.is_valid()) {
+            String script_path = script->get_path();
+            r_info += indent + "  Script: " + (script_path.is_resource_file() ? script_path : String("(built-in)")) + "\n";
+            if (p_instances && script_path.is_resource_file()) {
+                p_instances->scripts.insert(script_path);
+            }
+        }
+
+        // Tile data is decoded straight from the stored bytes
+        if (ClassDB::is_parent_class(type, "TileMapLayer")) {
+            r_info += TileGridCodec::describe_tile_data(_get_state_value(p_state, i, type, "tile_set"), _get_state_value(p_state, i, type, "tile_map_data"), indent);
+        }
+
+        // Children that come from an inherited or editable instance live in that scene's state
+        if (instance.is_valid() && instance->get_state().is_valid() && p_nesting < MAX_INSTANCE_NESTING) {
+            _analyze_state(instance->get_state(), p_indent_level + depth + 1, p_nesting + 1, r_info, p_instances);
+        }
+    }
+}
+
+String SceneAnalyzer::_analyze_text_scene(const String &p_path) const {
+    // Line-by-line pass over [node] sections with only overridden properties;
+    // nothing beyond the current node is kept in memory
+    Ref<FileAccess> f = FileAccess::open(p_path, FileAccess::READ);
+    if (f.is_null()) {
+        return "Could not open scene: " + p_path;
+    }
+
+    static const char *listed_properties[] = {
+        "visible", "position", "rotation", "scale", "modulate", "texture", "text", "size",
+        "disabled", "toggle_mode", "button_pressed", "zoom", "offset", "animation",
+        "speed_scale", "volume_db", "pitch_scale", "autoplay", "stream", "shape", nullptr
+    };
+
+    HashMap<String, String> ext_resources;
+    HashMap<String, String> instance_types;
+    InstanceTable instances;
+    String scene_info;
+    String root_name;
+    String node_line;
+    String node_script;
+    Vector<Pair<String, String>> node_properties;
+    String node_indent;
+    bool node_instanced = false;
+    int node_overrides = 0;
+
+    auto flush_node = [&]() {
+        if (node_line.is_empty()) {
+            return;
+        }
+        scene_info += node_line;
+
+        // Same layout as _analyze_node: instances list what they override, other nodes their properties
+        if (node_instanced) {
+            PackedStringArray overrides;
+            for (const Pair<String, String> &property : node_properties) {
+                overrides.push_back(property.first + "=" + property.second);
+            }
+            if (node_overrides > overrides.size()) {
+                overrides.push_back(vformat("... %d more", node_overrides - overrides.size()));
+            }
+            if (!overrides.is_empty()) {
+                scene_info += node_indent + "  Overrides: " + String(", ").join(overrides) + "\n";
+            }
+        } else {
+            if (!node_properties.is_empty()) {
+                scene_info += node_indent + "  Properties:\n";
+                for (const Pair<String, String> &property : node_properties) {
+                    scene_info += node_indent + "    " + property.first + ": " + property.second + "\n";
+                }
+            }
+            if (!node_script.is_empty()) {
+                scene_info += node_indent + "  Script: " + node_script + "\n";
+            }
+        }
+
+        node_line = String();
+        node_script = String();
+        node_properties.clear();
+        node_instanced = false;
+        node_overrides = 0;
+    };
+
+    auto get_attribute = [](const String &p_header, const String &p_name) -> String {
+        int start = p_header.find(" " + p_name + "=");
+        if (start == -1) {
+            return String();
+        }
+        start += p_name.length() + 2;
+        if (start >= p_header.length()) {
+            return String();
+        }
+        if (p_header[start] == '"') {
+            int end = p_header.find("\"", start + 1);
+            return p_header.substr(start + 1, end - start - 1);
+        }
+        int end = p_header.find(" ", start);
+        if (end == -1) {
+            end = p_header.find("]", start);
+        }
+        return p_header.substr(start, end - start);
+    };
+
+    // ExtResource("id") as its path, like the live analyzer prints saved resources
+    auto get_ext_path = [&](const String &p_value) -> String {
+        if (!p_value.begins_with("ExtResource(")) {
+            return String();
+        }
+        String id = p_value.get_slicec('"', 1);
+        return ext_resources.has(id) ? ext_resources[id] : String();
+    };
+
+    auto format_raw = [&](const String &p_value) -> String {
+        String ext_path = get_ext_path(p_value);
+        if (!ext_path.is_empty()) {
+            return ext_path;
+        }
+        // Built-in resources stay as written
+        if (p_value.contains("Resource(")) {
+            return p_value;
+        }
+        return format_value(VariantUtilityFunctions::str_to_var(p_value), float_precision);
+    };
+
+    bool in_node = false;
+    bool in_value = false;
+
+    while (!f->eof_reached()) {
+        String line = f->get_line();
+
+        if (line.begins_with("[")) {
+            flush_node();
+            in_node = line.begins_with("[node ");
+            in_value = false;
+
+            if (line.begins_with("[ext_resource ")) {
+                ext_resources[get_attribute(line, "id")] = get_attribute(line, "path");
+            } else if (in_node) {
+                String name = get_attribute(line, "name");
+                String type = get_attribute(line, "type");
+                String parent = get_attribute(line, "parent");
+                String scene_path = get_ext_path(get_attribute(line, "instance"));
+
+                // The type of an instance is its scene's root type
+                if (type.is_empty() && !scene_path.is_empty()) {
+                    if (!instance_types.has(scene_path)) {
+                        Ref<PackedScene> packed_scene = ResourceLoader::load(scene_path, "PackedScene");
+                        bool valid = packed_scene.is_valid() && packed_scene->get_state().is_valid() && packed_scene->get_state()->get_node_count() > 0;
+                        instance_types[scene_path] = valid ? String(_get_state_node_type(packed_scene->get_state(), 0)) : String("Node");
+                    }
+                    type = instance_types[scene_path];
+                }
+                if (type.is_empty()) {
+                    type = "Node";
+                }
+
+                int depth = 0;
+                if (parent.is_empty()) {
+                    root_name = name;
+                } else {
+                    depth = parent == "." ? 1 : parent.get_slice_count("/") + 1;
+                }
+
+                // An inherited scene's root is expanded, like _analyze_node does
+                node_instanced = !parent.is_empty() && !scene_path.is_empty();
+                node_indent = String("  ").repeat(depth);
+                node_line = node_indent + "- " + name + " (" + type + ")";
+                if (node_instanced) {
+                    instances.counts[scene_path]++;
+                    node_line += " [instance of " + scene_path + "]";
+                }
+                node_line += "\n";
+            }
+            continue;
+        }
+
+        if (!in_node) {
+            continue;
+        }
+
+        int separator = line.find(" = ");
+        if (separator <= 0 || line.begins_with(" ") || line.begins_with("\t")) {
+            // Continuation of a multi-line value: the value is dropped rather than spliced
+            if (in_value && !node_properties.is_empty()) {
+                node_properties.resize(node_properties.size() - 1);
+            }
+            in_value = false;
+            continue;
+        }
+        in_value = false;
+
+        String key = line.substr(0, separator);
+        String raw_value = line.substr(separator + 3);
+
+        if (key == "script") {
+            String script_path = get_ext_path(raw_value);
+            if (!node_instanced) {
+                node_script = script_path.is_resource_file() ? script_path : String("(built-in)");
+                if (script_path.is_resource_file()) {
+                    instances.scripts.insert(script_path);
+                }
+                continue;
+            }
+        }
+
+        bool listed = node_instanced;
+        for (int i = 0; !listed && listed_properties[i]; i++) {
+            listed = key == listed_properties[i];
+        }
+        if (!listed) {
+            continue;
+        }
+
+        if (node_instanced) {
+            node_overrides++;
+            if (node_properties.size() >= MAX_INSTANCE_OVERRIDES) {
+                continue;
+            }
+        }
+        node_properties.push_back(Pair<String, String>(key, format_raw(raw_value)));
+        in_value = true;
+    }
+    flush_node();
+
+    String header = "Scene Name: " + root_name + "\n";
+    header += "Scene Path: " + p_path + "\n\n";
+    header += "Node Structure (properties at their class default are omitted):\n";
+
+    return header + scene_info + _summarize_instances(instances) + _summarize_scripts(instances);
+}
+
+String SceneAnalyzer::analyze_shallow_outline() {
+    Node *current_scene = EditorNode::get_singleton()->get_edited_scene();
+
+    if (!current_scene) {
+        return "No scene is currently open in the editor.";
+    }
+
+    // A new outline starts a new request; earlier tool answers may be stale
+    clear_tool_cache();
+
+    String scene_info = "Scene Name: " + current_scene->get_name() + "\n";
+    scene_info += "Scene Path: " + current_scene->get_scene_file_path() + "\n\n";
+    scene_info += vformat("Node Structure (first %d levels; use the scene tools for children and properties):\n", OUTLINE_DEPTH + 1);
+    scene_info += _outline_node(current_scene, 0);
+
+    return scene_info;
+}
+
+String SceneAnalyzer::_outline_node(Node *p_node, int p_indent_level) const {
+    String indent = String("  ").repeat(p_indent_level);
+    String node_info = indent + "- " + p_node->get_name() + " (" + p_node->get_class() + ")";
+
+    int child_count = p_node->get_child_count();
+    if (p_indent_level >= OUTLINE_DEPTH) {
+        if (child_count > 0) {
+            node_info += vformat(" [%d children]", child_count);
+        }
+        return node_info + "\n";
+    }
+
+    node_info += "\n";
+    for (int i = 0; i < child_count; i++) {
+        node_info += _outline_node(p_node->get_child(i), p_indent_level + 1);
+    }
+
+    return node_info;
+}
+
+Array SceneAnalyzer::get_tool_declarations() {
+    Array declarations;
+
+    Dictionary path_property;
+    path_property["type"] = "STRING";
+    path_property["description"] = "Node path relative to the scene root, or \".\" for the root itself.";
+
+    Dictionary path_properties;
+    path_properties["path"] = path_property;
+
+    Array path_required;
+    path_required.push_back("path");
+
+    Dictionary path_parameters;
+    path_parameters["type"] = "OBJECT";
+    path_parameters["properties"] = path_properties;
+    path_parameters["required"] = path_required;
+
+    Dictionary list_children;
+    list_children["name"] = "list_children";
+    list_children["description"] = "Lists the direct children of a node with their class and child count.";
+    list_children["parameters"] = path_parameters;
+    declarations.push_back(list_children);
+
+    Dictionary get_node_properties;
+    get_node_properties["name"] = "get_node_properties";
+    get_node_properties["description"] = "Returns the class and the relevant editable properties of a node.";
+    get_node_properties["parameters"] = path_parameters;
+    declarations.push_back(get_node_properties);
+
+    Dictionary class_property;
+    class_property["type"] = "STRING";
+    class_property["description"] = "Class name; nodes inheriting from it also match.";
+
+    Dictionary class_properties;
+    class_properties["class_name"] = class_property;
+
+    Array class_required;
+    class_required.push_back("class_name");
+
+    Dictionary class_parameters;
+    class_parameters["type"] = "OBJECT";
+    class_parameters["properties"] = class_properties;
+    class_parameters["required"] = class_required;
+
+    Dictionary find_nodes_by_class;
+    find_nodes_by_class["name"] = "find_nodes_by_class";
+    find_nodes_by_class["description"] = vformat("Finds nodes of a class anywhere in the scene (at most %d).", FIND_NODES_LIMIT);
+    find_nodes_by_class["parameters"] = class_parameters;
+    declarations.push_back(find_nodes_by_class);
+
+    Dictionary get_script_summary;
+    get_script_summary["name"] = "get_script_summary";
+    get_script_summary["description"] = "Summarizes the script attached to a node: its base class, exported variables, signals, functions and constants.";
+    get_script_summary["parameters"] = path_parameters;
+    declarations.push_back(get_script_summary);
+
+    Dictionary file_property;
+    file_property["type"] = "STRING";
+    file_property["description"] = "Scene file path, e.g. res://enemies/enemy.tscn.";
+
+    Dictionary file_properties;
+    file_properties["scene_path"] = file_property;
+
+    Array file_required;
+    file_required.push_back("scene_path");
+
+    Dictionary file_parameters;
+    file_parameters["type"] = "OBJECT";
+    file_parameters["properties"] = file_properties;
+    file_parameters["required"] = file_required;
+
+    Dictionary analyze_scene_file;
+    analyze_scene_file["name"] = "analyze_scene_file";
+    analyze_scene_file["description"] = "Describes another scene file (for example one instanced in this scene) without opening it.";
+    analyze_scene_file["parameters"] = file_parameters;
+    declarations.push_back(analyze_scene_file);
+
+    return declarations;
+}
+
+void SceneAnalyzer::clear_tool_cache() {
+    tool_cache.clear();
+    tool_cache_root = ObjectID();
+}
+
+Dictionary SceneAnalyzer::call_tool(const String &p_name, const Dictionary &p_args) {
+    Dictionary result;
+
+    Node *current_scene = EditorNode::get_singleton()->get_edited_scene();
+    if (!current_scene) {
+        result["error"] = "No scene is currently open in the editor.";
+        return result;
+    }
+
+    // Answers are snapshots of the scene as it was when first asked
+    if (tool_cache_root != current_scene->get_instance_id()) {
+        tool_cache.clear();
+        tool_cache_root = current_scene->get_instance_id();
+    }
+
+    String key = p_name + ":" + JSON::stringify(p_args, "", true);
+    const Dictionary *cached = tool_cache.getptr(key);
+    if (cached) {
+        return *cached;
+    }
+
+    VectorAITracer *tracer = VectorAITracer::get_singleton();
+    String span_name = "tool " + p_name;
+    if (tracer) {
+        tracer->begin_span_named(span_name);
+    }
+
+    if (p_name == "list_children") {
+        result = _tool_list_children(current_scene, p_args);
+    } else if (p_name == "get_node_properties") {
+        result = _tool_get_node_properties(current_scene, p_args);
+    } else if (p_name == "find_nodes_by_class") {
+        result = _tool_find_nodes_by_class(current_scene, p_args);
+    } else if (p_name == "get_script_summary") {
+        result = _tool_get_script_summary(current_scene, p_args);
+    } else if (p_name == "analyze_scene_file") {
+        String scene_path = p_args.get("scene_path", "");
+        if (!scene_path.begins_with("res://")) {
+            scene_path = "res://" + scene_path;
+        }
+        result["scene_path"] = scene_path;
+        result["scene_info"] = analyze_scene_file(scene_path);
+    } else {
+        result["error"] = "Unknown tool: " + p_name;
+    }
+
+    if (tracer) {
+        tracer->end_span_named(span_name);
+    }
+
+    tool_cache.insert(key, result);
+    return result;
+}
+
+Node *SceneAnalyzer::_resolve_tool_node(Node *p_root, const Dictionary &p_args, Dictionary &r_error) const {
+    String path = p_args.get("path", ".");
+    if (path.is_empty() || path == "." || path == String(p_root->get_name())) {
+        return p_root;
+    }
+
+    // The outline lists the root by name, so accept paths that start with it
+    String root_prefix = String(p_root->get_name()) + "/";
+    if (path.begins_with(root_prefix)) {
+        path = path.substr(root_prefix.length());
+    }
+
+    Node *node = p_root->get_node_or_null(NodePath(path));
+    if (!node) {
+        r_error["error"] = "Node not found: " + path;
+    }
+    return node;
+}
+
+Dictionary SceneAnalyzer::_tool_list_children(Node *p_root, const Dictionary &p_args) const {
+    Dictionary result;
+    Node *node = _resolve_tool_node(p_root, p_args, result);
+    if (!node) {
+        return result;
+    }
+
+    Array children;
+    for (int i = 0; i < node->get_child_count(); i++) {
+        Node *child = node->get_child(i);
+
+        Dictionary entry;
+        entry["name"] = child->get_name();
+        entry["class"] = child->get_class();
+        entry["child_count"] = child->get_child_count();
+        if (!child->get_scene_file_path().is_empty()) {
+            entry["instance_of"] = child->get_scene_file_path();
+        }
+        children.push_back(entry);
+    }
+
+    result["path"] = String(p_root->get_path_to(node));
+    result["children"] = children;
+    return result;
+}
+
+Dictionary SceneAnalyzer::_tool_get_node_properties(Node *p_root, const Dictionary &p_args) {
+    Dictionary result;
+    Node *node = _resolve_tool_node(p_root, p_args, result);
+    if (!node) {
+        return result;
+    }
+
+    // Same text form as the outline so values read back consistently
+    Dictionary properties = _get_node_properties(node);
+    Dictionary formatted;
+    for (const KeyValue<Variant, Variant> &E : properties) {
+        if (!_is_class_default(node->get_class_name(), E.key, E.value)) {
+            formatted[E.key] = format_value(E.value, float_precision);
+        }
+    }
+
+    result["path"] = String(p_root->get_path_to(node));
+    result["class"] = node->get_class();
+    result["properties"] = formatted;
+
+    String tiles = TileGridCodec::describe_tiles(node, "");
+    if (!tiles.is_empty()) {
+        result["tiles"] = tiles;
+    }
+    return result;
+}
+
+Dictionary SceneAnalyzer::_tool_find_nodes_by_class(Node *p_root, const Dictionary &p_args) const {
+    Dictionary result;
+    String class_name = p_args.get("class_name", "");
+    if (class_name.is_empty()) {
+        result["error"] = "Missing class_name.";
+        return result;
+    }
+
+    Array matches;
+    int total = 0;
+
+    List<Node *> stack;
+    stack.push_back(p_root);
+    while (!stack.is_empty()) {
+        Node *node = stack.front()->get();
+        stack.pop_front();
+
+        if (node->is_class(class_name)) {
+            if (matches.size() < FIND_NODES_LIMIT) {
+                Dictionary entry;
+                entry["path"] = String(p_root->get_path_to(node));
+                entry["class"] = node->get_class();
+                matches.push_back(entry);
+            }
+            total++;
+        }
+
+        for (int i = 0; i < node->get_child_count(); i++) {
+            stack.push_back(node->get_child(i));
+        }
+    }
+
+    result["class_name"] = class_name;
+    result["nodes"] = matches;
+    result["total"] = total;
+    return result;
+}
+
+Dictionary SceneAnalyzer::_tool_get_script_summary(Node *p_root, const Dictionary &p_args) const {
+    Dictionary result;
+    Node *node = _resolve_tool_node(p_root, p_args, result);
+    if (!node) {
+        return result;
+    }
+
+    Ref<Script> script = node->get_script();
+    if (script.is_null()) {
+        result["error"] = "Node has no script: " + String(p_root->get_path_to(node));
+        return result;
+    }
+
+    // The same declarations the scene context lists, from the mtime-keyed summary cache
+    result["path"] = String(p_root->get_path_to(node));
+    result["script"] = script->get_path();
+    result["summary"] = script_cache->get_summary(script->get_path());
+    script_cache->save();
+
+    // Level layouts are often script constants; grids print run-length encoded
+    HashMap<StringName, Variant> constant_map;
+    script->get_constants(&constant_map);
+    Dictionary constants;
+    for (const KeyValue<StringName, Variant> &E : constant_map) {
+        if (E.value.get_type() != Variant::OBJECT) {
+            constants[E.key] = format_value(E.value, float_precision);
+        }
+    }
+    if (!constants.is_empty()) {
+        result["constants"] = constants;
+    }
+
+    return result;
+}
+
+void SceneAnalyzer::_add_with_ancestors(Node *p_root, Node *p_node, ContextFilter &r_filter) const {
+    r_filter.expanded.insert(p_node);
+
+    Node *ancestor = p_node->get_parent();
+    while (ancestor && (ancestor == p_root || p_root->is_ancestor_of(ancestor))) {
+        if (!r_filter.expanded.has(ancestor)) {
+            r_filter.path.insert(ancestor);
+        }
+        if (ancestor == p_root) {
+            break;
+        }
+        ancestor = ancestor->get_parent();
+    }
+}
+
+bool SceneAnalyzer::_build_selection_filter(Node *p_root, ContextFilter &r_filter) const {
+    EditorSelection *selection = EditorInterface::get_singleton()->get_selection();
+    if (!selection) {
+        return false;
+    }
+
+    const List<Node *> &selected_nodes = selection->get_top_selected_node_list();
+    for (Node *node : selected_nodes) {
+        if (node != p_root && !p_root->is_ancestor_of(node)) {
+            continue;
+        }
+
+        // Selected nodes plus their immediate children
+        _add_with_ancestors(p_root, node, r_filter);
+        for (int i = 0; i < node->get_child_count(); i++) {
+            r_filter.expanded.insert(node->get_child(i));
+        }
+    }
+
+    // Nothing selected falls back to the whole scene
+    return !r_filter.expanded.is_empty();
+}
+
+bool SceneAnalyzer::_build_viewport_filter(Node *p_root, ContextFilter &r_filter) {
+    CanvasItemEditor *canvas_editor = CanvasItemEditor::get_singleton();
+    if (!canvas_editor || !canvas_editor->get_viewport_control()) {
+        return false;
+    }
+
+    // Visible part of the 2D canvas in canvas coordinates
+    Size2 viewport_size = canvas_editor->get_viewport_control()->get_size();
+    Rect2 visible_rect = canvas_editor->get_canvas_transform().affine_inverse().xform(Rect2(Point2(), viewport_size));
+
+    Array visible_nodes = query_nodes_in_rect(visible_rect);
+    for (int i = 0; i < visible_nodes.size(); i++) {
+        Node *node = Object::cast_to<Node>(visible_nodes[i]);
+        if (node) {
+            _add_with_ancestors(p_root, node, r_filter);
+        }
+    }
+
+    return !r_filter.expanded.is_empty();
+}
+
+Ref<SceneSpatialIndex> SceneAnalyzer::get_spatial_index() {
+    Node *current_scene = EditorNode::get_singleton()->get_edited_scene();
+    if (!current_scene) {
+        spatial_index->detach();
+    } else if (!spatial_index->is_attached_to(current_scene)) {
+        spatial_index->attach(current_scene);
+    }
+    return spatial_index;
+}
+
+Array SceneAnalyzer::query_nodes_in_rect(const Rect2 &p_rect) {
+    return get_spatial_index()->query_rect(p_rect);
+}
+
+Array SceneAnalyzer::query_nodes_in_radius(const Vector2 &p_center, real_t p_radius) {
+    return get_spatial_index()->query_radius(p_center, p_radius);
+}
+
+Array SceneAnalyzer::query_nearest_nodes(const Vector2 &p_point, int p_count) {
+    return get_spatial_index()->query_nearest(p_point, p_count);
+}
+
+String SceneAnalyzer::_summarize_omitted(Node *p_root, const ContextFilter &p_filter) const {
+    // Everything outside the scope collapses into a single line of class counts
+    HashMap<String, int> class_counts;
+    int omitted = 0;
+
+    List<Node *> stack;
+    stack.push_back(p_root);
+    while (!stack.is_empty()) {
+        Node *node = stack.back()->get();
+        stack.pop_back();
+
+        if (!p_filter.expanded.has(node) && !p_filter.path.has(node)) {
+            class_counts[node->get_class()]++;
+            omitted++;
+        }
+
+        for (int i = 0; i < node->get_child_count(); i++) {
+            stack.push_back(node->get_child(i));
+        }
+    }
+
+    if (omitted == 0) {
+        return "";
+    }
+
+    Vector<Pair<int, String>> counts;
+    for (const KeyValue<String, int> &E : class_counts) {
+        counts.push_back(Pair<int, String>(-E.value, E.key));
+    }
+    counts.sort_custom<PairSort<int, String>>();
+
+    PackedStringArray top_classes;
+    for (int i = 0; i < counts.size() && i < 6; i++) {
+        top_classes.push_back(vformat("%d %s", -counts[i].first, counts[i].second));
+    }
+    if (counts.size() > 6) {
+        top_classes.push_back("...");
+    }
+
+    return vformat("Other nodes (%d, not expanded): %s\n", omitted, String(", ").join(top_classes));
+}
+
+String SceneAnalyzer::_analyze_node(Node *p_node, int p_indent_level, const ContextFilter *p_filter, InstanceTable *p_instances) {
     if (!p_node) {
         return "";
     }
+
+    bool expanded = !p_filter || p_filter->expanded.has(p_node);
+    if (!expanded && !p_filter->path.has(p_node)) {
+        return "";
+    }
     
     String indent = String("  ").repeat(p_indent_level);
+
+    // Instanced scenes are described once; here they only list what differs.
+    // Editable instances are expanded like any other node.
+    bool instanced = p_instances && p_node != p_instances->root && !p_node->get_scene_file_path().is_empty() && !p_instances->root->is_editable_instance(p_node);
+    if (instanced) {
+        String scene_path = p_node->get_scene_file_path();
+        p_instances->counts[scene_path]++;
+
+        String node_info = indent + "- " + p_node->get_name() + " (" + p_node->get_class() + ") [instance of " + scene_path + "]\n";
+        if (expanded) {
+            PackedStringArray overrides = _get_instance_overrides(p_node);
+            if (!overrides.is_empty()) {
+                node_info += indent + "  Overrides: " + String(", ").join(overrides) + "\n";
+            }
+        }
+
+        // Only children added by this scene; the instance's own are in its definition
+        for (int i = 0; i < p_node->get_child_count(); i++) {
+            Node *child = p_node->get_child(i);
+            if (child->get_owner() == p_instances->root) {
+                node_info += _analyze_node(child, p_indent_level + 1, p_filter, p_instances);
+            }
+        }
+
+        return node_info;
+    }
+
     String node_info = indent + "- " + p_node->get_name() + " (" + p_node->get_class() + ")\n";
     
-    // Add node properties
-    Dictionary properties = _get_node_properties(p_node);
-    if (properties.size() > 0) {
-        node_info += indent + "  Properties:\n";
-        
-        Array keys = properties.keys();
-        for (int i = 0; i < keys.size(); i++) {
-            String property = keys[i];
-            Variant value = properties[property];
-            node_info += indent + "    " + property + ": " + String(value) + "\n";
+    // Add node properties, leaving out class defaults
+    if (expanded) {
+        node_info += _format_properties(p_node->get_class_name(), _get_node_properties(p_node), indent);
+        node_info += TileGridCodec::describe_tiles(p_node, indent);
+
+        // Scripts saved as files are summarized once at the end; built-in ones are only named
+        Ref<Script> script = p_node->get_script();
+        if (script.is_valid()) {
+            String script_path = script->get_path();
+            node_info += indent + "  Script: " + (script_path.is_resource_file() ? script_path : String("(built-in)")) + "\n";
+            if (p_instances && script_path.is_resource_file()) {
+                p_instances->scripts.insert(script_path);
+            }
         }
     }
     
-    // Recursively analyze child nodes
+    // Recursively analyze child nodes, tracing each top-level subtree separately
+    VectorAITracer *tracer = VectorAITracer::get_singleton();
+    bool trace_subtrees = p_indent_level == 0 && tracer && tracer->is_enabled();
+
     for (int i = 0; i < p_node->get_child_count(); i++) {
-        node_info += _analyze_node(p_node->get_child(i), p_indent_level + 1);
+        Node *child = p_node->get_child(i);
+        String span_name;
+        if (trace_subtrees) {
+            span_name = "subtree " + child->get_name();
+            tracer->begin_span_named(span_name);
+        }
+
+        node_info += _analyze_node(child, p_indent_level + 1, p_filter, p_instances);
+
+        if (trace_subtrees) {
+            tracer->end_span_named(span_name);
+        }
     }
     
     return node_info;
 }
 
+PackedStringArray SceneAnalyzer::_get_instance_overrides(Node *p_node) const {
+    // Same comparison the inspector uses for its revert arrows
+    PackedStringArray overrides;
+    Vector<SceneState::PackState> states_stack = PropertyUtils::get_node_states_stack(p_node);
+
+    List<PropertyInfo> property_list;
+    p_node->get_property_list(&property_list);
+
+    int total = 0;
+    for (const PropertyInfo &property : property_list) {
+        if (!(property.usage & PROPERTY_USAGE_STORAGE)) {
+            continue;
+        }
+
+        bool valid = false;
+        Variant default_value = PropertyUtils::get_property_default_value(p_node, property.name, &valid, &states_stack);
+        if (!valid) {
+            continue;
+        }
+
+        Variant value = p_node->get(property.name);
+        if (!PropertyUtils::is_property_value_different(p_node, value, default_value)) {
+            continue;
+        }
+
+        total++;
+        if (overrides.size() >= MAX_INSTANCE_OVERRIDES) {
+            continue;
+        }
+
+        Ref<Resource> resource = value;
+        String text = resource.is_valid() && !resource->get_path().is_empty() ? resource->get_path() : format_value(value, float_precision);
+        overrides.push_back(property.name + "=" + text);
+    }
+
+    if (total > overrides.size()) {
+        overrides.push_back(vformat("... %d more", total - overrides.size()));
+    }
+
+    return overrides;
+}
+
+String SceneAnalyzer::_summarize_instances(const InstanceTable &p_instances) const {
+    if (p_instances.counts.is_empty()) {
+        return "";
+    }
+
+    String info = "\nInstanced Scenes (described once; instances above list only their overrides):\n";
+    for (const KeyValue<String, int> &E : p_instances.counts) {
+        info += vformat("- %s (%d %s)\n", E.key, E.value, E.value == 1 ? "instance" : "instances");
+
+        // Definitions come from the scene file, not from any one instance
+        Ref<PackedScene> packed_scene = ResourceLoader::load(E.key, "PackedScene");
+        if (packed_scene.is_valid() && packed_scene->get_state().is_valid()) {
+            _analyze_state(packed_scene->get_state(), 1, 0, info);
+        }
+    }
+
+    return info;
+}
+
+String SceneAnalyzer::_summarize_scripts(const InstanceTable &p_instances) const {
+    if (p_instances.scripts.is_empty()) {
+        return "";
+    }
+
+    // Declarations only, from the summary cache; unchanged scripts are not parsed again
+    String info = "\nScripts (exported variables, signals and functions):\n";
+    for (const String &path : p_instances.scripts) {
+        info += "- " + path + "\n";
+        Vector<String> lines = script_cache->get_summary(path).split("\n", false);
+        for (const String &line : lines) {
+            info += "    " + line + "\n";
+        }
+    }
+    script_cache->save();
+
+    return info;
+}
+
 Dictionary SceneAnalyzer::_get_node_properties(Node *p_node) {
     Dictionary properties;
     
@@ -204,6 +1418,8 @@ Dictionary SceneAnalyzer::_get_node_properties(Node *p_node) {
 }
 
 SceneAnalyzer::SceneAnalyzer() {
+    spatial_index.instantiate();
+    script_cache.instantiate();
 }
 
 SceneAnalyzer::~SceneAnalyzer() {
@@ -30,21 +30,122 @@
 
 #pragma once
 
+#include "core/os/mutex.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/hash_set.h"
 #include "scene/main/node.h"
+#include "scene/resources/packed_scene.h"
+#include "scene_spatial_index.h"
+#include "script_summary_cache.h"
 
 class SceneAnalyzer : public Node {
     GDCLASS(SceneAnalyzer, Node);
 
+public:
+    enum ContextScope {
+        SCOPE_SCENE,
+        SCOPE_SELECTION,
+        SCOPE_VIEWPORT,
+    };
+
 private:
-    String _analyze_node(Node *p_node, int p_indent_level);
+    // Nodes that make it into a scoped context
+    struct ContextFilter {
+        HashSet<Node *> expanded; // Listed with their properties
+        HashSet<Node *> path; // Ancestors listed by name only
+    };
+
+    // Instanced scenes and attached scripts seen during one analysis; each is described once at the end
+    struct InstanceTable {
+        Node *root = nullptr;
+        HashMap<String, int> counts;
+        HashSet<String> scripts;
+    };
+
+    static const int MAX_INSTANCE_OVERRIDES = 16;
+
+    // Decimals kept for floats in the context; -1 prints full precision
+    int float_precision = 3;
+
+    // Class defaults, filled lazily; batch analysis reads them from worker threads
+    struct DefaultValue {
+        bool valid = false;
+        Variant value;
+    };
+    mutable HashMap<StringName, HashMap<StringName, DefaultValue>> default_cache;
+    mutable Mutex default_cache_mutex;
+
+    ContextScope context_scope = SCOPE_SCENE;
+    Ref<SceneSpatialIndex> spatial_index;
+    Ref<ScriptSummaryCache> script_cache;
+
+    // Tool answers for the request in flight, keyed by tool name and arguments
+    static const int OUTLINE_DEPTH = 2;
+    static const int FIND_NODES_LIMIT = 50;
+    HashMap<String, Dictionary> tool_cache;
+    ObjectID tool_cache_root;
+
+    String _analyze_node(Node *p_node, int p_indent_level, const ContextFilter *p_filter = nullptr, InstanceTable *p_instances = nullptr);
+    PackedStringArray _get_instance_overrides(Node *p_node) const;
+    String _summarize_instances(const InstanceTable &p_instances) const;
+    String _summarize_scripts(const InstanceTable &p_instances) const;
     Dictionary _get_node_properties(Node *p_node);
+    bool _is_class_default(const StringName &p_class, const String &p_key, const Variant &p_value) const;
+    String _format_properties(const StringName &p_class, const Dictionary &p_properties, const String &p_indent) const;
+
+    // Scene files read without instantiating: SceneState, or a streaming text parse for huge files
+    static const int MAX_INSTANCE_NESTING = 8;
+    static const int64_t STREAMING_THRESHOLD = 16 * 1024 * 1024;
+    static StringName _get_state_node_type(const Ref<SceneState> &p_state, int p_index);
+    static Variant _get_state_value(const Ref<SceneState> &p_state, int p_index, const StringName &p_type, const StringName &p_property);
+    Dictionary _get_state_properties(const Ref<SceneState> &p_state, int p_index, const StringName &p_type) const;
+    PackedStringArray _get_state_overrides(const Ref<SceneState> &p_state, int p_index) const;
+    void _analyze_state(const Ref<SceneState> &p_state, int p_indent_level, int p_nesting, String &r_info, InstanceTable *p_instances = nullptr) const;
+    String _analyze_text_scene(const String &p_path) const;
+
+    void _add_with_ancestors(Node *p_root, Node *p_node, ContextFilter &r_filter) const;
+    bool _build_selection_filter(Node *p_root, ContextFilter &r_filter) const;
+    bool _build_viewport_filter(Node *p_root, ContextFilter &r_filter);
+    String _summarize_omitted(Node *p_root, const ContextFilter &p_filter) const;
+
+    String _outline_node(Node *p_node, int p_indent_level) const;
+    Node *_resolve_tool_node(Node *p_root, const Dictionary &p_args, Dictionary &r_error) const;
+    Dictionary _tool_list_children(Node *p_root, const Dictionary &p_args) const;
+    Dictionary _tool_get_node_properties(Node *p_root, const Dictionary &p_args);
+    Dictionary _tool_find_nodes_by_class(Node *p_root, const Dictionary &p_args) const;
+    Dictionary _tool_get_script_summary(Node *p_root, const Dictionary &p_args) const;
 
 protected:
     static void _bind_methods();
 
 public:
+    static String get_scope_name(ContextScope p_scope);
+    static String format_value(const Variant &p_value, int p_precision);
+
+    void set_float_precision(int p_precision);
+    int get_float_precision() const;
+
+    void set_context_scope(ContextScope p_scope);
+    ContextScope get_context_scope() const;
+
     String analyze_current_scene();
+    String analyze_scene(Node *p_root);
+    String analyze_scene_file(const String &p_path);
+
+    // Outline limited to the top levels; the model pulls the rest through tools
+    String analyze_shallow_outline();
+    static Array get_tool_declarations();
+    Dictionary call_tool(const String &p_name, const Dictionary &p_args);
+    void clear_tool_cache();
+
+    // Index over the edited scene, re-attached when the scene changes
+    Ref<SceneSpatialIndex> get_spatial_index();
+    Array query_nodes_in_rect(const Rect2 &p_rect);
+    Array query_nodes_in_radius(const Vector2 &p_center, real_t p_radius);
+    Array query_nearest_nodes(const Vector2 &p_point, int p_count);
 
     SceneAnalyzer();
     ~SceneAnalyzer();
 };
+
+VARIANT_ENUM_CAST(SceneAnalyzer::ContextScope);
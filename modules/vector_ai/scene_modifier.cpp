@@ -30,11 +30,55 @@
 
 #include "scene_modifier.h"
 
+#include "core/io/resource_loader.h"
+#include "core/io/resource_saver.h"
+#include "core/variant/variant_utility.h"
+#include "editor/editor_file_system.h"
 #include "editor/editor_node.h"
 #include "editor/editor_undo_redo_manager.h"
+#include "editor/gui/editor_toaster.h"
+#include "scene/2d/node_2d.h"
+#include "scene/3d/node_3d.h"
+#include "scene/resources/packed_scene.h"
+#include "tile_grid_codec.h"
+
+void SceneModifier::_notification(int p_what) {
+    switch (p_what) {
+        case NOTIFICATION_ENTER_TREE: {
+            // Deferred, so a closed scene's history is already gone when it is checked
+            if (EditorUndoRedoManager::get_singleton()) {
+                EditorUndoRedoManager::get_singleton()->connect("history_changed", callable_mp(this, &SceneModifier::_prune_payloads), CONNECT_DEFERRED);
+            }
+            if (EditorNode::get_singleton()) {
+                EditorNode::get_singleton()->connect("scene_closed", callable_mp(this, &SceneModifier::_prune_payloads).unbind(1), CONNECT_DEFERRED);
+            }
+        } break;
+        case NOTIFICATION_EXIT_TREE: {
+            if (EditorUndoRedoManager::get_singleton()) {
+                EditorUndoRedoManager::get_singleton()->disconnect("history_changed", callable_mp(this, &SceneModifier::_prune_payloads));
+            }
+            if (EditorNode::get_singleton()) {
+                EditorNode::get_singleton()->disconnect("scene_closed", callable_mp(this, &SceneModifier::_prune_payloads).unbind(1));
+            }
+        } break;
+    }
+}
 
 void SceneModifier::_bind_methods() {
     ClassDB::bind_method(D_METHOD("apply_modifications", "modifications"), &SceneModifier::apply_modifications);
+    ClassDB::bind_method(D_METHOD("apply_modifications_to", "root", "modifications"), &SceneModifier::apply_modifications_to);
+    ClassDB::bind_method(D_METHOD("validate_modifications", "modifications"), &SceneModifier::validate_modifications);
+    ClassDB::bind_method(D_METHOD("replay_changes", "changes", "remap"), &SceneModifier::replay_changes, DEFVAL(Dictionary()));
+    ClassDB::bind_method(D_METHOD("replay_changes_to", "root", "changes", "remap"), &SceneModifier::replay_changes_to, DEFVAL(Dictionary()));
+    ClassDB::bind_method(D_METHOD("replay_changes_to_scenes", "changes", "scene_paths", "remap"), &SceneModifier::replay_changes_to_scenes, DEFVAL(Dictionary()));
+    ClassDB::bind_method(D_METHOD("create_node", "parent_path", "type", "name", "properties", "typed_properties"), &SceneModifier::create_node, DEFVAL(Dictionary()));
+    ClassDB::bind_method(D_METHOD("set_spatial_index", "index"), &SceneModifier::set_spatial_index);
+    ClassDB::bind_method(D_METHOD("set_undo_memory_cap", "bytes"), &SceneModifier::set_undo_memory_cap);
+    ClassDB::bind_method(D_METHOD("get_undo_stats"), &SceneModifier::get_undo_stats);
+    ClassDB::bind_method(D_METHOD("_restore_payload", "node", "property", "id", "undo"), &SceneModifier::_restore_payload);
+    ClassDB::bind_method(D_METHOD("stage_modification", "modification"), &SceneModifier::stage_modification);
+    ClassDB::bind_method(D_METHOD("commit_staged"), &SceneModifier::commit_staged);
+    ClassDB::bind_method(D_METHOD("get_staged_count"), &SceneModifier::get_staged_count);
 }
 
 Dictionary SceneModifier::apply_modifications(const Dictionary &p_modifications) {
@@ -58,86 +102,1002 @@ Dictionary SceneModifier::apply_modifications(const Dictionary &p_modifications)
         return result;
     }
     
-    // Start the undo/redo action
-    undo_redo->create_action("Vector AI Modifications");
-    
-    bool success = true;
     String error_message = "";
+    ChangeList changes;
+    int applied = _apply_list(current_scene, current_scene, p_modifications, &changes, error_message);
     
-    // Apply each modification
-    if (p_modifications.has("list") && p_modifications["list"].get_type() == Variant::ARRAY) {
-        Array modifications = p_modifications["list"];
-        
-        for (int i = 0; i < modifications.size(); i++) {
-            Dictionary modification = modifications[i];
-            
-            if (!modification.has("node_path") || !modification.has("property_value")) {
+    // Record the undo/redo action; payload restores run on this node but belong to the scene's history
+    _commit_undo_action("Vector AI Modifications", current_scene, changes);
+    
+    // Return the result
+    result["success"] = error_message.is_empty();
+    result["error"] = error_message;
+    result["applied"] = applied;
+    result["changes"] = _make_journal_changes(current_scene, changes);
+    result["scene_path"] = current_scene->get_scene_file_path();
+    
+    return result;
+}
+
+Dictionary SceneModifier::apply_modifications_to(Node *p_root, const Dictionary &p_modifications) {
+    Dictionary result;
+    result["success"] = false;
+    result["error"] = "";
+
+    if (!p_root) {
+        result["error"] = "No scene root given.";
+        return result;
+    }
+
+    // Scenes outside the editor (batch runs) are changed directly, without undo.
+    // This may run on a worker thread, so the edited scene is not looked up.
+    String error_message = "";
+    int applied = _apply_list(p_root, nullptr, p_modifications, nullptr, error_message);
+
+    result["success"] = error_message.is_empty();
+    result["error"] = error_message;
+    result["applied"] = applied;
+
+    return result;
+}
+
+void SceneModifier::_record_change(ChangeList &r_changes, Node *p_node, const StringName &p_property, const Variant &p_old_value) {
+    // Only the value before the first change of each property is kept, so everything undoes as one step
+    ObjectID id = p_node->get_instance_id();
+    HashSet<StringName> &recorded = r_changes.recorded[id];
+    if (recorded.has(p_property)) {
+        return;
+    }
+    recorded.insert(p_property);
+
+    Change change;
+    change.node = id;
+    change.property = p_property;
+    change.old_value = p_old_value;
+    r_changes.changes.push_back(change);
+}
+
+void SceneModifier::_commit_undo_action(const String &p_name, Object *p_context, const ChangeList &p_changes) {
+    EditorUndoRedoManager *undo_redo = EditorUndoRedoManager::get_singleton();
+    if (!undo_redo || p_changes.is_empty()) {
+        return;
+    }
+
+    // Changes are already applied; the action stores the final and the original values
+    struct Entry {
+        Object *node = nullptr;
+        StringName property;
+        Variant new_value;
+        Variant old_value;
+        int payload = -1;
+    };
+
+    int group = undo_payloads.begin_group();
+    bool has_payload = false;
+    LocalVector<Entry> entries;
+    for (const Change &change : p_changes.changes) {
+        Object *node = ObjectDB::get_instance(change.node);
+        if (!node) {
+            continue;
+        }
+
+        Entry entry;
+        entry.node = node;
+        entry.property = change.property;
+        entry.new_value = node->get(change.property);
+        entry.old_value = change.old_value;
+        if (UndoPayloadStore::is_compactable(entry.old_value, entry.new_value)) {
+            // Large arrays keep only the blocks that differ; unchanged ones need no entry at all
+            entry.payload = undo_payloads.store(entry.old_value, entry.new_value, group);
+            if (entry.payload == -1) {
                 continue;
             }
-            
-            String node_path = modification["node_path"];
-            String property_value = modification["property_value"];
-            
-            // Find the node
-            Node *node = current_scene->get_node_or_null(node_path);
-            if (!node) {
-                success = false;
-                error_message = "Node not found: " + node_path;
-                continue;
+            has_payload = true;
+        }
+        entries.push_back(entry);
+    }
+
+    // Room for this action is made before it is added, so a history cleared for it keeps it
+    LocalVector<int> released;
+    undo_payloads.evict(released);
+    _release_payload_groups(released);
+    if (has_payload) {
+        payload_histories[group] = undo_redo->get_history_id_for_object(p_context);
+    }
+
+    undo_redo->create_action(p_name, UndoRedo::MERGE_DISABLE, p_context);
+    for (const Entry &entry : entries) {
+        if (entry.payload != -1) {
+            undo_redo->add_do_method(this, "_restore_payload", entry.node, entry.property, entry.payload, false);
+            undo_redo->add_undo_method(this, "_restore_payload", entry.node, entry.property, entry.payload, true);
+        } else {
+            undo_redo->add_do_property(entry.node, entry.property, entry.new_value);
+            undo_redo->add_undo_property(entry.node, entry.property, entry.old_value);
+        }
+    }
+    undo_redo->commit_action(false);
+}
+
+void SceneModifier::_restore_payload(Object *p_node, const StringName &p_property, int p_id, bool p_undo) {
+    ERR_FAIL_NULL(p_node);
+
+    Variant value;
+    if (!undo_payloads.restore(p_id, p_undo, p_node->get(p_property), value)) {
+        WARN_PRINT(vformat("Vector AI: Undo data for \"%s\" no longer matches the property; it is left unchanged.", p_property));
+        return;
+    }
+    p_node->set(p_property, value);
+}
+
+void SceneModifier::_release_payload_groups(const LocalVector<int> &p_groups) {
+    EditorUndoRedoManager *undo_redo = EditorUndoRedoManager::get_singleton();
+    if (p_groups.is_empty() || !undo_redo) {
+        return;
+    }
+
+    // An action without its deltas can't be undone, and skipping it would leave the history
+    // out of step with the scene, so the histories that held them are cleared
+    HashSet<int> histories;
+    for (int group : p_groups) {
+        const int *history = payload_histories.getptr(group);
+        if (history) {
+            histories.insert(*history);
+        }
+        payload_histories.erase(group);
+    }
+
+    // The other deltas of those histories are freed by _prune_payloads once history_changed arrives
+    for (int history : histories) {
+        if (undo_redo->has_history(history)) {
+            undo_redo->clear_history(history);
+        }
+    }
+
+    String message = "Vector AI: The undo memory cap was reached, so the undo history of the scene holding the oldest AI edits was cleared.";
+    WARN_PRINT(message);
+    if (EditorToaster::get_singleton()) {
+        EditorToaster::get_singleton()->popup_str(message, EditorToaster::SEVERITY_WARNING);
+    }
+}
+
+void SceneModifier::_prune_payloads() {
+    // Deltas of histories that were cleared or discarded with their scene are freed right away
+    EditorUndoRedoManager *undo_redo = EditorUndoRedoManager::get_singleton();
+    if (!undo_redo) {
+        return;
+    }
+
+    LocalVector<int> unused;
+    for (const KeyValue<int, int> &E : payload_histories) {
+        if (!undo_redo->has_history(E.value) || undo_redo->get_history_undo_redo(E.value)->get_history_count() == 0) {
+            unused.push_back(E.key);
+        }
+    }
+    for (int group : unused) {
+        undo_payloads.release_group(group);
+        payload_histories.erase(group);
+    }
+
+    if (payload_histories.is_empty()) {
+        undo_payloads.clear();
+    }
+}
+
+bool SceneModifier::_parse_selector(const String &p_text, Selector &r_selector, String &r_error) {
+    // key=value terms separated by spaces; parentheses keep a region's spaces inside its value
+    String text = p_text.substr(strlen("@select")).strip_edges();
+    int i = 0;
+    while (i < text.length()) {
+        while (i < text.length() && text[i] == ' ') {
+            i++;
+        }
+        int start = i;
+        int depth = 0;
+        while (i < text.length() && (depth > 0 || text[i] != ' ')) {
+            if (text[i] == '(') {
+                depth++;
+            } else if (text[i] == ')') {
+                depth--;
             }
-            
-            // Parse the property and value
-            Vector<String> parts = property_value.split("=", true, 1);
-            if (parts.size() < 2) {
-                success = false;
-                error_message = "Invalid property format: " + property_value;
-                continue;
+            i++;
+        }
+
+        String term = text.substr(start, i - start);
+        if (term.is_empty()) {
+            continue;
+        }
+
+        String key = term.get_slicec('=', 0);
+        String value = term.substr(key.length() + 1).strip_edges();
+        if (!term.contains("=") || value.is_empty()) {
+            r_error = "Invalid selector term: " + term;
+            return false;
+        }
+
+        if (key == "class") {
+            if (!ClassDB::class_exists(value)) {
+                r_error = "Unknown class in selector: " + value;
+                return false;
+            }
+            r_selector.class_name = value;
+        } else if (key == "group") {
+            r_selector.group = value;
+        } else if (key == "name") {
+            r_selector.name_pattern = value;
+        } else if (key == "under") {
+            r_selector.under = value;
+        } else if (key == "region") {
+            // (x, y, w, h) for 2D, (x, y, z, w, h, d) for 3D
+            PackedFloat64Array numbers = value.trim_prefix("(").trim_suffix(")").split_floats(",");
+            if (numbers.size() == 4) {
+                r_selector.region = AABB(Vector3(numbers[0], numbers[1], 0), Vector3(numbers[2], numbers[3], 0));
+            } else if (numbers.size() == 6) {
+                r_selector.region = AABB(Vector3(numbers[0], numbers[1], numbers[2]), Vector3(numbers[3], numbers[4], numbers[5]));
+                r_selector.region_is_3d = true;
+            } else {
+                r_error = "Invalid selector region: " + value;
+                return false;
             }
-            
-            String property_name = parts[0].strip_edges();
-            String property_value_str = parts[1].strip_edges();
-            
-            // Convert the value to the appropriate type
-            Variant value = _parse_value(property_value_str);
-            
-            // Check if the property exists
-            bool property_exists = false;
-            List<PropertyInfo> properties;
-            node->get_property_list(&properties);
-            
-            for (List<PropertyInfo>::Element *E = properties.front(); E; E = E->next()) {
-                if (E->get().name == property_name) {
-                    property_exists = true;
-                    break;
+            r_selector.has_region = true;
+        } else {
+            r_error = "Unknown selector key: " + key;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Scenes outside the tree have no global transforms, so local ones are composed up to the root
+static Vector2 _get_scene_position_2d(Node2D *p_node, Node *p_root) {
+    Transform2D xform = p_node->get_transform();
+    Node *parent = p_node == p_root ? nullptr : p_node->get_parent();
+    while (CanvasItem *item = Object::cast_to<CanvasItem>(parent)) {
+        xform = item->get_transform() * xform;
+        parent = parent == p_root ? nullptr : parent->get_parent();
+    }
+    return xform.get_origin();
+}
+
+static Vector3 _get_scene_position_3d(Node3D *p_node, Node *p_root) {
+    Transform3D xform = p_node->get_transform();
+    Node *parent = p_node == p_root ? nullptr : p_node->get_parent();
+    while (Node3D *node_3d = Object::cast_to<Node3D>(parent)) {
+        xform = node_3d->get_transform() * xform;
+        parent = parent == p_root ? nullptr : parent->get_parent();
+    }
+    return xform.origin;
+}
+
+void SceneModifier::_select_nodes(Node *p_root, Node *p_edited_root, const Selector &p_selector, LocalVector<Node *> &r_nodes) {
+    Node *start = p_selector.under.is_empty() ? p_root : p_root->get_node_or_null(p_selector.under);
+    if (!start) {
+        return;
+    }
+
+    // Region matches come from the spatial index when it covers this scene.
+    // The caller passes the edited scene in, since worker threads can't ask the editor.
+    HashSet<ObjectID> in_region;
+    bool use_index = false;
+    if (p_selector.has_region && spatial_index.is_valid() && p_root == p_edited_root) {
+        if (!spatial_index->is_attached_to(p_root)) {
+            spatial_index->attach(p_root);
+        }
+        const AABB &region = p_selector.region;
+        Array hits = p_selector.region_is_3d ? spatial_index->query_aabb(region) : spatial_index->query_rect(Rect2(region.position.x, region.position.y, region.size.x, region.size.y));
+        for (int i = 0; i < hits.size(); i++) {
+            Object *hit = hits[i];
+            if (hit) {
+                in_region.insert(hit->get_instance_id());
+            }
+        }
+        use_index = true;
+    }
+
+    LocalVector<Node *> stack;
+    stack.push_back(start);
+    while (!stack.is_empty()) {
+        Node *node = stack[stack.size() - 1];
+        stack.resize(stack.size() - 1);
+
+        for (int i = node->get_child_count() - 1; i >= 0; i--) {
+            stack.push_back(node->get_child(i));
+        }
+
+        // Nodes inside instanced scenes belong to those scenes
+        if (node != p_root && node->get_owner() != p_root) {
+            continue;
+        }
+        if (p_selector.class_name != StringName() && !node->is_class(p_selector.class_name)) {
+            continue;
+        }
+        if (p_selector.group != StringName() && !node->is_in_group(p_selector.group)) {
+            continue;
+        }
+        if (!p_selector.name_pattern.is_empty() && !String(node->get_name()).match(p_selector.name_pattern)) {
+            continue;
+        }
+
+        if (p_selector.has_region) {
+            if (use_index) {
+                if (!in_region.has(node->get_instance_id())) {
+                    continue;
                 }
+            } else {
+                // Scenes outside the editor: test the node's origin instead of its bounds
+                Node2D *node_2d = Object::cast_to<Node2D>(node);
+                Node3D *node_3d = Object::cast_to<Node3D>(node);
+                Vector3 origin;
+                if (node_2d && !p_selector.region_is_3d) {
+                    Vector2 position = _get_scene_position_2d(node_2d, p_root);
+                    origin = Vector3(position.x, position.y, 0);
+                } else if (node_3d && p_selector.region_is_3d) {
+                    origin = _get_scene_position_3d(node_3d, p_root);
+                } else {
+                    continue;
+                }
+                const AABB &region = p_selector.region;
+                if (origin.x < region.position.x || origin.y < region.position.y || origin.x > region.position.x + region.size.x || origin.y > region.position.y + region.size.y) {
+                    continue;
+                }
+                if (p_selector.region_is_3d && (origin.z < region.position.z || origin.z > region.position.z + region.size.z)) {
+                    continue;
+                }
+            }
+        }
+
+        r_nodes.push_back(node);
+    }
+}
+
+bool SceneModifier::_apply_rule(Node *p_root, Node *p_edited_root, const String &p_selector, const String &p_assignments, ChangeList *r_changes, String &r_error) {
+    Selector selector;
+    if (!_parse_selector(p_selector, selector, r_error)) {
+        return false;
+    }
+
+    LocalVector<Node *> nodes;
+    _select_nodes(p_root, p_edited_root, selector, nodes);
+    if (nodes.is_empty()) {
+        r_error = "No nodes match: " + p_selector;
+        return false;
+    }
+
+    // Several assignments may share one rule; all are checked before any is applied,
+    // so a rule either changes every assignment or nothing
+    Vector<String> assignments = _split_assignments(p_assignments);
+    LocalVector<StringName> property_names;
+    LocalVector<Variant> values;
+    for (int i = 0; i < assignments.size(); i++) {
+        Vector<String> parts = assignments[i].split("=", true, 1);
+        if (parts.size() < 2) {
+            r_error = "Invalid property format: " + assignments[i].strip_edges();
+            return false;
+        }
+
+        StringName property_name = parts[0].strip_edges();
+        bool found = false;
+        for (Node *node : nodes) {
+            node->get(property_name, &found);
+            if (found) {
+                break;
             }
-            
-            if (!property_exists) {
-                success = false;
-                error_message = "Property not found: " + property_name + " in node " + node_path;
+        }
+        if (!found) {
+            r_error = "Property not found: " + String(property_name) + " in any node matching " + p_selector;
+            return false;
+        }
+
+        property_names.push_back(property_name);
+        values.push_back(_parse_value(parts[1].strip_edges()));
+    }
+
+    for (uint32_t i = 0; i < property_names.size(); i++) {
+        // Nodes without the property (other classes caught by a loose selector) are left alone
+        for (Node *node : nodes) {
+            bool valid = false;
+            Variant old_value = node->get(property_names[i], &valid);
+            if (!valid) {
                 continue;
             }
-            
-            // Get the old value
-            Variant old_value = node->get(property_name);
-            
-            // Add the undo/redo operation
-            undo_redo->add_do_property(node, property_name, value);
-            undo_redo->add_undo_property(node, property_name, old_value);
+            if (r_changes) {
+                _record_change(*r_changes, node, property_names[i], old_value);
+            }
+            node->set(property_names[i], values[i]);
         }
     }
-    
-    // Commit the undo/redo action
-    undo_redo->commit_action();
-    
-    // Return the result
+    return true;
+}
+
+Vector<String> SceneModifier::_split_assignments(const String &p_assignments) {
+    // Only top-level ";" separates assignments; values like Grid(4x4; 0: 1*4) keep theirs
+    Vector<String> assignments;
+    int depth = 0;
+    bool in_string = false;
+    int start = 0;
+    for (int i = 0; i < p_assignments.length(); i++) {
+        char32_t c = p_assignments[i];
+        if (c == '"' && (i == 0 || p_assignments[i - 1] != '\\')) {
+            in_string = !in_string;
+        } else if (in_string) {
+            continue;
+        } else if (c == '(' || c == '[' || c == '{') {
+            depth++;
+        } else if ((c == ')' || c == ']' || c == '}') && depth > 0) {
+            depth--;
+        } else if (c == ';' && depth == 0) {
+            String assignment = p_assignments.substr(start, i - start);
+            if (!assignment.strip_edges().is_empty()) {
+                assignments.push_back(assignment);
+            }
+            start = i + 1;
+        }
+    }
+
+    String assignment = p_assignments.substr(start);
+    if (!assignment.strip_edges().is_empty()) {
+        assignments.push_back(assignment);
+    }
+    return assignments;
+}
+
+bool SceneModifier::_apply_modification(Node *p_root, Node *p_edited_root, const Dictionary &p_modification, ChangeList *r_changes, String &r_error) {
+    if (!p_modification.has("node_path") || !p_modification.has("property_value")) {
+        return false;
+    }
+
+    String node_path = p_modification["node_path"];
+    String property_value = p_modification["property_value"];
+
+    // Rules are expanded here, so the model writes one line however many nodes match
+    if (node_path.begins_with("@select")) {
+        return _apply_rule(p_root, p_edited_root, node_path, property_value, r_changes, r_error);
+    }
+
+    // Find the node
+    Node *node = p_root->get_node_or_null(node_path);
+    if (!node) {
+        r_error = "Node not found: " + node_path;
+        return false;
+    }
+
+    // Parse the property and value
+    Vector<String> parts = property_value.split("=", true, 1);
+    if (parts.size() < 2) {
+        r_error = "Invalid property format: " + property_value;
+        return false;
+    }
+
+    String property_name = parts[0].strip_edges();
+    String property_value_str = parts[1].strip_edges();
+
+    // Tile layers take run-length row patches instead of a property value
+    if (property_name == "tile_rle" || property_name.begins_with("tile_rle/")) {
+        int layer = property_name.contains("/") ? property_name.get_slicec('/', 1).to_int() : -1;
+        StringName data_property = TileGridCodec::get_tile_data_property(node, layer);
+        Variant old_data = data_property != StringName() ? node->get(data_property) : Variant();
+
+        String patch_error;
+        if (TileGridCodec::apply_tile_patch(node, layer, property_value_str, patch_error) != OK) {
+            if (old_data.get_type() != Variant::NIL) {
+                node->set(data_property, old_data);
+            }
+            r_error = patch_error + " in node " + node_path;
+            return false;
+        }
+
+        if (r_changes) {
+            _record_change(*r_changes, node, data_property, old_data);
+        }
+        return true;
+    }
+
+    // Convert the value to the appropriate type
+    Variant value = _parse_value(property_value_str);
+
+    // Check if the property exists
+    bool property_exists = false;
+    List<PropertyInfo> properties;
+    node->get_property_list(&properties);
+
+    for (List<PropertyInfo>::Element *E = properties.front(); E; E = E->next()) {
+        if (E->get().name == property_name) {
+            property_exists = true;
+            break;
+        }
+    }
+
+    if (!property_exists) {
+        r_error = "Property not found: " + property_name + " in node " + node_path;
+        return false;
+    }
+
+    if (r_changes) {
+        _record_change(*r_changes, node, property_name, node->get(property_name));
+    }
+    node->set(property_name, value);
+    return true;
+}
+
+int SceneModifier::_apply_list(Node *p_root, Node *p_edited_root, const Dictionary &p_modifications, ChangeList *r_changes, String &r_error) {
+    int applied = 0;
+
+    // Apply each modification
+    if (p_modifications.has("list") && p_modifications["list"].get_type() == Variant::ARRAY) {
+        Array modifications = p_modifications["list"];
+
+        for (int i = 0; i < modifications.size(); i++) {
+            if (_apply_modification(p_root, p_edited_root, modifications[i], r_changes, r_error)) {
+                applied++;
+            }
+        }
+    }
+
+    return applied;
+}
+
+Array SceneModifier::_make_journal_changes(Node *p_root, const ChangeList &p_changes) {
+    // Rules and tile patches are recorded as what they resolved to: one final value per node property
+    Array journal_changes;
+    for (const Change &change : p_changes.changes) {
+        Node *node = Object::cast_to<Node>(ObjectDB::get_instance(change.node));
+        if (!node || (node != p_root && !p_root->is_ancestor_of(node))) {
+            continue;
+        }
+
+        Dictionary entry;
+        entry["path"] = String(p_root->get_path_to(node));
+        entry["property"] = change.property;
+        entry["value"] = VariantUtilityFunctions::var_to_str(node->get(change.property));
+        journal_changes.push_back(entry);
+    }
+    return journal_changes;
+}
+
+String SceneModifier::_remap_path(const String &p_path, const Dictionary &p_remap) {
+    // The longest matching prefix wins, so "HUD" and "HUD/Health" can be mapped separately
+    String from;
+    Array keys = p_remap.keys();
+    for (int i = 0; i < keys.size(); i++) {
+        String key = keys[i];
+        if (key.length() > from.length() && (p_path == key || p_path.begins_with(key + "/"))) {
+            from = key;
+        }
+    }
+
+    if (from.is_empty()) {
+        return p_path;
+    }
+    return String(p_remap[from]) + p_path.substr(from.length());
+}
+
+void SceneModifier::_parse_replay(const Array &p_changes, const Dictionary &p_remap, LocalVector<ReplayChange> &r_changes) {
+    // Values are parsed once, however many scenes the changes are replayed on
+    r_changes.reserve(p_changes.size());
+    for (int i = 0; i < p_changes.size(); i++) {
+        if (p_changes[i].get_type() != Variant::DICTIONARY) {
+            continue;
+        }
+        Dictionary entry = p_changes[i];
+
+        ReplayChange change;
+        change.path = _remap_path(entry.get("path", "."), p_remap);
+        change.property = String(entry.get("property", ""));
+        change.value = VariantUtilityFunctions::str_to_var(entry.get("value", ""));
+        r_changes.push_back(change);
+    }
+}
+
+int SceneModifier::_replay(Node *p_root, const LocalVector<ReplayChange> &p_changes, ChangeList *r_changes, String &r_error) {
+    int applied = 0;
+    for (const ReplayChange &change : p_changes) {
+        Node *node = p_root->get_node_or_null(change.path);
+        if (!node) {
+            r_error = "Node not found: " + change.path;
+            continue;
+        }
+
+        bool valid = false;
+        Variant old_value = node->get(change.property, &valid);
+        if (!valid) {
+            r_error = "Property not found: " + String(change.property) + " in node " + change.path;
+            continue;
+        }
+
+        if (r_changes) {
+            _record_change(*r_changes, node, change.property, old_value);
+        }
+        node->set(change.property, change.value);
+        applied++;
+    }
+    return applied;
+}
+
+Dictionary SceneModifier::replay_changes(const Array &p_changes, const Dictionary &p_remap) {
+    Dictionary result;
+    result["success"] = false;
+    result["error"] = "";
+
+    Node *current_scene = EditorNode::get_singleton()->get_edited_scene();
+    if (!current_scene) {
+        result["error"] = "No scene is currently open in the editor.";
+        return result;
+    }
+
+    EditorUndoRedoManager *undo_redo = EditorUndoRedoManager::get_singleton();
+    if (!undo_redo) {
+        result["error"] = "Could not access the undo/redo manager.";
+        return result;
+    }
+
+    LocalVector<ReplayChange> changes;
+    _parse_replay(p_changes, p_remap, changes);
+
+    String error_message;
+    ChangeList recorded;
+    int applied = _replay(current_scene, changes, &recorded, error_message);
+    _commit_undo_action("Vector AI Replay", current_scene, recorded);
+
+    result["success"] = error_message.is_empty();
+    result["error"] = error_message;
+    result["applied"] = applied;
+    return result;
+}
+
+Dictionary SceneModifier::replay_changes_to(Node *p_root, const Array &p_changes, const Dictionary &p_remap) {
+    Dictionary result;
+    result["success"] = false;
+    result["error"] = "";
+
+    if (!p_root) {
+        result["error"] = "No scene root given.";
+        return result;
+    }
+
+    LocalVector<ReplayChange> changes;
+    _parse_replay(p_changes, p_remap, changes);
+
+    String error_message;
+    int applied = _replay(p_root, changes, nullptr, error_message);
+
+    result["success"] = error_message.is_empty();
+    result["error"] = error_message;
+    result["applied"] = applied;
+    return result;
+}
+
+Dictionary SceneModifier::replay_changes_to_scenes(const Array &p_changes, const PackedStringArray &p_scene_paths, const Dictionary &p_remap) {
+    LocalVector<ReplayChange> changes;
+    _parse_replay(p_changes, p_remap, changes);
+
+    Node *current_scene = EditorNode::get_singleton()->get_edited_scene();
+    String current_path = current_scene ? current_scene->get_scene_file_path() : String();
+
+    Array scenes;
+    int total_applied = 0;
+    bool success = true;
+    for (const String &scene_path : p_scene_paths) {
+        Dictionary scene_result;
+        scene_result["scene_path"] = scene_path;
+
+        String error_message;
+        int applied = 0;
+        if (scene_path == current_path) {
+            // The open scene is changed live and left for the user to save, with undo
+            ChangeList recorded;
+            applied = _replay(current_scene, changes, &recorded, error_message);
+
+            _commit_undo_action("Vector AI Replay", current_scene, recorded);
+        } else if (EditorNode::get_singleton()->is_scene_open(scene_path)) {
+            // Saving underneath an open tab would be overwritten by the tab's own state
+            error_message = "Scene is open in another tab; switch to it to replay there.";
+        } else {
+            Ref<PackedScene> packed_scene = ResourceLoader::load(scene_path, "PackedScene");
+            Node *root = packed_scene.is_valid() ? packed_scene->instantiate(PackedScene::GEN_EDIT_STATE_INSTANCE) : nullptr;
+            if (!root) {
+                error_message = "Failed to load scene.";
+            } else {
+                applied = _replay(root, changes, nullptr, error_message);
+                if (applied > 0) {
+                    Ref<PackedScene> saved_scene;
+                    saved_scene.instantiate();
+                    Error err = saved_scene->pack(root);
+                    if (err == OK) {
+                        err = ResourceSaver::save(saved_scene, scene_path);
+                    }
+                    if (err == OK) {
+                        EditorFileSystem::get_singleton()->update_file(scene_path);
+                    } else {
+                        error_message = vformat("Failed to save scene (error %d).", err);
+                    }
+                }
+                memdelete(root);
+            }
+        }
+
+        scene_result["applied"] = applied;
+        scene_result["error"] = error_message;
+        scenes.push_back(scene_result);
+
+        total_applied += applied;
+        success = success && error_message.is_empty();
+    }
+
+    Dictionary result;
     result["success"] = success;
+    result["applied"] = total_applied;
+    result["scenes"] = scenes;
+    return result;
+}
+
+bool SceneModifier::_accepts_value(const Variant &p_current, const Variant &p_value) {
+    Variant::Type current_type = p_current.get_type();
+    Variant::Type value_type = p_value.get_type();
+
+    // Unset properties take anything; resources can't be written as text
+    if (current_type == Variant::NIL || current_type == value_type) {
+        return true;
+    }
+    if (current_type == Variant::OBJECT) {
+        return false;
+    }
+    return Variant::can_convert_strict(value_type, current_type);
+}
+
+bool SceneModifier::_check_assignment(Node *p_node, const String &p_property, const String &p_value, String &r_error) {
+    if (p_property == "tile_rle" || p_property.begins_with("tile_rle/")) {
+        int layer = p_property.contains("/") ? p_property.get_slicec('/', 1).to_int() : -1;
+        if (TileGridCodec::get_tile_data_property(p_node, layer).is_empty()) {
+            r_error = "No tile layer for " + p_property + " in node " + String(p_node->get_name());
+            return false;
+        }
+        return true;
+    }
+
+    bool valid = false;
+    Variant current = p_node->get(p_property, &valid);
+    if (!valid) {
+        r_error = "Property not found: " + p_property + " in node " + String(p_node->get_name());
+        return false;
+    }
+
+    Variant value = _parse_value(p_value);
+    if (!_accepts_value(current, value)) {
+        r_error = "Cannot set " + p_property + " (" + Variant::get_type_name(current.get_type()) + ") to " + p_value;
+        return false;
+    }
+    return true;
+}
+
+bool SceneModifier::_check_modification(Node *p_root, Node *p_edited_root, const Dictionary &p_modification, String &r_error) {
+    if (!p_modification.has("node_path") || !p_modification.has("property_value")) {
+        r_error = "Incomplete modification";
+        return false;
+    }
+
+    String node_path = p_modification["node_path"];
+    String property_value = p_modification["property_value"];
+
+    bool is_rule = node_path.begins_with("@select");
+    LocalVector<Node *> nodes;
+    if (is_rule) {
+        Selector selector;
+        if (!_parse_selector(node_path, selector, r_error)) {
+            return false;
+        }
+        _select_nodes(p_root, p_edited_root, selector, nodes);
+        if (nodes.is_empty()) {
+            r_error = "No nodes match: " + node_path;
+            return false;
+        }
+    } else {
+        Node *node = p_root->get_node_or_null(node_path);
+        if (!node) {
+            r_error = "Node not found: " + node_path;
+            return false;
+        }
+        nodes.push_back(node);
+    }
+
+    // Same rule as applying: an assignment must fit at least one of the selected nodes
+    Vector<String> assignments;
+    if (is_rule) {
+        assignments = _split_assignments(property_value);
+    } else {
+        assignments.push_back(property_value);
+    }
+    for (int i = 0; i < assignments.size(); i++) {
+        Vector<String> parts = assignments[i].split("=", true, 1);
+        if (parts.size() < 2) {
+            r_error = "Invalid property format: " + assignments[i].strip_edges();
+            return false;
+        }
+
+        String property_name = parts[0].strip_edges();
+        String value_str = parts[1].strip_edges();
+        bool fits = false;
+        for (Node *node : nodes) {
+            if (_check_assignment(node, property_name, value_str, r_error)) {
+                fits = true;
+                break;
+            }
+        }
+        if (!fits) {
+            return false;
+        }
+    }
+
+    r_error = String();
+    return true;
+}
+
+Dictionary SceneModifier::validate_modifications(const Dictionary &p_modifications) {
+    // Dry run: every check _apply_modification makes, without touching the scene
+    Dictionary result;
+    Array errors;
+    int applicable = 0;
+    int failed = 0;
+
+    Node *current_scene = EditorNode::get_singleton()->get_edited_scene();
+    if (current_scene && p_modifications.has("list") && p_modifications["list"].get_type() == Variant::ARRAY) {
+        Array modifications = p_modifications["list"];
+        for (int i = 0; i < modifications.size(); i++) {
+            String error_message;
+            if (modifications[i].get_type() == Variant::DICTIONARY && _check_modification(current_scene, current_scene, modifications[i], error_message)) {
+                applicable++;
+            } else {
+                failed++;
+                errors.push_back(error_message);
+            }
+        }
+    }
+
+    result["applicable"] = applicable;
+    result["failed"] = failed;
+    result["errors"] = errors;
+    return result;
+}
+
+Dictionary SceneModifier::stage_modification(const Dictionary &p_modification) {
+    Dictionary result;
+    result["success"] = false;
+    result["error"] = "";
+
+    Node *current_scene = EditorNode::get_singleton()->get_edited_scene();
+    if (!current_scene) {
+        result["error"] = "No scene is currently open in the editor.";
+        return result;
+    }
+
+    // A batch belongs to one scene; switching tabs mid-stream would scatter it
+    if (staged_root.is_null()) {
+        staged_root = current_scene->get_instance_id();
+    } else if (staged_root != current_scene->get_instance_id()) {
+        result["error"] = "The edited scene changed while modifications were being applied.";
+        staged_error = result["error"];
+        return result;
+    }
+
+    String error_message;
+    if (_apply_modification(current_scene, current_scene, p_modification, &staged_changes, error_message)) {
+        staged_applied++;
+    } else if (!error_message.is_empty()) {
+        staged_error = error_message;
+    }
+
+    result["success"] = error_message.is_empty();
     result["error"] = error_message;
-    
+    return result;
+}
+
+Dictionary SceneModifier::commit_staged() {
+    Dictionary result;
+    result["success"] = staged_error.is_empty();
+    result["error"] = staged_error;
+    result["applied"] = staged_applied;
+
+    // The scene the batch was staged on, which may no longer be the edited one
+    Node *staged_scene = Object::cast_to<Node>(ObjectDB::get_instance(staged_root));
+    result["changes"] = staged_scene ? _make_journal_changes(staged_scene, staged_changes) : Array();
+    result["scene_path"] = staged_scene ? staged_scene->get_scene_file_path() : String();
+
+    // Everything is already applied, so the action is recorded without executing it again
+    if (staged_scene) {
+        _commit_undo_action("Vector AI Modifications", staged_scene, staged_changes);
+    }
+
+    staged_changes.clear();
+    staged_root = ObjectID();
+    staged_applied = 0;
+    staged_error = String();
+
+    return result;
+}
+
+void SceneModifier::set_spatial_index(const Ref<SceneSpatialIndex> &p_index) {
+    spatial_index = p_index;
+}
+
+void SceneModifier::set_undo_memory_cap(int64_t p_bytes) {
+    undo_payloads.set_memory_cap(p_bytes);
+
+    LocalVector<int> released;
+    undo_payloads.evict(released);
+    _release_payload_groups(released);
+}
+
+Dictionary SceneModifier::get_undo_stats() const {
+    return undo_payloads.get_stats();
+}
+
+int SceneModifier::get_staged_count() const {
+    return staged_applied;
+}
+
+Dictionary SceneModifier::create_node(const String &p_parent_path, const String &p_type, const String &p_name, const Dictionary &p_properties, const Dictionary &p_typed_properties) {
+    Dictionary result;
+    result["success"] = false;
+    result["error"] = "";
+
+    Node *current_scene = EditorNode::get_singleton()->get_edited_scene();
+    if (!current_scene) {
+        result["error"] = "No scene is currently open in the editor.";
+        return result;
+    }
+
+    // "root" and "root/..." follow the godot-mcp convention for the scene root
+    String parent_path = p_parent_path;
+    if (parent_path == "root" || parent_path == ".") {
+        parent_path = "";
+    } else if (parent_path.begins_with("root/")) {
+        parent_path = parent_path.substr(5);
+    }
+
+    Node *parent = parent_path.is_empty() ? current_scene : current_scene->get_node_or_null(parent_path);
+    if (!parent) {
+        result["error"] = "Parent node not found: " + p_parent_path;
+        return result;
+    }
+
+    if (!ClassDB::can_instantiate(p_type) || !ClassDB::is_parent_class(p_type, "Node")) {
+        result["error"] = "Not an instantiable node type: " + p_type;
+        return result;
+    }
+
+    Node *node = Object::cast_to<Node>(ClassDB::instantiate(p_type));
+    node->set_name(p_name);
+
+    // Plain properties are set as given, so a string that looks like a number stays a string
+    for (const KeyValue<Variant, Variant> &E : p_properties) {
+        node->set(E.key, E.value);
+    }
+
+    // Typed properties are text in the same notation as model modifications
+    for (const KeyValue<Variant, Variant> &E : p_typed_properties) {
+        node->set(E.key, _parse_value(E.value));
+    }
+
+    EditorUndoRedoManager *undo_redo = EditorUndoRedoManager::get_singleton();
+    undo_redo->create_action("Vector AI: Create Node");
+    undo_redo->add_do_method(parent, "add_child", node, true);
+    undo_redo->add_do_method(node, "set_owner", current_scene);
+    undo_redo->add_do_reference(node);
+    undo_redo->add_undo_method(parent, "remove_child", node);
+    undo_redo->commit_action();
+
+    result["success"] = true;
+    result["path"] = String(current_scene->get_path_to(node));
     return result;
 }
 
 Variant SceneModifier::_parse_value(const String &p_value_str) {
+    // Run-length integer grid, as printed in the scene context
+    if (p_value_str.begins_with("Grid(")) {
+        Array rows;
+        if (TileGridCodec::decode_grid(p_value_str, rows)) {
+            return rows;
+        }
+    }
+
     // Try to parse as a number
     if (p_value_str.is_valid_float()) {
         return p_value_str.to_float();
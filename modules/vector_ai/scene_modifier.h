@@ -30,19 +30,115 @@
 
 #pragma once
 
+#include "core/math/aabb.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/hash_set.h"
+#include "core/templates/local_vector.h"
 #include "scene/main/node.h"
+#include "scene_spatial_index.h"
+#include "undo_payload_store.h"
+
+class EditorUndoRedoManager;
 
 class SceneModifier : public Node {
     GDCLASS(SceneModifier, Node);
 
 private:
+    // A property changed by a modification and its value before the first change
+    struct Change {
+        ObjectID node;
+        StringName property;
+        Variant old_value;
+    };
+
+    // Changes in the order they were made; only the first original value of each property is kept
+    struct ChangeList {
+        LocalVector<Change> changes;
+        HashMap<ObjectID, HashSet<StringName>> recorded;
+
+        bool is_empty() const { return changes.is_empty(); }
+        void clear() {
+            changes.clear();
+            recorded.clear();
+        }
+    };
+
+    // Rule-style modification: "@select class=... group=... name=... under=... region=(...)"
+    struct Selector {
+        StringName class_name;
+        StringName group;
+        String name_pattern;
+        String under;
+        bool has_region = false;
+        bool region_is_3d = false;
+        AABB region;
+    };
+
+    // Journal change resolved for replay: remapped path and parsed value
+    struct ReplayChange {
+        String path;
+        StringName property;
+        Variant value;
+    };
+
+    // Modifications applied one by one as a response streams in, committed as one undo action
+    ChangeList staged_changes;
+    ObjectID staged_root;
+    int staged_applied = 0;
+    String staged_error;
+
+    // Spatial index of the edited scene, used by region selectors
+    Ref<SceneSpatialIndex> spatial_index;
+
+    // Deltas of large array edits, replayed by the undo history through _restore_payload,
+    // with the undo history each action's group of deltas was added to
+    UndoPayloadStore undo_payloads;
+    HashMap<int, int> payload_histories;
+
     Variant _parse_value(const String &p_value_str);
+    static void _record_change(ChangeList &r_changes, Node *p_node, const StringName &p_property, const Variant &p_old_value);
+    void _commit_undo_action(const String &p_name, Object *p_context, const ChangeList &p_changes);
+    void _restore_payload(Object *p_node, const StringName &p_property, int p_id, bool p_undo);
+    void _release_payload_groups(const LocalVector<int> &p_groups);
+    void _prune_payloads();
+    static bool _parse_selector(const String &p_text, Selector &r_selector, String &r_error);
+    static Vector<String> _split_assignments(const String &p_assignments);
+    void _select_nodes(Node *p_root, Node *p_edited_root, const Selector &p_selector, LocalVector<Node *> &r_nodes);
+    bool _apply_rule(Node *p_root, Node *p_edited_root, const String &p_selector, const String &p_assignments, ChangeList *r_changes, String &r_error);
+    bool _apply_modification(Node *p_root, Node *p_edited_root, const Dictionary &p_modification, ChangeList *r_changes, String &r_error);
+    int _apply_list(Node *p_root, Node *p_edited_root, const Dictionary &p_modifications, ChangeList *r_changes, String &r_error);
+    static Array _make_journal_changes(Node *p_root, const ChangeList &p_changes);
+    static String _remap_path(const String &p_path, const Dictionary &p_remap);
+    static void _parse_replay(const Array &p_changes, const Dictionary &p_remap, LocalVector<ReplayChange> &r_changes);
+    int _replay(Node *p_root, const LocalVector<ReplayChange> &p_changes, ChangeList *r_changes, String &r_error);
+    static bool _accepts_value(const Variant &p_current, const Variant &p_value);
+    bool _check_assignment(Node *p_node, const String &p_property, const String &p_value, String &r_error);
+    bool _check_modification(Node *p_root, Node *p_edited_root, const Dictionary &p_modification, String &r_error);
 
 protected:
+    void _notification(int p_what);
     static void _bind_methods();
 
 public:
     Dictionary apply_modifications(const Dictionary &p_modifications);
+    Dictionary apply_modifications_to(Node *p_root, const Dictionary &p_modifications);
+    Dictionary validate_modifications(const Dictionary &p_modifications);
+
+    // Journal replay: the edited scene (one undo action), a scene root, or scene files on disk
+    Dictionary replay_changes(const Array &p_changes, const Dictionary &p_remap);
+    Dictionary replay_changes_to(Node *p_root, const Array &p_changes, const Dictionary &p_remap);
+    Dictionary replay_changes_to_scenes(const Array &p_changes, const PackedStringArray &p_scene_paths, const Dictionary &p_remap);
+
+    Dictionary create_node(const String &p_parent_path, const String &p_type, const String &p_name, const Dictionary &p_properties, const Dictionary &p_typed_properties = Dictionary());
+
+    void set_spatial_index(const Ref<SceneSpatialIndex> &p_index);
+
+    void set_undo_memory_cap(int64_t p_bytes);
+    Dictionary get_undo_stats() const;
+
+    Dictionary stage_modification(const Dictionary &p_modification);
+    Dictionary commit_staged();
+    int get_staged_count() const;
 
     SceneModifier();
     ~SceneModifier();
@@ -0,0 +1,647 @@
+/**************************************************************************/
+/*  scene_spatial_index.cpp                                               */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "scene_spatial_index.h"
+
+#include "core/object/object_db.h"
+#include "core/templates/pair.h"
+#include "editor/editor_undo_redo_manager.h"
+#include "scene/2d/node_2d.h"
+#include "scene/3d/visual_instance_3d.h"
+#include "scene/gui/control.h"
+#include "scene/main/scene_tree.h"
+#include "scene/scene_string_names.h"
+
+bool SceneSpatialTree::_overlaps(const AABB &p_a, const AABB &p_b) {
+    // Inclusive on all axes so flat 2D bounds and points still match
+    Vector3 a_end = p_a.position + p_a.size;
+    Vector3 b_end = p_b.position + p_b.size;
+    return p_a.position.x <= b_end.x && p_b.position.x <= a_end.x &&
+            p_a.position.y <= b_end.y && p_b.position.y <= a_end.y &&
+            p_a.position.z <= b_end.z && p_b.position.z <= a_end.z;
+}
+
+bool SceneSpatialTree::_contains(const AABB &p_outer, const AABB &p_inner) {
+    Vector3 outer_end = p_outer.position + p_outer.size;
+    Vector3 inner_end = p_inner.position + p_inner.size;
+    return p_inner.position.x >= p_outer.position.x && inner_end.x <= outer_end.x &&
+            p_inner.position.y >= p_outer.position.y && inner_end.y <= outer_end.y &&
+            p_inner.position.z >= p_outer.position.z && inner_end.z <= outer_end.z;
+}
+
+real_t SceneSpatialTree::distance_to(const AABB &p_bounds, const Vector3 &p_point) {
+    Vector3 end = p_bounds.position + p_bounds.size;
+    Vector3 closest(CLAMP(p_point.x, p_bounds.position.x, end.x), CLAMP(p_point.y, p_bounds.position.y, end.y), CLAMP(p_point.z, p_bounds.position.z, end.z));
+    return closest.distance_to(p_point);
+}
+
+AABB SceneSpatialTree::_get_child_bounds(const AABB &p_parent, int p_child) const {
+    AABB child = p_parent;
+    child.size.x *= 0.5;
+    child.size.y *= 0.5;
+    if (p_child & 1) {
+        child.position.x += child.size.x;
+    }
+    if (p_child & 2) {
+        child.position.y += child.size.y;
+    }
+
+    // Quadtree cells keep the full depth of their parent
+    if (child_count == 8) {
+        child.size.z *= 0.5;
+        if (p_child & 4) {
+            child.position.z += child.size.z;
+        }
+    }
+
+    return child;
+}
+
+void SceneSpatialTree::_split(int p_cell) {
+    int first_child = cells.size();
+    AABB parent_bounds = cells[p_cell].bounds;
+    int child_depth = cells[p_cell].depth + 1;
+
+    for (int i = 0; i < child_count; i++) {
+        Cell child;
+        child.bounds = _get_child_bounds(parent_bounds, i);
+        child.depth = child_depth;
+        cells.push_back(child);
+    }
+
+    cells[p_cell].first_child = first_child;
+}
+
+int SceneSpatialTree::_find_cell(const AABB &p_bounds) {
+    // Bounds outside the root stay in the root cell
+    if (!_contains(cells[0].bounds, p_bounds)) {
+        return 0;
+    }
+
+    int cell = 0;
+    while (cells[cell].depth < MAX_DEPTH) {
+        if (cells[cell].first_child == -1) {
+            if ((int)cells[cell].items.size() < SPLIT_THRESHOLD) {
+                break;
+            }
+            _split(cell);
+        }
+
+        int next = -1;
+        for (int i = 0; i < child_count; i++) {
+            int child = cells[cell].first_child + i;
+            if (_contains(cells[child].bounds, p_bounds)) {
+                next = child;
+                break;
+            }
+        }
+
+        // Items straddling child borders stay at this level
+        if (next == -1) {
+            break;
+        }
+        cell = next;
+    }
+
+    return cell;
+}
+
+void SceneSpatialTree::_query(int p_cell, const AABB &p_bounds, LocalVector<ObjectID> &r_result) const {
+    const Cell &cell = cells[p_cell];
+
+    // The root also holds bounds outside of it, so it is always visited
+    if (p_cell != 0 && !_overlaps(cell.bounds, p_bounds)) {
+        return;
+    }
+
+    for (const ObjectID &id : cell.items) {
+        const Item *item = items.getptr(id);
+        if (item && _overlaps(item->bounds, p_bounds)) {
+            r_result.push_back(id);
+        }
+    }
+
+    if (cell.first_child != -1) {
+        for (int i = 0; i < child_count; i++) {
+            _query(cell.first_child + i, p_bounds, r_result);
+        }
+    }
+}
+
+void SceneSpatialTree::reset(const AABB &p_root_bounds, bool p_is_3d) {
+    child_count = p_is_3d ? 8 : 4;
+    cells.clear();
+    items.clear();
+    content_bounds = AABB();
+
+    Cell root;
+    root.bounds = p_root_bounds;
+    cells.push_back(root);
+}
+
+void SceneSpatialTree::insert(ObjectID p_id, const AABB &p_bounds) {
+    ERR_FAIL_COND(cells.is_empty());
+
+    if (items.has(p_id)) {
+        remove(p_id);
+    }
+
+    int cell = _find_cell(p_bounds);
+    cells[cell].items.push_back(p_id);
+
+    Item item;
+    item.bounds = p_bounds;
+    item.cell = cell;
+    items.insert(p_id, item);
+
+    content_bounds = items.size() == 1 ? p_bounds : content_bounds.merge(p_bounds);
+}
+
+void SceneSpatialTree::remove(ObjectID p_id) {
+    const Item *item = items.getptr(p_id);
+    if (!item) {
+        return;
+    }
+
+    LocalVector<ObjectID> &cell_items = cells[item->cell].items;
+    int64_t index = cell_items.find(p_id);
+    if (index >= 0) {
+        cell_items.remove_at_unordered(index);
+    }
+
+    items.erase(p_id);
+}
+
+void SceneSpatialTree::update(ObjectID p_id, const AABB &p_bounds) {
+    const Item *item = items.getptr(p_id);
+    if (item && item->bounds == p_bounds) {
+        return;
+    }
+
+    insert(p_id, p_bounds);
+}
+
+bool SceneSpatialTree::has(ObjectID p_id) const {
+    return items.has(p_id);
+}
+
+const AABB *SceneSpatialTree::get_bounds(ObjectID p_id) const {
+    const Item *item = items.getptr(p_id);
+    return item ? &item->bounds : nullptr;
+}
+
+AABB SceneSpatialTree::get_root_bounds() const {
+    return cells.is_empty() ? AABB() : cells[0].bounds;
+}
+
+void SceneSpatialTree::query_aabb(const AABB &p_bounds, LocalVector<ObjectID> &r_result) const {
+    if (!cells.is_empty()) {
+        _query(0, p_bounds, r_result);
+    }
+}
+
+void SceneSpatialTree::query_radius(const Vector3 &p_center, real_t p_radius, LocalVector<ObjectID> &r_result) const {
+    LocalVector<ObjectID> candidates;
+    query_aabb(AABB(p_center - Vector3(p_radius, p_radius, p_radius), Vector3(p_radius, p_radius, p_radius) * 2.0), candidates);
+
+    for (const ObjectID &id : candidates) {
+        if (distance_to(items[id].bounds, p_center) <= p_radius) {
+            r_result.push_back(id);
+        }
+    }
+}
+
+void SceneSpatialTree::query_nearest(const Vector3 &p_point, int p_count, LocalVector<ObjectID> &r_result) const {
+    if (items.is_empty() || p_count <= 0) {
+        return;
+    }
+
+    struct DistanceSort {
+        bool operator()(const Pair<real_t, ObjectID> &p_a, const Pair<real_t, ObjectID> &p_b) const {
+            return p_a.first < p_b.first;
+        }
+    };
+
+    // Grow a radius query until it holds enough items; everything within the
+    // radius is found, so the closest of them are the nearest overall
+    real_t max_radius = distance_to(content_bounds, p_point) + content_bounds.size.length();
+    real_t radius = MAX(content_bounds.size.length() / 256.0, (real_t)1.0);
+
+    LocalVector<ObjectID> found;
+    while (true) {
+        found.clear();
+        query_radius(p_point, radius, found);
+        if ((int)found.size() >= p_count || radius >= max_radius) {
+            break;
+        }
+        radius *= 2.0;
+    }
+
+    LocalVector<Pair<real_t, ObjectID>> sorted;
+    for (const ObjectID &id : found) {
+        sorted.push_back(Pair<real_t, ObjectID>(distance_to(items[id].bounds, p_point), id));
+    }
+    sorted.sort_custom<DistanceSort>();
+
+    for (uint32_t i = 0; i < sorted.size() && (int)i < p_count; i++) {
+        r_result.push_back(sorted[i].second);
+    }
+}
+
+void SceneSpatialIndex::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("rebuild"), &SceneSpatialIndex::rebuild);
+    ClassDB::bind_method(D_METHOD("mark_dirty"), &SceneSpatialIndex::mark_dirty);
+    ClassDB::bind_method(D_METHOD("query_rect", "rect"), &SceneSpatialIndex::query_rect);
+    ClassDB::bind_method(D_METHOD("query_radius", "center", "radius"), &SceneSpatialIndex::query_radius);
+    ClassDB::bind_method(D_METHOD("query_nearest", "point", "count"), &SceneSpatialIndex::query_nearest);
+    ClassDB::bind_method(D_METHOD("query_aabb", "aabb"), &SceneSpatialIndex::query_aabb);
+    ClassDB::bind_method(D_METHOD("query_radius_3d", "center", "radius"), &SceneSpatialIndex::query_radius_3d);
+    ClassDB::bind_method(D_METHOD("query_nearest_3d", "point", "count"), &SceneSpatialIndex::query_nearest_3d);
+    ClassDB::bind_method(D_METHOD("get_node_count_2d"), &SceneSpatialIndex::get_node_count_2d);
+    ClassDB::bind_method(D_METHOD("get_node_count_3d"), &SceneSpatialIndex::get_node_count_3d);
+}
+
+Node *SceneSpatialIndex::_get_root() const {
+    return Object::cast_to<Node>(ObjectDB::get_instance(root_id));
+}
+
+bool SceneSpatialIndex::_get_node_bounds(Node *p_node, AABB &r_bounds, bool &r_is_3d) {
+    if (Control *control = Object::cast_to<Control>(p_node)) {
+        Rect2 rect = control->get_global_rect();
+        r_bounds = AABB(Vector3(rect.position.x, rect.position.y, 0), Vector3(rect.size.x, rect.size.y, 0));
+        r_is_3d = false;
+        return true;
+    }
+
+    if (Node2D *node_2d = Object::cast_to<Node2D>(p_node)) {
+        Rect2 rect;
+        if (node_2d->_edit_use_rect()) {
+            rect = node_2d->get_global_transform().xform(node_2d->_edit_get_rect());
+        } else {
+            rect = Rect2(node_2d->get_global_position(), Size2());
+        }
+        r_bounds = AABB(Vector3(rect.position.x, rect.position.y, 0), Vector3(rect.size.x, rect.size.y, 0));
+        r_is_3d = false;
+        return true;
+    }
+
+    if (Node3D *node_3d = Object::cast_to<Node3D>(p_node)) {
+        if (VisualInstance3D *visual = Object::cast_to<VisualInstance3D>(p_node)) {
+            r_bounds = visual->get_global_transform().xform(visual->get_aabb());
+        } else {
+            r_bounds = AABB(node_3d->get_global_position(), Vector3());
+        }
+        r_is_3d = true;
+        return true;
+    }
+
+    return false;
+}
+
+void SceneSpatialIndex::_insert_node(Node *p_node) {
+    AABB bounds;
+    bool is_3d = false;
+    if (!_get_node_bounds(p_node, bounds, is_3d)) {
+        return;
+    }
+
+    if (is_3d) {
+        tree_3d.insert(p_node->get_instance_id(), bounds);
+        return;
+    }
+
+    tree_2d.insert(p_node->get_instance_id(), bounds);
+
+    // Containers resize children without going through undo/redo
+    Callable rect_changed = callable_mp(this, &SceneSpatialIndex::_on_item_rect_changed).bind(p_node->get_instance_id());
+    if (!p_node->is_connected(SceneStringName(item_rect_changed), rect_changed)) {
+        p_node->connect(SceneStringName(item_rect_changed), rect_changed);
+    }
+}
+
+void SceneSpatialIndex::_remove_node(Node *p_node) {
+    ObjectID id = p_node->get_instance_id();
+    if (tree_2d.has(id)) {
+        Callable rect_changed = callable_mp(this, &SceneSpatialIndex::_on_item_rect_changed).bind(id);
+        if (p_node->is_connected(SceneStringName(item_rect_changed), rect_changed)) {
+            p_node->disconnect(SceneStringName(item_rect_changed), rect_changed);
+        }
+    }
+    tree_2d.remove(id);
+    tree_3d.remove(id);
+    dirty_nodes.erase(id);
+}
+
+void SceneSpatialIndex::_refresh_node(Node *p_node) {
+    AABB bounds;
+    bool is_3d = false;
+    if (!_get_node_bounds(p_node, bounds, is_3d)) {
+        return;
+    }
+
+    if (is_3d) {
+        tree_3d.update(p_node->get_instance_id(), bounds);
+    } else {
+        tree_2d.update(p_node->get_instance_id(), bounds);
+    }
+}
+
+void SceneSpatialIndex::_sync() {
+    // Individually dirtied nodes are cheap to refresh
+    for (const ObjectID &id : dirty_nodes) {
+        Node *node = Object::cast_to<Node>(ObjectDB::get_instance(id));
+        if (node) {
+            _refresh_node(node);
+        }
+    }
+    dirty_nodes.clear();
+
+    if (!needs_sync) {
+        return;
+    }
+    needs_sync = false;
+
+    // Re-read transforms after an undoable edit; only moved nodes are reinserted
+    LocalVector<ObjectID> tracked;
+    tree_2d.for_each([&tracked](ObjectID p_id, const AABB &p_bounds) { tracked.push_back(p_id); });
+    tree_3d.for_each([&tracked](ObjectID p_id, const AABB &p_bounds) { tracked.push_back(p_id); });
+
+    for (const ObjectID &id : tracked) {
+        Node *node = Object::cast_to<Node>(ObjectDB::get_instance(id));
+        if (node) {
+            _refresh_node(node);
+        } else {
+            tree_2d.remove(id);
+            tree_3d.remove(id);
+        }
+    }
+
+    // Too much has drifted outside the root bounds to stay efficient
+    if ((tree_2d.size() > 64 && tree_2d.get_root_item_count() * 4 > tree_2d.size()) ||
+            (tree_3d.size() > 64 && tree_3d.get_root_item_count() * 4 > tree_3d.size())) {
+        rebuild();
+    }
+}
+
+void SceneSpatialIndex::_connect_signals() {
+    SceneTree *tree = SceneTree::get_singleton();
+    if (tree) {
+        tree->connect("node_added", callable_mp(this, &SceneSpatialIndex::_on_node_added));
+        tree->connect("node_removed", callable_mp(this, &SceneSpatialIndex::_on_node_removed));
+    }
+
+    EditorUndoRedoManager *undo_redo = EditorUndoRedoManager::get_singleton();
+    if (undo_redo) {
+        undo_redo->connect("version_changed", callable_mp(this, &SceneSpatialIndex::_on_version_changed));
+    }
+}
+
+void SceneSpatialIndex::_disconnect_signals() {
+    SceneTree *tree = SceneTree::get_singleton();
+    if (tree) {
+        if (tree->is_connected("node_added", callable_mp(this, &SceneSpatialIndex::_on_node_added))) {
+            tree->disconnect("node_added", callable_mp(this, &SceneSpatialIndex::_on_node_added));
+        }
+        if (tree->is_connected("node_removed", callable_mp(this, &SceneSpatialIndex::_on_node_removed))) {
+            tree->disconnect("node_removed", callable_mp(this, &SceneSpatialIndex::_on_node_removed));
+        }
+    }
+
+    EditorUndoRedoManager *undo_redo = EditorUndoRedoManager::get_singleton();
+    if (undo_redo && undo_redo->is_connected("version_changed", callable_mp(this, &SceneSpatialIndex::_on_version_changed))) {
+        undo_redo->disconnect("version_changed", callable_mp(this, &SceneSpatialIndex::_on_version_changed));
+    }
+}
+
+Array SceneSpatialIndex::_to_nodes(const LocalVector<ObjectID> &p_ids) const {
+    Array nodes;
+    for (const ObjectID &id : p_ids) {
+        Node *node = Object::cast_to<Node>(ObjectDB::get_instance(id));
+        if (node) {
+            nodes.push_back(node);
+        }
+    }
+    return nodes;
+}
+
+void SceneSpatialIndex::_on_node_added(Node *p_node) {
+    Node *root = _get_root();
+    if (root && root->is_ancestor_of(p_node)) {
+        _insert_node(p_node);
+    }
+}
+
+void SceneSpatialIndex::_on_node_removed(Node *p_node) {
+    if (p_node->get_instance_id() == root_id) {
+        tree_2d.reset(AABB(), false);
+        tree_3d.reset(AABB(), true);
+        return;
+    }
+
+    _remove_node(p_node);
+}
+
+void SceneSpatialIndex::_on_item_rect_changed(ObjectID p_id) {
+    dirty_nodes.insert(p_id);
+}
+
+void SceneSpatialIndex::_on_version_changed() {
+    needs_sync = true;
+}
+
+void SceneSpatialIndex::attach(Node *p_root) {
+    ERR_FAIL_NULL(p_root);
+    if (is_attached_to(p_root)) {
+        return;
+    }
+
+    detach();
+    root_id = p_root->get_instance_id();
+    rebuild();
+    _connect_signals();
+}
+
+void SceneSpatialIndex::detach() {
+    if (root_id.is_valid()) {
+        _disconnect_signals();
+
+        LocalVector<ObjectID> tracked;
+        tree_2d.for_each([&tracked](ObjectID p_id, const AABB &p_bounds) { tracked.push_back(p_id); });
+        for (const ObjectID &id : tracked) {
+            Node *node = Object::cast_to<Node>(ObjectDB::get_instance(id));
+            if (node) {
+                _remove_node(node);
+            }
+        }
+    }
+
+    root_id = ObjectID();
+    tree_2d.reset(AABB(), false);
+    tree_3d.reset(AABB(), true);
+    dirty_nodes.clear();
+    needs_sync = false;
+}
+
+bool SceneSpatialIndex::is_attached_to(Node *p_root) const {
+    return p_root && root_id == p_root->get_instance_id();
+}
+
+void SceneSpatialIndex::rebuild() {
+    Node *root = _get_root();
+    if (!root) {
+        return;
+    }
+
+    // Gather bounds first so the root cells fit the scene
+    LocalVector<Pair<ObjectID, AABB>> nodes_2d;
+    LocalVector<Pair<ObjectID, AABB>> nodes_3d;
+    AABB bounds_2d;
+    AABB bounds_3d;
+
+    List<Node *> stack;
+    stack.push_back(root);
+    while (!stack.is_empty()) {
+        Node *node = stack.back()->get();
+        stack.pop_back();
+
+        AABB bounds;
+        bool is_3d = false;
+        if (_get_node_bounds(node, bounds, is_3d)) {
+            if (is_3d) {
+                bounds_3d = nodes_3d.is_empty() ? bounds : bounds_3d.merge(bounds);
+                nodes_3d.push_back(Pair<ObjectID, AABB>(node->get_instance_id(), bounds));
+            } else {
+                bounds_2d = nodes_2d.is_empty() ? bounds : bounds_2d.merge(bounds);
+                nodes_2d.push_back(Pair<ObjectID, AABB>(node->get_instance_id(), bounds));
+            }
+        }
+
+        for (int i = 0; i < node->get_child_count(); i++) {
+            stack.push_back(node->get_child(i));
+        }
+    }
+
+    // Leave room around the content so nodes can move without leaving the root
+    AABB root_2d = bounds_2d.grow(MAX(bounds_2d.get_longest_axis_size(), (real_t)1024.0));
+    root_2d.position.z = -1.0;
+    root_2d.size.z = 2.0;
+    AABB root_3d = bounds_3d.grow(MAX(bounds_3d.get_longest_axis_size(), (real_t)64.0));
+
+    LocalVector<ObjectID> tracked;
+    tree_2d.for_each([&tracked](ObjectID p_id, const AABB &p_bounds) { tracked.push_back(p_id); });
+    for (const ObjectID &id : tracked) {
+        Node *node = Object::cast_to<Node>(ObjectDB::get_instance(id));
+        if (node) {
+            _remove_node(node);
+        }
+    }
+
+    tree_2d.reset(root_2d, false);
+    tree_3d.reset(root_3d, true);
+
+    for (const Pair<ObjectID, AABB> &E : nodes_2d) {
+        _insert_node(Object::cast_to<Node>(ObjectDB::get_instance(E.first)));
+    }
+    for (const Pair<ObjectID, AABB> &E : nodes_3d) {
+        tree_3d.insert(E.first, E.second);
+    }
+
+    dirty_nodes.clear();
+    needs_sync = false;
+}
+
+void SceneSpatialIndex::mark_dirty() {
+    needs_sync = true;
+}
+
+Array SceneSpatialIndex::query_rect(const Rect2 &p_rect) {
+    _sync();
+
+    LocalVector<ObjectID> result;
+    tree_2d.query_aabb(AABB(Vector3(p_rect.position.x, p_rect.position.y, 0), Vector3(p_rect.size.x, p_rect.size.y, 0)), result);
+    return _to_nodes(result);
+}
+
+Array SceneSpatialIndex::query_radius(const Vector2 &p_center, real_t p_radius) {
+    _sync();
+
+    LocalVector<ObjectID> result;
+    tree_2d.query_radius(Vector3(p_center.x, p_center.y, 0), p_radius, result);
+    return _to_nodes(result);
+}
+
+Array SceneSpatialIndex::query_nearest(const Vector2 &p_point, int p_count) {
+    _sync();
+
+    LocalVector<ObjectID> result;
+    tree_2d.query_nearest(Vector3(p_point.x, p_point.y, 0), p_count, result);
+    return _to_nodes(result);
+}
+
+Array SceneSpatialIndex::query_aabb(const AABB &p_aabb) {
+    _sync();
+
+    LocalVector<ObjectID> result;
+    tree_3d.query_aabb(p_aabb, result);
+    return _to_nodes(result);
+}
+
+Array SceneSpatialIndex::query_radius_3d(const Vector3 &p_center, real_t p_radius) {
+    _sync();
+
+    LocalVector<ObjectID> result;
+    tree_3d.query_radius(p_center, p_radius, result);
+    return _to_nodes(result);
+}
+
+Array SceneSpatialIndex::query_nearest_3d(const Vector3 &p_point, int p_count) {
+    _sync();
+
+    LocalVector<ObjectID> result;
+    tree_3d.query_nearest(p_point, p_count, result);
+    return _to_nodes(result);
+}
+
+int SceneSpatialIndex::get_node_count_2d() const {
+    return tree_2d.size();
+}
+
+int SceneSpatialIndex::get_node_count_3d() const {
+    return tree_3d.size();
+}
+
+SceneSpatialIndex::SceneSpatialIndex() {
+    tree_2d.reset(AABB(), false);
+    tree_3d.reset(AABB(), true);
+}
+
+SceneSpatialIndex::~SceneSpatialIndex() {
+    detach();
+}
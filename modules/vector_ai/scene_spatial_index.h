@@ -0,0 +1,144 @@
+/**************************************************************************/
+/*  scene_spatial_index.h                                                 */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/math/aabb.h"
+#include "core/object/ref_counted.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/hash_set.h"
+#include "core/templates/local_vector.h"
+#include "scene/main/node.h"
+
+// Loose quadtree (2D) or octree (3D) over node bounds.
+// 2D bounds are stored as flat AABBs with z = 0.
+class SceneSpatialTree {
+    static const int MAX_DEPTH = 16;
+    static const int SPLIT_THRESHOLD = 8;
+
+    struct Cell {
+        AABB bounds;
+        int first_child = -1;
+        int depth = 0;
+        LocalVector<ObjectID> items;
+    };
+
+    struct Item {
+        AABB bounds;
+        int cell = -1;
+    };
+
+    int child_count = 4;
+    LocalVector<Cell> cells;
+    HashMap<ObjectID, Item> items;
+    AABB content_bounds;
+
+    static bool _overlaps(const AABB &p_a, const AABB &p_b);
+    static bool _contains(const AABB &p_outer, const AABB &p_inner);
+    AABB _get_child_bounds(const AABB &p_parent, int p_child) const;
+    void _split(int p_cell);
+    int _find_cell(const AABB &p_bounds);
+    void _query(int p_cell, const AABB &p_bounds, LocalVector<ObjectID> &r_result) const;
+
+public:
+    static real_t distance_to(const AABB &p_bounds, const Vector3 &p_point);
+
+    void reset(const AABB &p_root_bounds, bool p_is_3d);
+    void insert(ObjectID p_id, const AABB &p_bounds);
+    void remove(ObjectID p_id);
+    void update(ObjectID p_id, const AABB &p_bounds);
+    bool has(ObjectID p_id) const;
+    const AABB *get_bounds(ObjectID p_id) const;
+
+    void query_aabb(const AABB &p_bounds, LocalVector<ObjectID> &r_result) const;
+    void query_radius(const Vector3 &p_center, real_t p_radius, LocalVector<ObjectID> &r_result) const;
+    void query_nearest(const Vector3 &p_point, int p_count, LocalVector<ObjectID> &r_result) const;
+
+    int size() const { return items.size(); }
+    int get_root_item_count() const { return cells.is_empty() ? 0 : cells[0].items.size(); }
+    AABB get_root_bounds() const;
+    template <typename F>
+    void for_each(F p_func) const {
+        for (const KeyValue<ObjectID, Item> &E : items) {
+            p_func(E.key, E.value.bounds);
+        }
+    }
+};
+
+class SceneSpatialIndex : public RefCounted {
+    GDCLASS(SceneSpatialIndex, RefCounted);
+
+private:
+    ObjectID root_id;
+    SceneSpatialTree tree_2d;
+    SceneSpatialTree tree_3d;
+
+    // Set by undo/redo and rect changes; the next query re-reads transforms
+    bool needs_sync = false;
+    HashSet<ObjectID> dirty_nodes;
+
+    Node *_get_root() const;
+    static bool _get_node_bounds(Node *p_node, AABB &r_bounds, bool &r_is_3d);
+    void _insert_node(Node *p_node);
+    void _remove_node(Node *p_node);
+    void _refresh_node(Node *p_node);
+    void _sync();
+    void _connect_signals();
+    void _disconnect_signals();
+    Array _to_nodes(const LocalVector<ObjectID> &p_ids) const;
+
+    void _on_node_added(Node *p_node);
+    void _on_node_removed(Node *p_node);
+    void _on_item_rect_changed(ObjectID p_id);
+    void _on_version_changed();
+
+protected:
+    static void _bind_methods();
+
+public:
+    void attach(Node *p_root);
+    void detach();
+    bool is_attached_to(Node *p_root) const;
+    void rebuild();
+    void mark_dirty();
+
+    Array query_rect(const Rect2 &p_rect);
+    Array query_radius(const Vector2 &p_center, real_t p_radius);
+    Array query_nearest(const Vector2 &p_point, int p_count);
+    Array query_aabb(const AABB &p_aabb);
+    Array query_radius_3d(const Vector3 &p_center, real_t p_radius);
+    Array query_nearest_3d(const Vector3 &p_point, int p_count);
+
+    int get_node_count_2d() const;
+    int get_node_count_3d() const;
+
+    SceneSpatialIndex();
+    ~SceneSpatialIndex();
+};
@@ -0,0 +1,321 @@
+/**************************************************************************/
+/*  script_summary_cache.cpp                                              */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "script_summary_cache.h"
+
+#include "core/io/file_access.h"
+#include "core/io/json.h"
+#include "core/io/resource_loader.h"
+#include "core/object/script_language.h"
+#include "editor/editor_paths.h"
+#include "modules/modules_enabled.gen.h" // For gdscript.
+
+#ifdef MODULE_GDSCRIPT_ENABLED
+#include "modules/gdscript/gdscript_parser.h"
+#endif
+
+void ScriptSummaryCache::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("get_summary", "path"), &ScriptSummaryCache::get_summary);
+    ClassDB::bind_method(D_METHOD("save"), &ScriptSummaryCache::save);
+    ClassDB::bind_method(D_METHOD("clear"), &ScriptSummaryCache::clear);
+    ClassDB::bind_method(D_METHOD("get_entry_count"), &ScriptSummaryCache::get_entry_count);
+}
+
+String ScriptSummaryCache::_get_cache_path() const {
+    return EditorPaths::get_singleton()->get_project_settings_dir().path_join("vector_ai_script_summaries.json");
+}
+
+void ScriptSummaryCache::_load() {
+    if (loaded) {
+        return;
+    }
+    loaded = true;
+
+    Ref<FileAccess> f = FileAccess::open(_get_cache_path(), FileAccess::READ);
+    if (f.is_null()) {
+        return;
+    }
+
+    JSON json;
+    if (json.parse(f->get_as_text()) != OK || json.get_data().get_type() != Variant::DICTIONARY) {
+        return;
+    }
+
+    Dictionary scripts = Dictionary(json.get_data()).get("scripts", Dictionary());
+    for (const KeyValue<Variant, Variant> &E : scripts) {
+        if (E.value.get_type() != Variant::DICTIONARY) {
+            continue;
+        }
+        Dictionary data = E.value;
+        Entry entry;
+        entry.modified_time = (int64_t)data.get("modified_time", 0);
+        entry.summary = data.get("summary", "");
+        entries.insert(E.key, entry);
+    }
+}
+
+void ScriptSummaryCache::save() {
+    MutexLock lock(mutex);
+    if (!dirty) {
+        return;
+    }
+
+    Ref<FileAccess> f = FileAccess::open(_get_cache_path(), FileAccess::WRITE);
+    if (f.is_null()) {
+        return;
+    }
+
+    Dictionary scripts;
+    for (const KeyValue<String, Entry> &E : entries) {
+        Dictionary data;
+        data["modified_time"] = E.value.modified_time;
+        data["summary"] = E.value.summary;
+        scripts[E.key] = data;
+    }
+
+    Dictionary cache;
+    cache["scripts"] = scripts;
+
+    JSON json;
+    f->store_string(json.stringify(cache, "    "));
+    dirty = false;
+}
+
+void ScriptSummaryCache::clear() {
+    MutexLock lock(mutex);
+    entries.clear();
+    loaded = true;
+    dirty = true;
+}
+
+int ScriptSummaryCache::get_entry_count() {
+    MutexLock lock(mutex);
+    _load();
+    return entries.size();
+}
+
+String ScriptSummaryCache::get_summary(const String &p_path) {
+    uint64_t modified_time = FileAccess::get_modified_time(p_path);
+
+    {
+        MutexLock lock(mutex);
+        _load();
+        const Entry *entry = entries.getptr(p_path);
+        if (entry && entry->modified_time == modified_time) {
+            return entry->summary;
+        }
+    }
+
+    // Parsed outside the lock; worker threads may summarize different scripts at once
+    String summary = _summarize_source(p_path);
+    if (summary.is_empty()) {
+        summary = _summarize_script(p_path);
+    }
+
+    MutexLock lock(mutex);
+    Entry entry;
+    entry.modified_time = modified_time;
+    entry.summary = summary;
+    entries.insert(p_path, entry);
+    dirty = true;
+
+    return summary;
+}
+
+#ifdef MODULE_GDSCRIPT_ENABLED
+static String _type_text(const GDScriptParser::TypeNode *p_type) {
+    if (!p_type) {
+        return String();
+    }
+
+    PackedStringArray chain;
+    for (const GDScriptParser::IdentifierNode *identifier : p_type->type_chain) {
+        chain.push_back(identifier->name);
+    }
+    String text = String(".").join(chain);
+
+    if (!p_type->container_types.is_empty()) {
+        PackedStringArray containers;
+        for (const GDScriptParser::TypeNode *container : p_type->container_types) {
+            containers.push_back(_type_text(container));
+        }
+        text += "[" + String(", ").join(containers) + "]";
+    }
+    return text;
+}
+
+static String _parameters_text(const Vector<GDScriptParser::ParameterNode *> &p_parameters) {
+    PackedStringArray parameters;
+    for (const GDScriptParser::ParameterNode *parameter : p_parameters) {
+        String type = _type_text(parameter->datatype_specifier);
+        parameters.push_back(String(parameter->identifier->name) + (type.is_empty() ? String() : ": " + type));
+    }
+    return "(" + String(", ").join(parameters) + ")";
+}
+#endif
+
+String ScriptSummaryCache::_summarize_source(const String &p_path) {
+#ifdef MODULE_GDSCRIPT_ENABLED
+    if (p_path.get_extension() != "gd") {
+        return String();
+    }
+
+    Error err = OK;
+    String source = FileAccess::get_file_as_string(p_path, &err);
+    if (err != OK) {
+        return String();
+    }
+
+    // Declarations only; function bodies are skipped
+    GDScriptParser parser;
+    if (parser.parse(source, p_path, false, false) != OK || !parser.get_tree()) {
+        return String();
+    }
+    const GDScriptParser::ClassNode *tree = parser.get_tree();
+
+    String header;
+    if (tree->identifier) {
+        header = "class_name " + String(tree->identifier->name) + " ";
+    }
+    PackedStringArray extends;
+    if (!tree->extends_path.is_empty()) {
+        extends.push_back("\"" + tree->extends_path + "\"");
+    }
+    for (const GDScriptParser::IdentifierNode *identifier : tree->extends) {
+        extends.push_back(identifier->name);
+    }
+    header += "extends " + (extends.is_empty() ? String("RefCounted") : String(".").join(extends));
+
+    String summary = header + "\n";
+    int functions = 0;
+    int skipped_functions = 0;
+
+    for (const GDScriptParser::ClassNode::Member &member : tree->members) {
+        switch (member.type) {
+            case GDScriptParser::ClassNode::Member::VARIABLE: {
+                const GDScriptParser::VariableNode *variable = member.variable;
+                if (!variable->exported) {
+                    break;
+                }
+                String line = "@export var " + String(variable->identifier->name);
+                String type = _type_text(variable->datatype_specifier);
+                if (!type.is_empty()) {
+                    line += ": " + type;
+                } else if (variable->initializer && variable->initializer->type == GDScriptParser::Node::LITERAL) {
+                    // Inferred types are only known after analysis; the literal shows them well enough
+                    line += " = " + static_cast<const GDScriptParser::LiteralNode *>(variable->initializer)->value.get_construct_string();
+                }
+                summary += line + "\n";
+            } break;
+            case GDScriptParser::ClassNode::Member::SIGNAL: {
+                summary += "signal " + String(member.signal->identifier->name) + _parameters_text(member.signal->parameters) + "\n";
+            } break;
+            case GDScriptParser::ClassNode::Member::FUNCTION: {
+                const GDScriptParser::FunctionNode *function = member.function;
+                if (functions >= MAX_FUNCTIONS) {
+                    skipped_functions++;
+                    break;
+                }
+                String line = String(function->is_static ? "static func " : "func ") + String(function->identifier->name) + _parameters_text(function->parameters);
+                String return_type = _type_text(function->return_type);
+                if (!return_type.is_empty()) {
+                    line += " -> " + return_type;
+                }
+                summary += line + "\n";
+                functions++;
+            } break;
+            default:
+                break;
+        }
+    }
+
+    if (skipped_functions > 0) {
+        summary += vformat("... %d more functions\n", skipped_functions);
+    }
+    return summary;
+#else
+    return String();
+#endif
+}
+
+String ScriptSummaryCache::_summarize_script(const String &p_path) {
+    // Languages without a parser here are described through the loaded script
+    Ref<Script> script = ResourceLoader::load(p_path, "Script");
+    if (script.is_null()) {
+        return "(could not load script)\n";
+    }
+
+    String summary;
+    if (!script->get_global_name().is_empty()) {
+        summary += "class_name " + String(script->get_global_name()) + " ";
+    }
+    summary += "extends " + String(script->get_instance_base_type()) + "\n";
+
+    List<PropertyInfo> property_list;
+    script->get_script_property_list(&property_list);
+    for (const PropertyInfo &property : property_list) {
+        if (property.usage & PROPERTY_USAGE_EDITOR) {
+            summary += "@export var " + property.name + ": " + Variant::get_type_name(property.type) + "\n";
+        }
+    }
+
+    List<MethodInfo> signal_list;
+    script->get_script_signal_list(&signal_list);
+    for (const MethodInfo &signal : signal_list) {
+        PackedStringArray arguments;
+        for (const PropertyInfo &argument : signal.arguments) {
+            arguments.push_back(argument.name);
+        }
+        summary += "signal " + String(signal.name) + "(" + String(", ").join(arguments) + ")\n";
+    }
+
+    List<MethodInfo> method_list;
+    script->get_script_method_list(&method_list);
+    int functions = 0;
+    for (const MethodInfo &method : method_list) {
+        if (functions++ >= MAX_FUNCTIONS) {
+            summary += vformat("... %d more functions\n", method_list.size() - MAX_FUNCTIONS);
+            break;
+        }
+        PackedStringArray arguments;
+        for (const PropertyInfo &argument : method.arguments) {
+            arguments.push_back(argument.name);
+        }
+        summary += "func " + String(method.name) + "(" + String(", ").join(arguments) + ")\n";
+    }
+
+    return summary;
+}
+
+ScriptSummaryCache::ScriptSummaryCache() {
+}
+
+ScriptSummaryCache::~ScriptSummaryCache() {
+}
@@ -0,0 +1,72 @@
+/**************************************************************************/
+/*  script_summary_cache.h                                                */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/object/ref_counted.h"
+#include "core/os/mutex.h"
+#include "core/templates/hash_map.h"
+
+class ScriptSummaryCache : public RefCounted {
+    GDCLASS(ScriptSummaryCache, RefCounted);
+
+private:
+    struct Entry {
+        uint64_t modified_time = 0;
+        String summary;
+    };
+
+    // Summaries keyed by script path; an entry is reused while the file's mtime matches
+    HashMap<String, Entry> entries;
+    bool loaded = false;
+    bool dirty = false;
+    Mutex mutex;
+
+    String _get_cache_path() const;
+    void _load();
+
+    static String _summarize_source(const String &p_path);
+    static String _summarize_script(const String &p_path);
+
+protected:
+    static void _bind_methods();
+
+public:
+    // Signatures listed per script before the rest are counted
+    static const int MAX_FUNCTIONS = 32;
+
+    String get_summary(const String &p_path);
+    void save();
+    void clear();
+    int get_entry_count();
+
+    ScriptSummaryCache();
+    ~ScriptSummaryCache();
+};
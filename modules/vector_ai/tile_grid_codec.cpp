@@ -0,0 +1,575 @@
+/**************************************************************************/
+/*  tile_grid_codec.cpp                                                   */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "tile_grid_codec.h"
+
+#include "core/io/marshalls.h"
+#include "core/templates/hash_set.h"
+#include "scene/2d/tile_map.h"
+#include "scene/2d/tile_map_layer.h"
+#include "scene/resources/2d/tile_set.h"
+
+void TileGridCodec::_bind_methods() {
+    ClassDB::bind_static_method("TileGridCodec", D_METHOD("describe_tiles", "node", "indent"), &TileGridCodec::describe_tiles);
+    ClassDB::bind_static_method("TileGridCodec", D_METHOD("get_tile_data_property", "node", "layer"), &TileGridCodec::get_tile_data_property);
+    ClassDB::bind_static_method("TileGridCodec", D_METHOD("is_int_grid", "value"), &TileGridCodec::is_int_grid);
+    ClassDB::bind_static_method("TileGridCodec", D_METHOD("encode_grid", "rows"), &TileGridCodec::encode_grid);
+}
+
+// Tiles are written as "source:x,y" with "/alternative" when it is not 0
+static String _tile_key(int p_source, const Vector2i &p_atlas, int p_alternative) {
+    String key = itos(p_source) + ":" + itos(p_atlas.x) + "," + itos(p_atlas.y);
+    if (p_alternative != 0) {
+        key += "/" + itos(p_alternative);
+    }
+    return key;
+}
+
+static bool _parse_tile_key(const String &p_key, int &r_source, Vector2i &r_atlas, int &r_alternative) {
+    int colon = p_key.find(":");
+    if (colon <= 0) {
+        return false;
+    }
+
+    String coords = p_key.substr(colon + 1);
+    r_alternative = 0;
+    int slash = coords.find("/");
+    if (slash != -1) {
+        if (!coords.substr(slash + 1).is_valid_int()) {
+            return false;
+        }
+        r_alternative = coords.substr(slash + 1).to_int();
+        coords = coords.substr(0, slash);
+    }
+
+    Vector<String> xy = coords.split(",");
+    if (xy.size() != 2 || !p_key.substr(0, colon).is_valid_int() || !xy[0].is_valid_int() || !xy[1].is_valid_int()) {
+        return false;
+    }
+
+    r_source = p_key.substr(0, colon).to_int();
+    r_atlas = Vector2i(xy[0].to_int(), xy[1].to_int());
+    return true;
+}
+
+struct CellSort {
+    _FORCE_INLINE_ bool operator()(const Vector2i &p_a, const Vector2i &p_b) const {
+        return p_a.y < p_b.y || (p_a.y == p_b.y && p_a.x < p_b.x);
+    }
+};
+
+int TileGridCodec::Palette::get_or_add(const String &p_key) {
+    const int *id = ids.getptr(p_key);
+    if (id) {
+        return *id;
+    }
+    ids.insert(p_key, keys.size());
+    keys.push_back(p_key);
+    return keys.size() - 1;
+}
+
+bool TileGridCodec::_is_tile_node(Node *p_node, int p_layer) {
+    if (Object::cast_to<TileMapLayer>(p_node)) {
+        return p_layer <= 0;
+    }
+    TileMap *tile_map = Object::cast_to<TileMap>(p_node);
+    return tile_map && p_layer >= 0 && p_layer < tile_map->get_layers_count();
+}
+
+String TileGridCodec::get_tile_data_property(Node *p_node, int p_layer) {
+    if (Object::cast_to<TileMapLayer>(p_node)) {
+        return "tile_map_data";
+    }
+    if (Object::cast_to<TileMap>(p_node)) {
+        return vformat("layer_%d/tile_data", MAX(p_layer, 0));
+    }
+    return String();
+}
+
+void TileGridCodec::_build_palette(const Ref<TileSet> &p_tile_set, Palette &r_palette) {
+    // Ids follow the TileSet so they stay the same between the context and a later patch
+    if (p_tile_set.is_valid()) {
+        for (int i = 0; i < p_tile_set->get_source_count(); i++) {
+            int source_id = p_tile_set->get_source_id(i);
+            Ref<TileSetSource> source = p_tile_set->get_source(source_id);
+            for (int j = 0; j < source->get_tiles_count(); j++) {
+                Vector2i atlas = source->get_tile_id(j);
+                for (int k = 0; k < source->get_alternative_tiles_count(atlas); k++) {
+                    r_palette.get_or_add(_tile_key(source_id, atlas, source->get_alternative_tile_id(atlas, k)));
+                }
+            }
+        }
+    }
+    r_palette.tile_set_count = r_palette.keys.size();
+}
+
+void TileGridCodec::_collect_cells(Node *p_node, int p_layer, Palette &r_palette, Vector<Cell> &r_cells) {
+    TileMapLayer *layer = Object::cast_to<TileMapLayer>(p_node);
+    TileMap *tile_map = Object::cast_to<TileMap>(p_node);
+
+    _build_palette(p_node->get("tile_set"), r_palette);
+
+    TypedArray<Vector2i> used = layer ? layer->get_used_cells() : tile_map->get_used_cells(p_layer);
+    Vector<Vector2i> coords;
+    coords.resize(used.size());
+    for (int i = 0; i < used.size(); i++) {
+        coords.write[i] = used[i];
+    }
+    coords.sort_custom<CellSort>();
+
+    r_cells.resize(coords.size());
+    for (int i = 0; i < coords.size(); i++) {
+        const Vector2i &cell = coords[i];
+        String key = layer
+                ? _tile_key(layer->get_cell_source_id(cell), layer->get_cell_atlas_coords(cell), layer->get_cell_alternative_tile(cell))
+                : _tile_key(tile_map->get_cell_source_id(p_layer, cell), tile_map->get_cell_atlas_coords(p_layer, cell), tile_map->get_cell_alternative_tile(p_layer, cell));
+        r_cells.write[i].coords = cell;
+        r_cells.write[i].id = r_palette.get_or_add(key);
+    }
+}
+
+bool TileGridCodec::_decode_cells(const PackedByteArray &p_data, Palette &r_palette, Vector<Cell> &r_cells) {
+    // Same layout TileMapLayer reads from tile_map_data: a uint16 format,
+    // then 12 bytes per cell (x, y, source, atlas x, atlas y, alternative)
+    if (p_data.is_empty()) {
+        return true;
+    }
+    if (p_data.size() < 2 || (p_data.size() - 2) % 12 != 0 || decode_uint16(p_data.ptr()) >= TileMapLayerDataFormat::TILE_MAP_LAYER_DATA_FORMAT_MAX) {
+        return false;
+    }
+
+    // Later entries for the same cell replace earlier ones, as they do on load
+    HashMap<Vector2i, String> keys;
+    const uint8_t *ptr = p_data.ptr() + 2;
+    int count = (p_data.size() - 2) / 12;
+    for (int i = 0; i < count; i++, ptr += 12) {
+        Vector2i cell((int16_t)decode_uint16(ptr), (int16_t)decode_uint16(ptr + 2));
+        int source = decode_uint16(ptr + 4);
+        Vector2i atlas((int16_t)decode_uint16(ptr + 6), (int16_t)decode_uint16(ptr + 8));
+        keys[cell] = _tile_key(source, atlas, decode_uint16(ptr + 10));
+    }
+
+    Vector<Vector2i> coords;
+    for (const KeyValue<Vector2i, String> &E : keys) {
+        coords.push_back(E.key);
+    }
+    coords.sort_custom<CellSort>();
+
+    r_cells.resize(coords.size());
+    for (int i = 0; i < coords.size(); i++) {
+        r_cells.write[i].coords = coords[i];
+        r_cells.write[i].id = r_palette.get_or_add(keys[coords[i]]);
+    }
+    return true;
+}
+
+String TileGridCodec::_encode_runs(const Vector<String> &p_tokens) {
+    PackedStringArray runs;
+    int i = 0;
+    while (i < p_tokens.size()) {
+        int count = 1;
+        while (i + count < p_tokens.size() && p_tokens[i + count] == p_tokens[i]) {
+            count++;
+        }
+        runs.push_back(count > 1 ? p_tokens[i] + "*" + itos(count) : p_tokens[i]);
+        i += count;
+    }
+    return String(" ").join(runs);
+}
+
+bool TileGridCodec::_parse_row(const String &p_row, int &r_from, int &r_to, int &r_x, Vector<Run> &r_runs) {
+    // "y[..y2] [@x]: run run ..."
+    int colon = p_row.find(":");
+    if (colon <= 0) {
+        return false;
+    }
+
+    String head = p_row.substr(0, colon).strip_edges();
+    String body = p_row.substr(colon + 1).strip_edges();
+
+    r_x = 0;
+    int at = head.find("@");
+    if (at != -1) {
+        String x = head.substr(at + 1).strip_edges();
+        if (!x.is_valid_int()) {
+            return false;
+        }
+        r_x = x.to_int();
+        head = head.substr(0, at).strip_edges();
+    }
+
+    int range = head.find("..");
+    String from = range == -1 ? head : head.substr(0, range);
+    String to = range == -1 ? head : head.substr(range + 2);
+    if (!from.is_valid_int() || !to.is_valid_int()) {
+        return false;
+    }
+    r_from = from.to_int();
+    r_to = to.to_int();
+    if (r_to < r_from) {
+        return false;
+    }
+
+    r_runs.clear();
+    Vector<String> tokens = body.split(" ", false);
+    for (const String &token : tokens) {
+        Run run;
+        int star = token.rfind("*");
+        if (star != -1) {
+            String count = token.substr(star + 1);
+            if (!count.is_valid_int() || count.to_int() <= 0) {
+                return false;
+            }
+            run.count = count.to_int();
+            run.token = token.substr(0, star);
+        } else {
+            run.token = token;
+        }
+        r_runs.push_back(run);
+    }
+    return !r_runs.is_empty();
+}
+
+String TileGridCodec::_describe_layer(Node *p_node, int p_layer, const String &p_indent) {
+    String title = p_indent + "  Tiles";
+    if (p_layer >= 0) {
+        TileMap *tile_map = Object::cast_to<TileMap>(p_node);
+        title += vformat(" (layer %d \"%s\")", p_layer, tile_map->get_layer_name(p_layer));
+    }
+
+    Palette palette;
+    Vector<Cell> cells;
+    _collect_cells(p_node, p_layer, palette, cells);
+    return _describe_cells(title, palette, cells, p_indent);
+}
+
+String TileGridCodec::_describe_cells(const String &p_title, const Palette &p_palette, const Vector<Cell> &p_cells, const String &p_indent) {
+    if (p_cells.is_empty()) {
+        return p_title + ": empty\n";
+    }
+
+    // Cells are sorted by row, so only the columns need a scan
+    Vector2i min_cell = p_cells[0].coords;
+    Vector2i max_cell = p_cells[p_cells.size() - 1].coords;
+    for (const Cell &cell : p_cells) {
+        min_cell.x = MIN(min_cell.x, cell.coords.x);
+        max_cell.x = MAX(max_cell.x, cell.coords.x);
+    }
+
+    String info = p_title + vformat(": rect (%d, %d) size (%d, %d), %d cells\n", min_cell.x, min_cell.y, max_cell.x - min_cell.x + 1, max_cell.y - min_cell.y + 1, p_cells.size());
+
+    // Small TileSets are listed in full; large ones only with the tiles in use
+    HashSet<int> used_ids;
+    for (const Cell &cell : p_cells) {
+        used_ids.insert(cell.id);
+    }
+    bool list_all = p_palette.tile_set_count <= MAX_LISTED_PALETTE;
+    PackedStringArray entries;
+    for (int i = 0; i < p_palette.keys.size(); i++) {
+        if (list_all || used_ids.has(i)) {
+            entries.push_back(itos(i) + "=" + p_palette.keys[i]);
+        }
+    }
+    info += p_indent + "    Palette (id=source:atlas_x,atlas_y[/alternative]): " + String(" ").join(entries);
+    if (!list_all) {
+        info += vformat(" (%d unused TileSet tiles not listed)", p_palette.tile_set_count - (int)used_ids.size());
+    }
+    info += "\n";
+    info += p_indent + "    Rows (y[..y2] @x: id*count, . is empty):\n";
+
+    // Identical neighbouring rows collapse into one range
+    String rows_text;
+    int rows_left = 0;
+    String last_row;
+    int range_from = 0;
+    int range_to = 0;
+
+    auto flush = [&]() {
+        if (last_row.is_empty()) {
+            return;
+        }
+        if (rows_text.length() >= MAX_ENCODED_LENGTH) {
+            rows_left += range_to - range_from + 1;
+            return;
+        }
+        String range = range_from == range_to ? itos(range_from) : itos(range_from) + ".." + itos(range_to);
+        rows_text += p_indent + "      " + range + " " + last_row + "\n";
+    };
+
+    int i = 0;
+    while (i < p_cells.size()) {
+        int y = p_cells[i].coords.y;
+        int x = p_cells[i].coords.x;
+        Vector<String> tokens;
+        int next_x = x;
+        while (i < p_cells.size() && p_cells[i].coords.y == y) {
+            for (; next_x < p_cells[i].coords.x; next_x++) {
+                tokens.push_back(".");
+            }
+            tokens.push_back(itos(p_cells[i].id));
+            next_x++;
+            i++;
+        }
+
+        String row = "@" + itos(x) + ": " + _encode_runs(tokens);
+        if (row == last_row && y == range_to + 1) {
+            range_to = y;
+            continue;
+        }
+        flush();
+        last_row = row;
+        range_from = y;
+        range_to = y;
+    }
+    flush();
+
+    info += rows_text;
+    if (rows_left > 0) {
+        info += p_indent + vformat("      ... %d more rows\n", rows_left);
+    }
+    return info;
+}
+
+String TileGridCodec::describe_tiles(Node *p_node, const String &p_indent) {
+    if (Object::cast_to<TileMapLayer>(p_node)) {
+        return _describe_layer(p_node, -1, p_indent);
+    }
+
+    TileMap *tile_map = Object::cast_to<TileMap>(p_node);
+    if (!tile_map) {
+        return String();
+    }
+
+    String info;
+    for (int i = 0; i < tile_map->get_layers_count(); i++) {
+        info += _describe_layer(p_node, i, p_indent);
+    }
+    return info;
+}
+
+String TileGridCodec::describe_tile_data(const Ref<TileSet> &p_tile_set, const PackedByteArray &p_data, const String &p_indent) {
+    // For layers read from a scene file, without creating a TileMapLayer
+    Palette palette;
+    _build_palette(p_tile_set, palette);
+
+    Vector<Cell> cells;
+    if (!_decode_cells(p_data, palette, cells)) {
+        return p_indent + "  Tiles: unreadable tile_map_data\n";
+    }
+    return _describe_cells(p_indent + "  Tiles", palette, cells, p_indent);
+}
+
+Error TileGridCodec::apply_tile_patch(Node *p_node, int p_layer, const String &p_patch, String &r_error) {
+    if (!_is_tile_node(p_node, p_layer)) {
+        r_error = "Not a tile layer: " + String(p_node->get_name()) + (p_layer > 0 ? vformat(" layer %d", p_layer) : String());
+        return ERR_INVALID_PARAMETER;
+    }
+
+    TileMapLayer *layer = Object::cast_to<TileMapLayer>(p_node);
+    TileMap *tile_map = Object::cast_to<TileMap>(p_node);
+    int map_layer = MAX(p_layer, 0);
+
+    Palette palette;
+    Vector<Cell> cells;
+    _collect_cells(p_node, map_layer, palette, cells);
+
+    // Rows are separated by ";" so a whole patch fits one modification line
+    Vector<String> rows = p_patch.split(";", false);
+    int written = 0;
+    for (const String &row : rows) {
+        int from = 0;
+        int to = 0;
+        int x = 0;
+        Vector<Run> runs;
+        if (!_parse_row(row.strip_edges(), from, to, x, runs)) {
+            r_error = "Invalid tile row: " + row.strip_edges();
+            return ERR_PARSE_ERROR;
+        }
+
+        for (const Run &run : runs) {
+            int source = TileSet::INVALID_SOURCE;
+            Vector2i atlas = TileSetSource::INVALID_ATLAS_COORDS;
+            int alternative = TileSetSource::INVALID_TILE_ALTERNATIVE;
+            if (run.token != ".") {
+                String key = run.token;
+                if (run.token.is_valid_int()) {
+                    int id = run.token.to_int();
+                    if (id < 0 || id >= palette.keys.size()) {
+                        r_error = "Unknown tile id: " + run.token;
+                        return ERR_INVALID_PARAMETER;
+                    }
+                    key = palette.keys[id];
+                }
+                if (!_parse_tile_key(key, source, atlas, alternative)) {
+                    r_error = "Invalid tile: " + run.token;
+                    return ERR_PARSE_ERROR;
+                }
+            }
+
+            written += run.count * (to - from + 1);
+            if (written > MAX_PATCH_CELLS) {
+                r_error = vformat("Tile patch writes more than %d cells.", MAX_PATCH_CELLS);
+                return ERR_OUT_OF_MEMORY;
+            }
+
+            for (int y = from; y <= to; y++) {
+                for (int c = 0; c < run.count; c++) {
+                    Vector2i coords(x + c, y);
+                    if (layer) {
+                        layer->set_cell(coords, source, atlas, alternative);
+                    } else {
+                        tile_map->set_cell(map_layer, coords, source, atlas, alternative);
+                    }
+                }
+            }
+            x += run.count;
+        }
+    }
+
+    return OK;
+}
+
+bool TileGridCodec::is_int_grid(const Variant &p_value) {
+    if (p_value.get_type() != Variant::ARRAY) {
+        return false;
+    }
+
+    Array rows = p_value;
+    if (rows.is_empty()) {
+        return false;
+    }
+
+    int width = -1;
+    for (int i = 0; i < rows.size(); i++) {
+        if (rows[i].get_type() != Variant::ARRAY && rows[i].get_type() != Variant::PACKED_INT32_ARRAY && rows[i].get_type() != Variant::PACKED_INT64_ARRAY) {
+            return false;
+        }
+        Array row = rows[i];
+        if (width != -1 && row.size() != width) {
+            return false;
+        }
+        width = row.size();
+        for (int j = 0; j < row.size(); j++) {
+            if (row[j].get_type() != Variant::INT) {
+                return false;
+            }
+        }
+    }
+
+    return width * rows.size() >= MIN_GRID_CELLS;
+}
+
+String TileGridCodec::encode_grid(const Array &p_rows) {
+    // Grid(WxH; y[..y2]: value*count ...; ...), same row notation as tile layers
+    int width = p_rows.is_empty() ? 0 : Array(p_rows[0]).size();
+    PackedStringArray parts;
+    parts.push_back(vformat("%dx%d", width, p_rows.size()));
+
+    String last_row;
+    int range_from = 0;
+    for (int y = 0; y <= p_rows.size(); y++) {
+        String row;
+        if (y < p_rows.size()) {
+            Array cells = p_rows[y];
+            Vector<String> tokens;
+            for (int x = 0; x < cells.size(); x++) {
+                tokens.push_back(itos(cells[x]));
+            }
+            row = _encode_runs(tokens);
+            if (y > 0 && row == last_row) {
+                continue;
+            }
+        }
+        if (y > 0) {
+            String range = range_from == y - 1 ? itos(range_from) : itos(range_from) + ".." + itos(y - 1);
+            parts.push_back(range + ": " + last_row);
+        }
+        last_row = row;
+        range_from = y;
+    }
+
+    return "Grid(" + String("; ").join(parts) + ")";
+}
+
+bool TileGridCodec::decode_grid(const String &p_text, Array &r_rows) {
+    String text = p_text.strip_edges();
+    if (!text.begins_with("Grid(") || !text.ends_with(")")) {
+        return false;
+    }
+
+    Vector<String> parts = text.substr(5, text.length() - 6).split(";", false);
+    if (parts.is_empty()) {
+        return false;
+    }
+
+    Vector<String> size = parts[0].strip_edges().split("x");
+    if (size.size() != 2 || !size[0].is_valid_int() || !size[1].is_valid_int()) {
+        return false;
+    }
+    int width = size[0].to_int();
+    int height = size[1].to_int();
+    if (width <= 0 || height <= 0 || (int64_t)width * height > MAX_PATCH_CELLS) {
+        return false;
+    }
+
+    // Rows that are not mentioned stay 0
+    r_rows.clear();
+    for (int y = 0; y < height; y++) {
+        Array row;
+        row.resize(width);
+        row.fill(0);
+        r_rows.push_back(row);
+    }
+
+    for (int i = 1; i < parts.size(); i++) {
+        int from = 0;
+        int to = 0;
+        int x = 0;
+        Vector<Run> runs;
+        if (!_parse_row(parts[i].strip_edges(), from, to, x, runs) || from < 0 || to >= height || x < 0) {
+            return false;
+        }
+
+        for (int y = from; y <= to; y++) {
+            Array row = r_rows[y];
+            int column = x;
+            for (const Run &run : runs) {
+                if (!run.token.is_valid_int()) {
+                    return false;
+                }
+                for (int c = 0; c < run.count && column < width; c++) {
+                    row[column++] = run.token.to_int();
+                }
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,94 @@
+/**************************************************************************/
+/*  tile_grid_codec.h                                                     */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/object/ref_counted.h"
+#include "core/templates/hash_map.h"
+
+class Node;
+class TileSet;
+
+// Run-length text form for tile layers and integer grids, so large maps fit in the prompt
+// and the model can patch them back row by row.
+class TileGridCodec : public RefCounted {
+    GDCLASS(TileGridCodec, RefCounted);
+
+private:
+    struct Run {
+        String token;
+        int count = 1;
+    };
+
+    struct Cell {
+        Vector2i coords;
+        int id = 0;
+    };
+
+    // Tile ids in TileSet order, followed by any used tiles the TileSet does not list
+    struct Palette {
+        Vector<String> keys;
+        HashMap<String, int> ids;
+        int tile_set_count = 0;
+
+        int get_or_add(const String &p_key);
+    };
+
+    static bool _is_tile_node(Node *p_node, int p_layer);
+    static void _build_palette(const Ref<TileSet> &p_tile_set, Palette &r_palette);
+    static void _collect_cells(Node *p_node, int p_layer, Palette &r_palette, Vector<Cell> &r_cells);
+    static bool _decode_cells(const PackedByteArray &p_data, Palette &r_palette, Vector<Cell> &r_cells);
+    static String _describe_layer(Node *p_node, int p_layer, const String &p_indent);
+    static String _describe_cells(const String &p_title, const Palette &p_palette, const Vector<Cell> &p_cells, const String &p_indent);
+    static String _encode_runs(const Vector<String> &p_tokens);
+    static bool _parse_row(const String &p_row, int &r_from, int &r_to, int &r_x, Vector<Run> &r_runs);
+
+protected:
+    static void _bind_methods();
+
+public:
+    // Row text kept per layer before the remaining rows are only counted
+    static const int MAX_ENCODED_LENGTH = 16384;
+    // TileSets up to this size are listed in full so unused tiles can be placed
+    static const int MAX_LISTED_PALETTE = 64;
+    // Upper bound on the cells one patch may write
+    static const int MAX_PATCH_CELLS = 1 << 20;
+    // Smaller integer arrays print as plain arrays
+    static const int MIN_GRID_CELLS = 16;
+
+    static String describe_tiles(Node *p_node, const String &p_indent);
+    static String describe_tile_data(const Ref<TileSet> &p_tile_set, const PackedByteArray &p_data, const String &p_indent);
+    static Error apply_tile_patch(Node *p_node, int p_layer, const String &p_patch, String &r_error);
+    static String get_tile_data_property(Node *p_node, int p_layer);
+
+    static bool is_int_grid(const Variant &p_value);
+    static String encode_grid(const Array &p_rows);
+    static bool decode_grid(const String &p_text, Array &r_rows);
+};
@@ -0,0 +1,283 @@
+/**************************************************************************/
+/*  token_estimator.cpp                                                   */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "token_estimator.h"
+
+#include "core/io/file_access.h"
+#include "core/io/json.h"
+#include "editor/editor_paths.h"
+
+void TokenEstimator::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("estimate_raw", "text"), &TokenEstimator::estimate_raw);
+    ClassDB::bind_method(D_METHOD("estimate_tokens", "text"), &TokenEstimator::estimate_tokens);
+    ClassDB::bind_method(D_METHOD("add_calibration_sample", "estimated_raw", "actual_tokens"), &TokenEstimator::add_calibration_sample);
+    ClassDB::bind_method(D_METHOD("get_calibration_factor"), &TokenEstimator::get_calibration_factor);
+    ClassDB::bind_method(D_METHOD("get_calibration_sample_count"), &TokenEstimator::get_calibration_sample_count);
+    ClassDB::bind_method(D_METHOD("needs_calibration"), &TokenEstimator::needs_calibration);
+    ClassDB::bind_method(D_METHOD("trim_outline_to_budget", "outline", "budget_tokens"), &TokenEstimator::trim_outline_to_budget);
+}
+
+String TokenEstimator::_get_calibration_path() const {
+    return EditorPaths::get_singleton()->get_config_dir().path_join("vector_ai_token_calibration.json");
+}
+
+void TokenEstimator::_load_calibration() {
+    if (calibration_loaded) {
+        return;
+    }
+    calibration_loaded = true;
+
+    Ref<FileAccess> f = FileAccess::open(_get_calibration_path(), FileAccess::READ);
+    if (f.is_null()) {
+        return;
+    }
+
+    JSON json;
+    if (json.parse(f->get_as_text()) != OK || json.get_data().get_type() != Variant::DICTIONARY) {
+        return;
+    }
+
+    Dictionary data = json.get_data();
+    calibration_actual = data.get("actual", 0.0);
+    calibration_estimated = data.get("estimated", 0.0);
+    calibration_samples = data.get("samples", 0);
+
+    if (calibration_estimated > 0.0) {
+        calibration_factor = calibration_actual / calibration_estimated;
+    }
+}
+
+void TokenEstimator::_save_calibration() {
+    Ref<FileAccess> f = FileAccess::open(_get_calibration_path(), FileAccess::WRITE);
+    if (f.is_null()) {
+        return;
+    }
+
+    Dictionary data;
+    data["actual"] = calibration_actual;
+    data["estimated"] = calibration_estimated;
+    data["samples"] = calibration_samples;
+    data["factor"] = calibration_factor;
+
+    JSON json;
+    f->store_string(json.stringify(data, "    "));
+    calibration_dirty = false;
+}
+
+int TokenEstimator::estimate_raw(const String &p_text) const {
+    // Single pass approximation of a SentencePiece tokenizer:
+    // words cost about one token per four letters, digits and punctuation one each,
+    // whitespace runs one per four characters and non-ASCII one per character.
+    const char32_t *ptr = p_text.ptr();
+    int length = p_text.length();
+    int tokens = 0;
+    int i = 0;
+
+    while (i < length) {
+        char32_t c = ptr[i];
+
+        if (is_ascii_alphabet_char(c) || c == '_') {
+            int start = i;
+            while (i < length && (is_ascii_alphabet_char(ptr[i]) || ptr[i] == '_')) {
+                i++;
+            }
+            tokens += (i - start + 3) / 4;
+        } else if (c == ' ' || c == '\t') {
+            int start = i;
+            while (i < length && (ptr[i] == ' ' || ptr[i] == '\t')) {
+                i++;
+            }
+            // A single space is usually merged into the following word
+            int run = i - start;
+            if (run > 1) {
+                tokens += (run + 3) / 4;
+            }
+        } else {
+            // Digits, punctuation, newlines and non-ASCII characters
+            tokens++;
+            i++;
+        }
+    }
+
+    return tokens;
+}
+
+int TokenEstimator::estimate_tokens(const String &p_text) {
+    return (int)Math::ceil(estimate_raw(p_text) * get_calibration_factor());
+}
+
+void TokenEstimator::add_calibration_sample(int p_estimated_raw, int p_actual_tokens) {
+    ERR_FAIL_COND(p_estimated_raw <= 0 || p_actual_tokens <= 0);
+
+    _load_calibration();
+
+    // Older samples decay so the factor follows model and prompt changes
+    const double decay = 0.9;
+    calibration_actual = calibration_actual * decay + p_actual_tokens;
+    calibration_estimated = calibration_estimated * decay + p_estimated_raw;
+    calibration_factor = calibration_actual / calibration_estimated;
+    calibration_samples++;
+    calibration_dirty = true;
+
+    // Save every sample while calibrating, then occasionally; the rest is saved on exit
+    if (calibration_samples <= CALIBRATION_TARGET || calibration_samples % CALIBRATION_SAVE_INTERVAL == 0) {
+        _save_calibration();
+    }
+}
+
+double TokenEstimator::get_calibration_factor() {
+    _load_calibration();
+    return calibration_factor;
+}
+
+int TokenEstimator::get_calibration_sample_count() {
+    _load_calibration();
+    return calibration_samples;
+}
+
+bool TokenEstimator::needs_calibration() {
+    return get_calibration_sample_count() < CALIBRATION_TARGET;
+}
+
+Dictionary TokenEstimator::trim_outline_to_budget(const String &p_outline, int p_budget_tokens) {
+    // Trims an indented "- Name (Class)" outline as produced by SceneAnalyzer.
+    // Property blocks of the deepest nodes go first, then the deepest nodes themselves,
+    // so the overall structure survives as long as possible.
+    Dictionary result;
+    result["text"] = p_outline;
+    result["trimmed_lines"] = 0;
+
+    int total_tokens = estimate_tokens(p_outline);
+    result["tokens"] = total_tokens;
+
+    if (p_budget_tokens <= 0 || total_tokens <= p_budget_tokens) {
+        return result;
+    }
+
+    Vector<String> lines = p_outline.split("\n");
+    int line_count = lines.size();
+
+    LocalVector<int> line_tokens;
+    LocalVector<int> line_depth;
+    LocalVector<bool> line_is_property;
+    LocalVector<bool> line_kept;
+    line_tokens.resize(line_count);
+    line_depth.resize(line_count);
+    line_is_property.resize(line_count);
+    line_kept.resize(line_count);
+
+    double factor = get_calibration_factor();
+    int max_depth = 0;
+    int current_depth = -1;
+
+    for (int i = 0; i < line_count; i++) {
+        const String &line = lines[i];
+        line_tokens[i] = (int)Math::ceil((estimate_raw(line) + 1) * factor);
+        line_kept[i] = true;
+
+        int indent = 0;
+        while (indent < line.length() && line[indent] == ' ') {
+            indent++;
+        }
+
+        if (indent < line.length() && line[indent] == '-' && line.find("(") != -1) {
+            current_depth = indent / 2;
+            max_depth = MAX(max_depth, current_depth);
+            line_depth[i] = current_depth;
+            line_is_property[i] = false;
+        } else {
+            // Header lines outside the node tree are never trimmed
+            line_depth[i] = current_depth;
+            line_is_property[i] = current_depth >= 0;
+        }
+    }
+
+    int kept_tokens = 0;
+    for (int i = 0; i < line_count; i++) {
+        kept_tokens += line_tokens[i];
+    }
+
+    int trimmed_lines = 0;
+
+    // First pass drops properties, second pass drops nodes, deepest level first
+    for (int pass = 0; pass < 2 && kept_tokens > p_budget_tokens; pass++) {
+        for (int depth = max_depth; depth >= (pass == 0 ? 0 : 1) && kept_tokens > p_budget_tokens; depth--) {
+            for (int i = 0; i < line_count; i++) {
+                if (!line_kept[i] || line_depth[i] < depth) {
+                    continue;
+                }
+                if (pass == 0 && !line_is_property[i]) {
+                    continue;
+                }
+
+                line_kept[i] = false;
+                kept_tokens -= line_tokens[i];
+                trimmed_lines++;
+            }
+        }
+    }
+
+    String trimmed;
+    int emitted_tokens = 0;
+    for (int i = 0; i < line_count; i++) {
+        if (!line_kept[i]) {
+            continue;
+        }
+
+        // Hard cut when even the top level does not fit; lines dropped above are already counted
+        if (emitted_tokens + line_tokens[i] > p_budget_tokens) {
+            for (int j = i; j < line_count; j++) {
+                if (line_kept[j]) {
+                    trimmed_lines++;
+                }
+            }
+            break;
+        }
+
+        trimmed += lines[i] + "\n";
+        emitted_tokens += line_tokens[i];
+    }
+
+    trimmed += vformat("[Scene context trimmed to fit the prompt budget: %d lines omitted]\n", trimmed_lines);
+
+    result["text"] = trimmed;
+    result["tokens"] = emitted_tokens;
+    result["trimmed_lines"] = trimmed_lines;
+    return result;
+}
+
+TokenEstimator::TokenEstimator() {
+}
+
+TokenEstimator::~TokenEstimator() {
+    if (calibration_dirty && EditorPaths::get_singleton()) {
+        _save_calibration();
+    }
+}
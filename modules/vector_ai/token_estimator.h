@@ -0,0 +1,72 @@
+/**************************************************************************/
+/*  token_estimator.h                                                     */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/object/ref_counted.h"
+
+class TokenEstimator : public RefCounted {
+    GDCLASS(TokenEstimator, RefCounted);
+
+private:
+    // Calibration is a running ratio of actual to raw estimated tokens
+    double calibration_factor = 1.0;
+    double calibration_actual = 0.0;
+    double calibration_estimated = 0.0;
+    int calibration_samples = 0;
+    bool calibration_loaded = false;
+    bool calibration_dirty = false;
+
+    String _get_calibration_path() const;
+    void _load_calibration();
+    void _save_calibration();
+
+protected:
+    static void _bind_methods();
+
+public:
+    // Samples needed before the calibration is considered reliable
+    static const int CALIBRATION_TARGET = 8;
+    // Once calibrated, the file is only rewritten every this many samples
+    static const int CALIBRATION_SAVE_INTERVAL = 16;
+
+    int estimate_raw(const String &p_text) const;
+    int estimate_tokens(const String &p_text);
+
+    void add_calibration_sample(int p_estimated_raw, int p_actual_tokens);
+    double get_calibration_factor();
+    int get_calibration_sample_count();
+    bool needs_calibration();
+
+    Dictionary trim_outline_to_budget(const String &p_outline, int p_budget_tokens);
+
+    TokenEstimator();
+    ~TokenEstimator();
+};
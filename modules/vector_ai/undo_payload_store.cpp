@@ -0,0 +1,280 @@
+/**************************************************************************/
+/*  undo_payload_store.cpp                                                */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "undo_payload_store.h"
+
+bool UndoPayloadStore::_get_bytes(const Variant &p_value, const uint8_t *&r_data, int &r_size) {
+    // The arrays share their buffer with p_value, so the pointer stays valid while it is held
+    switch (p_value.get_type()) {
+        case Variant::PACKED_BYTE_ARRAY: {
+            const PackedByteArray array = p_value;
+            r_data = array.ptr();
+            r_size = array.size();
+        } break;
+        case Variant::PACKED_INT32_ARRAY: {
+            const PackedInt32Array array = p_value;
+            r_data = (const uint8_t *)array.ptr();
+            r_size = array.size() * sizeof(int32_t);
+        } break;
+        case Variant::PACKED_INT64_ARRAY: {
+            const PackedInt64Array array = p_value;
+            r_data = (const uint8_t *)array.ptr();
+            r_size = array.size() * sizeof(int64_t);
+        } break;
+        case Variant::PACKED_FLOAT32_ARRAY: {
+            const PackedFloat32Array array = p_value;
+            r_data = (const uint8_t *)array.ptr();
+            r_size = array.size() * sizeof(float);
+        } break;
+        case Variant::PACKED_FLOAT64_ARRAY: {
+            const PackedFloat64Array array = p_value;
+            r_data = (const uint8_t *)array.ptr();
+            r_size = array.size() * sizeof(double);
+        } break;
+        case Variant::PACKED_VECTOR2_ARRAY: {
+            const PackedVector2Array array = p_value;
+            r_data = (const uint8_t *)array.ptr();
+            r_size = array.size() * sizeof(Vector2);
+        } break;
+        case Variant::PACKED_VECTOR3_ARRAY: {
+            const PackedVector3Array array = p_value;
+            r_data = (const uint8_t *)array.ptr();
+            r_size = array.size() * sizeof(Vector3);
+        } break;
+        case Variant::PACKED_VECTOR4_ARRAY: {
+            const PackedVector4Array array = p_value;
+            r_data = (const uint8_t *)array.ptr();
+            r_size = array.size() * sizeof(Vector4);
+        } break;
+        case Variant::PACKED_COLOR_ARRAY: {
+            const PackedColorArray array = p_value;
+            r_data = (const uint8_t *)array.ptr();
+            r_size = array.size() * sizeof(Color);
+        } break;
+        default: {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+static Variant _array_from_bytes(const PackedByteArray &p_bytes) {
+    Vector<T> array;
+    array.resize(p_bytes.size() / sizeof(T));
+    if (!array.is_empty()) {
+        memcpy(array.ptrw(), p_bytes.ptr(), array.size() * sizeof(T));
+    }
+    return array;
+}
+
+Variant UndoPayloadStore::_make_array(Variant::Type p_type, const PackedByteArray &p_bytes) {
+    switch (p_type) {
+        case Variant::PACKED_BYTE_ARRAY:
+            return p_bytes;
+        case Variant::PACKED_INT32_ARRAY:
+            return _array_from_bytes<int32_t>(p_bytes);
+        case Variant::PACKED_INT64_ARRAY:
+            return _array_from_bytes<int64_t>(p_bytes);
+        case Variant::PACKED_FLOAT32_ARRAY:
+            return _array_from_bytes<float>(p_bytes);
+        case Variant::PACKED_FLOAT64_ARRAY:
+            return _array_from_bytes<double>(p_bytes);
+        case Variant::PACKED_VECTOR2_ARRAY:
+            return _array_from_bytes<Vector2>(p_bytes);
+        case Variant::PACKED_VECTOR3_ARRAY:
+            return _array_from_bytes<Vector3>(p_bytes);
+        case Variant::PACKED_VECTOR4_ARRAY:
+            return _array_from_bytes<Vector4>(p_bytes);
+        case Variant::PACKED_COLOR_ARRAY:
+            return _array_from_bytes<Color>(p_bytes);
+        default:
+            return Variant();
+    }
+}
+
+void UndoPayloadStore::_append_bytes(PackedByteArray &r_bytes, const uint8_t *p_data, int p_size) {
+    if (p_size <= 0) {
+        return;
+    }
+    int offset = r_bytes.size();
+    r_bytes.resize(offset + p_size);
+    memcpy(r_bytes.ptrw() + offset, p_data, p_size);
+}
+
+bool UndoPayloadStore::is_compactable(const Variant &p_old, const Variant &p_new) {
+    if (p_old.get_type() != p_new.get_type()) {
+        return false;
+    }
+
+    const uint8_t *old_data = nullptr;
+    const uint8_t *new_data = nullptr;
+    int old_size = 0;
+    int new_size = 0;
+    if (!_get_bytes(p_old, old_data, old_size) || !_get_bytes(p_new, new_data, new_size)) {
+        return false;
+    }
+    return MAX(old_size, new_size) >= MIN_DELTA_BYTES;
+}
+
+int UndoPayloadStore::begin_group() {
+    return next_group++;
+}
+
+void UndoPayloadStore::release_group(int p_group) {
+    for (List<int>::Element *E = order.front(); E;) {
+        List<int>::Element *next = E->next();
+        const Payload *payload = payloads.getptr(E->get());
+        if (!payload || payload->group == p_group) {
+            _remove(E->get());
+            order.erase(E);
+        }
+        E = next;
+    }
+}
+
+int UndoPayloadStore::store(const Variant &p_old, const Variant &p_new, int p_group) {
+    const uint8_t *old_data = nullptr;
+    const uint8_t *new_data = nullptr;
+    Payload payload;
+    ERR_FAIL_COND_V(!_get_bytes(p_old, old_data, payload.old_size) || !_get_bytes(p_new, new_data, payload.new_size), -1);
+    payload.type = p_old.get_type();
+    payload.group = p_group;
+
+    // Untouched arrays still share one buffer
+    if (old_data == new_data && payload.old_size == payload.new_size) {
+        return -1;
+    }
+
+    int longest = MAX(payload.old_size, payload.new_size);
+    for (int offset = 0; offset < longest; offset += BLOCK_BYTES) {
+        int old_length = CLAMP(payload.old_size - offset, 0, BLOCK_BYTES);
+        int new_length = CLAMP(payload.new_size - offset, 0, BLOCK_BYTES);
+        if (old_length == new_length && memcmp(old_data + offset, new_data + offset, old_length) == 0) {
+            continue;
+        }
+
+        payload.blocks.push_back(offset);
+        _append_bytes(payload.old_bytes, old_data + offset, old_length);
+        _append_bytes(payload.new_bytes, new_data + offset, new_length);
+    }
+
+    if (payload.blocks.is_empty()) {
+        return -1;
+    }
+
+    int id = next_id++;
+    memory_used += payload.get_memory();
+    full_copy_memory += payload.get_full_copy_memory();
+    payloads.insert(id, payload);
+    order.push_back(id);
+    return id;
+}
+
+bool UndoPayloadStore::restore(int p_id, bool p_undo, const Variant &p_current, Variant &r_value) const {
+    const Payload *payload = payloads.getptr(p_id);
+    if (!payload || p_current.get_type() != payload->type) {
+        return false;
+    }
+
+    // The property must still hold the other end of the change, or the unchanged blocks would be wrong
+    const uint8_t *current_data = nullptr;
+    int current_size = 0;
+    _get_bytes(p_current, current_data, current_size);
+    if (current_size != (p_undo ? payload->new_size : payload->old_size)) {
+        return false;
+    }
+
+    int target_size = p_undo ? payload->old_size : payload->new_size;
+    const PackedByteArray &source = p_undo ? payload->old_bytes : payload->new_bytes;
+
+    PackedByteArray bytes;
+    bytes.resize(target_size);
+    uint8_t *w = bytes.ptrw();
+    memcpy(w, current_data, MIN(current_size, target_size));
+
+    int read = 0;
+    for (int i = 0; i < payload->blocks.size(); i++) {
+        int offset = payload->blocks[i];
+        int length = CLAMP(target_size - offset, 0, BLOCK_BYTES);
+        memcpy(w + offset, source.ptr() + read, length);
+        read += length;
+    }
+
+    r_value = _make_array(payload->type, bytes);
+    return true;
+}
+
+void UndoPayloadStore::_remove(int p_id) {
+    const Payload *payload = payloads.getptr(p_id);
+    if (payload) {
+        memory_used -= payload->get_memory();
+        full_copy_memory -= payload->get_full_copy_memory();
+        payloads.erase(p_id);
+    }
+}
+
+void UndoPayloadStore::evict(LocalVector<int> &r_released_groups) {
+    // Whole groups go, oldest first; the newest is kept even alone over the cap,
+    // so the last AI turn can always be undone
+    int newest_group = next_group - 1;
+    while (memory_used > memory_cap && !order.is_empty()) {
+        const Payload *payload = payloads.getptr(order.front()->get());
+        int group = payload ? payload->group : 0;
+        if (group == newest_group) {
+            break;
+        }
+
+        release_group(group);
+        r_released_groups.push_back(group);
+        evicted++;
+    }
+}
+
+void UndoPayloadStore::set_memory_cap(int64_t p_bytes) {
+    memory_cap = MAX(p_bytes, (int64_t)0);
+}
+
+Dictionary UndoPayloadStore::get_stats() const {
+    Dictionary stats;
+    stats["entries"] = payloads.size();
+    stats["memory_bytes"] = memory_used;
+    stats["memory_cap"] = memory_cap;
+    stats["full_copy_bytes"] = full_copy_memory;
+    stats["evicted"] = evicted;
+    return stats;
+}
+
+void UndoPayloadStore::clear() {
+    payloads.clear();
+    order.clear();
+    memory_used = 0;
+    full_copy_memory = 0;
+}
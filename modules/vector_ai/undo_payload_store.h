@@ -0,0 +1,97 @@
+/**************************************************************************/
+/*  undo_payload_store.h                                                  */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/templates/hash_map.h"
+#include "core/templates/list.h"
+#include "core/templates/local_vector.h"
+#include "core/variant/dictionary.h"
+#include "core/variant/variant.h"
+
+// Undo data of large packed-array edits (polygons, curves, tile data) kept as block deltas between
+// the old and new value instead of two full copies. Either end is rebuilt from the other, which
+// the property holds at the time of undo or redo. Entries are grouped by undo action; once the
+// total passes the memory cap the oldest groups are released, and the owner drops the history
+// that still refers to them.
+class UndoPayloadStore {
+public:
+    // Arrays below this size are cheaper to copy than to diff
+    static const int MIN_DELTA_BYTES = 4096;
+    // Granularity of the delta; a changed byte keeps its whole block
+    static const int BLOCK_BYTES = 256;
+
+private:
+    struct Payload {
+        Variant::Type type = Variant::NIL;
+        int group = 0;
+        int old_size = 0;
+        int new_size = 0;
+        // Offsets of the changed blocks, with their bytes on each side, in order
+        PackedInt32Array blocks;
+        PackedByteArray old_bytes;
+        PackedByteArray new_bytes;
+
+        int64_t get_memory() const { return blocks.size() * sizeof(int32_t) + old_bytes.size() + new_bytes.size(); }
+        int64_t get_full_copy_memory() const { return (int64_t)old_size + new_size; }
+    };
+
+    HashMap<int, Payload> payloads;
+    List<int> order;
+    int next_id = 1;
+
+    int next_group = 1;
+
+    int64_t memory_cap = 64 * 1024 * 1024;
+    int64_t memory_used = 0;
+    int64_t full_copy_memory = 0;
+    int evicted = 0;
+
+    static bool _get_bytes(const Variant &p_value, const uint8_t *&r_data, int &r_size);
+    static Variant _make_array(Variant::Type p_type, const PackedByteArray &p_bytes);
+    static void _append_bytes(PackedByteArray &r_bytes, const uint8_t *p_data, int p_size);
+    void _remove(int p_id);
+
+public:
+    static bool is_compactable(const Variant &p_old, const Variant &p_new);
+
+    // One group per undo action; the newest group is never evicted
+    int begin_group();
+    void release_group(int p_group);
+    void evict(LocalVector<int> &r_released_groups);
+
+    // Returns the entry's id, or -1 when the values are equal and nothing needs recording
+    int store(const Variant &p_old, const Variant &p_new, int p_group);
+    bool restore(int p_id, bool p_undo, const Variant &p_current, Variant &r_value) const;
+
+    void set_memory_cap(int64_t p_bytes);
+    Dictionary get_stats() const;
+    void clear();
+};
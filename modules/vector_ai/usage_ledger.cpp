@@ -0,0 +1,310 @@
+/**************************************************************************/
+/*  usage_ledger.cpp                                                      */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "usage_ledger.h"
+
+#include "core/config/project_settings.h"
+#include "core/io/file_access.h"
+#include "core/io/json.h"
+#include "core/os/time.h"
+#include "editor/editor_paths.h"
+
+void UsageLedger::_bind_methods() {
+    ClassDB::bind_static_method("UsageLedger", D_METHOD("get_default_pricing"), &UsageLedger::get_default_pricing);
+    ClassDB::bind_method(D_METHOD("set_pricing", "pricing"), &UsageLedger::set_pricing);
+    ClassDB::bind_method(D_METHOD("get_pricing"), &UsageLedger::get_pricing);
+    ClassDB::bind_method(D_METHOD("estimate_cost", "model", "usage"), &UsageLedger::estimate_cost);
+    ClassDB::bind_method(D_METHOD("record", "model", "usage", "prompt"), &UsageLedger::record);
+    ClassDB::bind_method(D_METHOD("get_session_totals"), &UsageLedger::get_session_totals);
+    ClassDB::bind_method(D_METHOD("get_model_totals", "model"), &UsageLedger::get_model_totals, DEFVAL(String()));
+    ClassDB::bind_method(D_METHOD("get_project_totals", "project"), &UsageLedger::get_project_totals, DEFVAL(String()));
+    ClassDB::bind_method(D_METHOD("get_current_project"), &UsageLedger::get_current_project);
+    ClassDB::bind_method(D_METHOD("get_entries", "limit", "model"), &UsageLedger::get_entries, DEFVAL(50), DEFVAL(String()));
+    ClassDB::bind_method(D_METHOD("get_most_expensive_prompts", "count"), &UsageLedger::get_most_expensive_prompts, DEFVAL(10));
+    ClassDB::bind_method(D_METHOD("reset_session"), &UsageLedger::reset_session);
+}
+
+Dictionary UsageLedger::get_default_pricing() {
+    // USD per million tokens: input, output and cached input
+    Dictionary pricing;
+
+    Dictionary flash_25;
+    flash_25["input"] = 0.15;
+    flash_25["output"] = 0.60;
+    flash_25["cached"] = 0.0375;
+    pricing["gemini-2.5-flash"] = flash_25;
+
+    Dictionary flash_20;
+    flash_20["input"] = 0.10;
+    flash_20["output"] = 0.40;
+    flash_20["cached"] = 0.025;
+    pricing["gemini-2.0-flash"] = flash_20;
+
+    Dictionary flash_lite_20;
+    flash_lite_20["input"] = 0.075;
+    flash_lite_20["output"] = 0.30;
+    flash_lite_20["cached"] = 0.01875;
+    pricing["gemini-2.0-flash-lite"] = flash_lite_20;
+
+    Dictionary pro_15;
+    pro_15["input"] = 1.25;
+    pro_15["output"] = 5.00;
+    pro_15["cached"] = 0.3125;
+    pricing["gemini-1.5-pro"] = pro_15;
+
+    Dictionary flash_15;
+    flash_15["input"] = 0.075;
+    flash_15["output"] = 0.30;
+    flash_15["cached"] = 0.01875;
+    pricing["gemini-1.5-flash"] = flash_15;
+
+    Dictionary pro_10;
+    pro_10["input"] = 0.50;
+    pro_10["output"] = 1.50;
+    pro_10["cached"] = 0.50;
+    pricing["gemini-1.0-pro"] = pro_10;
+
+    return pricing;
+}
+
+String UsageLedger::_get_ledger_path() const {
+    return EditorPaths::get_singleton()->get_config_dir().path_join("vector_ai_usage_ledger.json");
+}
+
+String UsageLedger::_get_project_key() const {
+    String project_name = GLOBAL_GET("application/config/name");
+    String project_path = ProjectSettings::get_singleton()->get_resource_path();
+    return project_name.is_empty() ? project_path : project_name + " (" + project_path + ")";
+}
+
+void UsageLedger::_load() {
+    if (loaded) {
+        return;
+    }
+    loaded = true;
+
+    Ref<FileAccess> f = FileAccess::open(_get_ledger_path(), FileAccess::READ);
+    if (f.is_null()) {
+        return;
+    }
+
+    JSON json;
+    if (json.parse(f->get_as_text()) != OK || json.get_data().get_type() != Variant::DICTIONARY) {
+        return;
+    }
+
+    Dictionary data = json.get_data();
+    model_totals = data.get("models", Dictionary());
+    project_totals = data.get("projects", Dictionary());
+    entries = data.get("entries", Array());
+}
+
+void UsageLedger::_save() {
+    Ref<FileAccess> f = FileAccess::open(_get_ledger_path(), FileAccess::WRITE);
+    if (f.is_null()) {
+        return;
+    }
+
+    Dictionary data;
+    data["models"] = model_totals;
+    data["projects"] = project_totals;
+    data["entries"] = entries;
+
+    JSON json;
+    f->store_string(json.stringify(data, "  "));
+}
+
+Dictionary UsageLedger::_make_totals() {
+    Dictionary totals;
+    totals["requests"] = 0;
+    totals["prompt_tokens"] = 0;
+    totals["cached_tokens"] = 0;
+    totals["uncached_prompt_tokens"] = 0;
+    totals["candidates_tokens"] = 0;
+    totals["total_tokens"] = 0;
+    totals["cost"] = 0.0;
+    return totals;
+}
+
+void UsageLedger::_accumulate(Dictionary &r_totals, const Dictionary &p_entry) {
+    if (r_totals.is_empty()) {
+        r_totals = _make_totals();
+    }
+
+    r_totals["requests"] = (int64_t)r_totals["requests"] + 1;
+    r_totals["prompt_tokens"] = (int64_t)r_totals["prompt_tokens"] + (int64_t)p_entry["prompt_tokens"];
+    r_totals["cached_tokens"] = (int64_t)r_totals["cached_tokens"] + (int64_t)p_entry["cached_tokens"];
+    r_totals["uncached_prompt_tokens"] = (int64_t)r_totals["uncached_prompt_tokens"] + (int64_t)p_entry["prompt_tokens"] - (int64_t)p_entry["cached_tokens"];
+    r_totals["candidates_tokens"] = (int64_t)r_totals["candidates_tokens"] + (int64_t)p_entry["candidates_tokens"];
+    r_totals["total_tokens"] = (int64_t)r_totals["total_tokens"] + (int64_t)p_entry["total_tokens"];
+    r_totals["cost"] = (double)r_totals["cost"] + (double)p_entry["cost"];
+}
+
+bool UsageLedger::_compare_cost(const Variant &p_a, const Variant &p_b) {
+    return (double)Dictionary(p_a)["cost"] > (double)Dictionary(p_b)["cost"];
+}
+
+Dictionary UsageLedger::_get_model_pricing(const String &p_model) const {
+    // Exact match first, then the longest known prefix (e.g. dated preview builds)
+    if (pricing.has(p_model)) {
+        return pricing[p_model];
+    }
+
+    String best_match;
+    Array keys = pricing.keys();
+    for (int i = 0; i < keys.size(); i++) {
+        String key = keys[i];
+        if (p_model.begins_with(key) && key.length() > best_match.length()) {
+            best_match = key;
+        }
+    }
+
+    return best_match.is_empty() ? Dictionary() : Dictionary(pricing[best_match]);
+}
+
+void UsageLedger::set_pricing(const Dictionary &p_pricing) {
+    pricing = get_default_pricing();
+    pricing.merge(p_pricing, true);
+}
+
+Dictionary UsageLedger::get_pricing() const {
+    return pricing;
+}
+
+double UsageLedger::estimate_cost(const String &p_model, const Dictionary &p_usage) const {
+    // Proxies may report the billed cost directly
+    if (p_usage.has("cost")) {
+        return p_usage["cost"];
+    }
+
+    Dictionary model_pricing = _get_model_pricing(p_model);
+    if (model_pricing.is_empty()) {
+        return 0.0;
+    }
+
+    int64_t prompt_tokens = p_usage.get("prompt_tokens", 0);
+    int64_t cached_tokens = p_usage.get("cached_tokens", 0);
+    int64_t candidates_tokens = p_usage.get("candidates_tokens", 0);
+
+    double cost = (prompt_tokens - cached_tokens) * (double)model_pricing.get("input", 0.0);
+    cost += cached_tokens * (double)model_pricing.get("cached", 0.0);
+    cost += candidates_tokens * (double)model_pricing.get("output", 0.0);
+    return cost / 1000000.0;
+}
+
+Dictionary UsageLedger::record(const String &p_model, const Dictionary &p_usage, const String &p_prompt) {
+    _load();
+
+    Dictionary entry;
+    entry["time"] = Time::get_singleton()->get_unix_time_from_system();
+    entry["model"] = p_model;
+    entry["project"] = _get_project_key();
+    entry["source"] = p_usage.get("source", "api");
+    entry["prompt_tokens"] = p_usage.get("prompt_tokens", 0);
+    entry["cached_tokens"] = p_usage.get("cached_tokens", 0);
+    entry["candidates_tokens"] = p_usage.get("candidates_tokens", 0);
+    entry["total_tokens"] = p_usage.get("total_tokens", (int64_t)p_usage.get("prompt_tokens", 0) + (int64_t)p_usage.get("candidates_tokens", 0));
+    entry["cost"] = estimate_cost(p_model, p_usage);
+    entry["prompt"] = p_prompt.left(120);
+
+    _accumulate(session_totals, entry);
+
+    Dictionary model_entry = model_totals.get(p_model, Dictionary());
+    _accumulate(model_entry, entry);
+    model_totals[p_model] = model_entry;
+
+    Dictionary project_entry = project_totals.get(entry["project"], Dictionary());
+    _accumulate(project_entry, entry);
+    project_totals[entry["project"]] = project_entry;
+
+    entries.push_back(entry);
+    while (entries.size() > MAX_ENTRIES) {
+        entries.remove_at(0);
+    }
+
+    _save();
+    return entry;
+}
+
+Dictionary UsageLedger::get_session_totals() const {
+    return session_totals.is_empty() ? _make_totals() : session_totals;
+}
+
+Dictionary UsageLedger::get_model_totals(const String &p_model) {
+    _load();
+    if (p_model.is_empty()) {
+        return model_totals;
+    }
+    return model_totals.get(p_model, _make_totals());
+}
+
+Dictionary UsageLedger::get_project_totals(const String &p_project) {
+    _load();
+    if (p_project.is_empty()) {
+        return project_totals.get(_get_project_key(), _make_totals());
+    }
+    return project_totals.get(p_project, _make_totals());
+}
+
+String UsageLedger::get_current_project() const {
+    return _get_project_key();
+}
+
+Array UsageLedger::get_entries(int p_limit, const String &p_model) {
+    _load();
+
+    Array result;
+    for (int i = entries.size() - 1; i >= 0 && (p_limit <= 0 || result.size() < p_limit); i--) {
+        Dictionary entry = entries[i];
+        if (p_model.is_empty() || String(entry["model"]) == p_model) {
+            result.push_back(entry);
+        }
+    }
+    return result;
+}
+
+Array UsageLedger::get_most_expensive_prompts(int p_count) {
+    _load();
+
+    Array sorted = entries.duplicate();
+    sorted.sort_custom(callable_mp_static(&UsageLedger::_compare_cost));
+    return sorted.slice(0, p_count);
+}
+
+void UsageLedger::reset_session() {
+    session_totals = Dictionary();
+}
+
+UsageLedger::UsageLedger() {
+    pricing = get_default_pricing();
+}
+
+UsageLedger::~UsageLedger() {
+}
@@ -0,0 +1,81 @@
+/**************************************************************************/
+/*  usage_ledger.h                                                        */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/object/ref_counted.h"
+
+class UsageLedger : public RefCounted {
+    GDCLASS(UsageLedger, RefCounted);
+
+private:
+    // Recent entries kept on disk for per-prompt queries
+    static const int MAX_ENTRIES = 500;
+
+    Dictionary session_totals;
+    Dictionary model_totals;
+    Dictionary project_totals;
+    Array entries;
+    Dictionary pricing;
+    bool loaded = false;
+
+    String _get_ledger_path() const;
+    String _get_project_key() const;
+    void _load();
+    void _save();
+
+    static Dictionary _make_totals();
+    static void _accumulate(Dictionary &r_totals, const Dictionary &p_entry);
+    static bool _compare_cost(const Variant &p_a, const Variant &p_b);
+    Dictionary _get_model_pricing(const String &p_model) const;
+
+protected:
+    static void _bind_methods();
+
+public:
+    static Dictionary get_default_pricing();
+
+    void set_pricing(const Dictionary &p_pricing);
+    Dictionary get_pricing() const;
+
+    double estimate_cost(const String &p_model, const Dictionary &p_usage) const;
+    Dictionary record(const String &p_model, const Dictionary &p_usage, const String &p_prompt);
+
+    Dictionary get_session_totals() const;
+    Dictionary get_model_totals(const String &p_model = String());
+    Dictionary get_project_totals(const String &p_project = String());
+    String get_current_project() const;
+    Array get_entries(int p_limit = 50, const String &p_model = String());
+    Array get_most_expensive_prompts(int p_count = 10);
+    void reset_session();
+
+    UsageLedger();
+    ~UsageLedger();
+};
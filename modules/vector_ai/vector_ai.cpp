@@ -32,13 +32,24 @@
 
 #include "editor/editor_node.h"
 #include "editor/editor_scale.h"
+#include "editor/gui/editor_toaster.h"
 #include "scene/gui/button.h"
 #include "scene/gui/shortcut.h"
 
 void VectorAI::_notification(int p_what) {
     switch (p_what) {
         case NOTIFICATION_READY: {
+            // Only the toolbar button exists at startup; the dock is built on first use
             _add_vector_ai_button();
+            callable_mp(this, &VectorAI::_start_background_services).call_deferred();
+
+            // Command-line batch runs start once the editor is up
+            String batch_job = VectorAIBatch::get_cmdline_job_file();
+            if (!batch_job.is_empty()) {
+                batch = memnew(VectorAIBatch);
+                add_child(batch);
+                callable_mp(batch, &VectorAIBatch::start).call_deferred(batch_job, true);
+            }
         } break;
     }
 }
@@ -76,12 +87,92 @@ void VectorAI::_add_vector_ai_button() {
 
     // Add the button to the editor
     EditorNode::get_singleton()->add_control_to_container(EditorNode::CONTAINER_TOOLBAR, vector_ai_button);
+}
+
+void VectorAI::_ensure_services() {
+    if (scene_analyzer) {
+        return;
+    }
+
+    scene_analyzer = memnew(SceneAnalyzer);
+    scene_modifier = memnew(SceneModifier);
+    add_child(scene_analyzer);
+    add_child(scene_modifier);
+
+    // Region selectors in rule modifications query the same index as the analyzer
+    scene_modifier->set_spatial_index(scene_analyzer->get_spatial_index());
+
+    // Applied AI batches, kept per project for replay
+    journal.instantiate();
+
+    // Project-wide retrieval index; indexing starts when enabled in the settings
+    project_index.instantiate();
+
+    // Local JSON-RPC endpoint for godot-mcp; started from the settings when enabled
+    rpc_server = memnew(VectorAIRPCServer);
+    rpc_server->set_components(scene_analyzer, scene_modifier);
+    rpc_server->set_journal(journal);
+    add_child(rpc_server);
+
+    _apply_settings(GeminiClient::get_shared_settings());
+}
+
+void VectorAI::_ensure_dock() {
+    if (dock) {
+        return;
+    }
+
+    _ensure_services();
 
-    // Create the Vector AI dock
     dock = memnew(VectorAIDock);
+    dock->set_services(scene_analyzer, scene_modifier, journal, project_index);
+    dock->set_settings_handler(callable_mp(this, &VectorAI::_apply_settings));
     EditorNode::get_singleton()->add_control_to_dock(EditorNode::DOCK_SLOT_RIGHT_UL, dock);
 }
 
+void VectorAI::_start_background_services() {
+    // Only the RPC server and what it uses; the dock and its HTTP client wait for the first click
+    Dictionary settings = GeminiClient::get_shared_settings();
+    if (settings.get("rpc_enabled", false)) {
+        _ensure_services();
+    }
+}
+
+void VectorAI::_apply_settings(const Dictionary &p_settings) {
+    scene_analyzer->set_float_precision(p_settings.get("float_precision", 3));
+    scene_modifier->set_undo_memory_cap((int64_t)(int)p_settings.get("undo_memory_cap_mb", 64) * 1024 * 1024);
+    _update_rpc_server(p_settings);
+
+    if (p_settings.get("retrieval_enabled", false)) {
+        project_index->start();
+    } else {
+        project_index->stop();
+    }
+}
+
+void VectorAI::_update_rpc_server(const Dictionary &p_settings) {
+    bool enabled = p_settings.get("rpc_enabled", false);
+    int port = p_settings.get("rpc_port", 9510);
+
+    if (!enabled) {
+        rpc_server->stop();
+        return;
+    }
+
+    if (rpc_server->is_running() && rpc_server->get_port() == port) {
+        return;
+    }
+
+    Error err = rpc_server->start(port);
+    if (err != OK) {
+        String message = vformat("Vector AI: Could not start the local RPC server on port %d (error %d).", port, err);
+        WARN_PRINT(message);
+        if (EditorToaster::get_singleton()) {
+            EditorToaster::get_singleton()->popup_str(message, EditorToaster::SEVERITY_WARNING);
+        }
+    }
+}
+
 void VectorAI::_on_vector_ai_button_pressed() {
     if (is_dock_visible()) {
         hide_dock();
@@ -91,9 +182,8 @@ void VectorAI::_on_vector_ai_button_pressed() {
 }
 
 void VectorAI::show_dock() {
-    if (dock) {
-        dock->set_visible(true);
-    }
+    _ensure_dock();
+    dock->set_visible(true);
 }
 
 void VectorAI::hide_dock() {
@@ -110,4 +200,8 @@ VectorAI::VectorAI() {
 }
 
 VectorAI::~VectorAI() {
+    // The index worker must not outlive the editor
+    if (project_index.is_valid()) {
+        project_index->stop();
+    }
 }
@@ -32,7 +32,13 @@
 
 #include "core/object/ref_counted.h"
 #include "scene/main/node.h"
+#include "modification_journal.h"
+#include "project_index.h"
+#include "scene_analyzer.h"
+#include "scene_modifier.h"
+#include "vector_ai_batch.h"
 #include "vector_ai_dock.h"
+#include "vector_ai_rpc_server.h"
 
 class VectorAI : public Node {
     GDCLASS(VectorAI, Node);
@@ -40,8 +46,21 @@ class VectorAI : public Node {
 private:
     VectorAIDock *dock = nullptr;
     Button *vector_ai_button = nullptr;
+    VectorAIBatch *batch = nullptr;
+
+    // Shared by the dock and the RPC server; none of these talk to the network
+    SceneAnalyzer *scene_analyzer = nullptr;
+    SceneModifier *scene_modifier = nullptr;
+    VectorAIRPCServer *rpc_server = nullptr;
+    Ref<ModificationJournal> journal;
+    Ref<ProjectIndex> project_index;
 
     void _add_vector_ai_button();
+    void _ensure_services();
+    void _ensure_dock();
+    void _start_background_services();
+    void _apply_settings(const Dictionary &p_settings);
+    void _update_rpc_server(const Dictionary &p_settings);
     void _on_vector_ai_button_pressed();
 
 protected:
@@ -0,0 +1,436 @@
+/**************************************************************************/
+/*  vector_ai_batch.cpp                                                   */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "vector_ai_batch.h"
+
+#include "core/io/file_access.h"
+#include "core/io/json.h"
+#include "core/io/resource_loader.h"
+#include "core/io/resource_saver.h"
+#include "core/os/os.h"
+#include "core/os/time.h"
+#include "editor/editor_file_system.h"
+#include "gemini_client.h"
+#include "scene/main/scene_tree.h"
+#include "scene/resources/packed_scene.h"
+#include "scene_analyzer.h"
+#include "scene_modifier.h"
+
+void VectorAIBatch::_notification(int p_what) {
+    switch (p_what) {
+        case NOTIFICATION_PROCESS: {
+            _poll();
+        } break;
+    }
+}
+
+void VectorAIBatch::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("start", "job_file", "quit_when_done"), &VectorAIBatch::start);
+    ClassDB::bind_method(D_METHOD("is_running"), &VectorAIBatch::is_running);
+}
+
+String VectorAIBatch::get_cmdline_job_file() {
+    // godot --headless --editor --path <project> -- --vector-ai-batch=<job.json>
+    for (const String &arg : OS::get_singleton()->get_cmdline_user_args()) {
+        if (arg.begins_with(CMDLINE_ARG)) {
+            return arg.substr(strlen(CMDLINE_ARG)).unquote();
+        }
+    }
+    return String();
+}
+
+Error VectorAIBatch::_load_job_file(const String &p_path) {
+    Ref<FileAccess> f = FileAccess::open(p_path, FileAccess::READ);
+    ERR_FAIL_COND_V_MSG(f.is_null(), ERR_FILE_CANT_OPEN, "Vector AI batch: cannot open job file " + p_path);
+
+    JSON json;
+    ERR_FAIL_COND_V_MSG(json.parse(f->get_as_text()) != OK || json.get_data().get_type() != Variant::DICTIONARY, ERR_PARSE_ERROR, "Vector AI batch: job file is not a JSON object.");
+
+    Dictionary job_data = json.get_data();
+    prompt = job_data.get("prompt", "");
+    report_path = job_data.get("report", "res://vector_ai_batch_report.json");
+    output_dir = job_data.get("output_dir", "");
+    dry_run = job_data.get("dry_run", false);
+    max_in_flight = CLAMP(int(job_data.get("max_in_flight", 4)), 1, 32);
+    ERR_FAIL_COND_V_MSG(prompt.is_empty(), ERR_INVALID_DATA, "Vector AI batch: the job file has no prompt.");
+
+    // Scenes come inline, from a list file with one path per line, or both
+    PackedStringArray scene_paths;
+    Array scenes = job_data.get("scenes", Array());
+    for (int i = 0; i < scenes.size(); i++) {
+        scene_paths.push_back(scenes[i]);
+    }
+
+    String scene_list = job_data.get("scene_list", "");
+    if (!scene_list.is_empty()) {
+        Ref<FileAccess> list = FileAccess::open(scene_list, FileAccess::READ);
+        ERR_FAIL_COND_V_MSG(list.is_null(), ERR_FILE_CANT_OPEN, "Vector AI batch: cannot open scene list " + scene_list);
+        while (!list->eof_reached()) {
+            String line = list->get_line().strip_edges();
+            if (!line.is_empty() && !line.begins_with("#")) {
+                scene_paths.push_back(line);
+            }
+        }
+    }
+
+    jobs.clear();
+    jobs.resize(scene_paths.size());
+    for (int i = 0; i < scene_paths.size(); i++) {
+        String scene_path = scene_paths[i];
+        if (!scene_path.begins_with("res://")) {
+            scene_path = "res://" + scene_path;
+        }
+        jobs[i].scene_path = scene_path;
+        jobs[i].output_path = output_dir.is_empty() ? scene_path : output_dir.path_join(scene_path.get_file());
+    }
+
+    return OK;
+}
+
+Error VectorAIBatch::start(const String &p_job_file, bool p_quit_when_done) {
+    ERR_FAIL_COND_V_MSG(running, ERR_BUSY, "Vector AI batch: a batch is already running.");
+    ERR_FAIL_COND_V(!is_inside_tree(), ERR_UNCONFIGURED);
+
+    quit_when_done = p_quit_when_done;
+    Error err = _load_job_file(p_job_file);
+    if (err != OK) {
+        if (quit_when_done) {
+            SceneTree::get_singleton()->quit(1);
+        }
+        return err;
+    }
+
+    if (!scene_analyzer) {
+        scene_analyzer = memnew(SceneAnalyzer);
+        add_child(scene_analyzer);
+        scene_modifier = memnew(SceneModifier);
+        add_child(scene_modifier);
+    }
+
+    // One client per request slot; each keeps its own HTTPRequest
+    while ((int)clients.size() < max_in_flight) {
+        ClientSlot slot;
+        slot.client = memnew(GeminiClient);
+        add_child(slot.client);
+        clients.push_back(slot);
+    }
+    scene_analyzer->set_float_precision(clients[0].client->load_settings().get("float_precision", 3));
+
+    print_line(vformat("Vector AI batch: %d scenes, %d requests in flight%s.", jobs.size(), max_in_flight, dry_run ? ", dry run" : ""));
+
+    running = true;
+    start_usec = OS::get_singleton()->get_ticks_usec();
+    set_process(true);
+
+    return OK;
+}
+
+bool VectorAIBatch::is_running() const {
+    return running;
+}
+
+void VectorAIBatch::_load_job(int p_index) {
+    const Job &job = jobs[p_index];
+    TaskResult &result = jobs[p_index].task;
+    uint64_t begin_usec = OS::get_singleton()->get_ticks_usec();
+
+    Ref<PackedScene> packed_scene = ResourceLoader::load(job.scene_path, "PackedScene");
+    if (packed_scene.is_null()) {
+        result.error = "Failed to load scene.";
+        return;
+    }
+
+    // Edit state keeps instanced sub-scenes as references when saved back
+    result.root = packed_scene->instantiate(PackedScene::GEN_EDIT_STATE_INSTANCE);
+    if (!result.root) {
+        result.error = "Failed to instantiate scene.";
+        return;
+    }
+
+    result.scene_info = scene_analyzer->analyze_scene(result.root);
+    result.msec = (OS::get_singleton()->get_ticks_usec() - begin_usec) / 1000.0;
+}
+
+void VectorAIBatch::_save_job(int p_index) {
+    const Job &job = jobs[p_index];
+    TaskResult &result = jobs[p_index].task;
+    uint64_t begin_usec = OS::get_singleton()->get_ticks_usec();
+
+    // The main thread handed the root over in task.root
+    Dictionary apply_result = scene_modifier->apply_modifications_to(result.root, job.modifications);
+    result.applied = apply_result["applied"];
+
+    // A partially applied change list is not saved
+    if (!bool(apply_result["success"])) {
+        result.error = apply_result["error"];
+    } else if (!dry_run && result.applied > 0) {
+        Ref<PackedScene> packed_scene;
+        packed_scene.instantiate();
+        Error err = packed_scene->pack(result.root);
+        if (err == OK) {
+            err = ResourceSaver::save(packed_scene, job.output_path);
+        }
+        if (err != OK) {
+            result.error = vformat("Failed to save scene (error %d).", err);
+        }
+    }
+
+    memdelete(result.root);
+    result.root = nullptr;
+    result.msec = (OS::get_singleton()->get_ticks_usec() - begin_usec) / 1000.0;
+}
+
+void VectorAIBatch::_start_task(int p_index, JobState p_state) {
+    Job &job = jobs[p_index];
+    job.state = p_state;
+    job.task = TaskResult();
+
+    WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+    if (p_state == JOB_LOADING) {
+        job.task_id = pool->add_template_task(this, &VectorAIBatch::_load_job, p_index, false, "Vector AI batch load");
+    } else {
+        job.task.root = job.root;
+        job.root = nullptr;
+        job.task_id = pool->add_template_task(this, &VectorAIBatch::_save_job, p_index, false, "Vector AI batch save");
+    }
+}
+
+void VectorAIBatch::_finish_task(Job &p_job) {
+    WorkerThreadPool::get_singleton()->wait_for_task_completion(p_job.task_id);
+    p_job.task_id = WorkerThreadPool::INVALID_TASK_ID;
+
+    // The worker is done with the job, so its results can be published
+    TaskResult &result = p_job.task;
+    if (p_job.state == JOB_LOADING) {
+        p_job.root = result.root;
+        p_job.scene_info = result.scene_info;
+        p_job.load_msec = result.msec;
+    } else {
+        p_job.applied = result.applied;
+        p_job.save_msec = result.msec;
+    }
+    String error = result.error;
+    p_job.task = TaskResult();
+
+    if (!error.is_empty()) {
+        _fail(p_job, error);
+        return;
+    }
+
+    if (p_job.state == JOB_LOADING) {
+        p_job.state = JOB_READY;
+    } else {
+        p_job.state = JOB_DONE;
+        print_line(vformat("Vector AI batch: %s (%d changes).", p_job.scene_path, p_job.applied));
+        _write_report(false);
+    }
+}
+
+void VectorAIBatch::_fail(Job &p_job, const String &p_error) {
+    p_job.state = JOB_FAILED;
+    p_job.error = p_error;
+    p_job.scene_info = String();
+    if (p_job.root) {
+        memdelete(p_job.root);
+        p_job.root = nullptr;
+    }
+
+    print_error(vformat("Vector AI batch: %s failed: %s", p_job.scene_path, p_error));
+    _write_report(false);
+}
+
+void VectorAIBatch::_poll() {
+    if (!running) {
+        return;
+    }
+
+    // Loading before the first scan has finished would miss imported resources
+    if (EditorFileSystem::get_singleton() && EditorFileSystem::get_singleton()->is_scanning()) {
+        return;
+    }
+
+    WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+    int loaded_ahead = 0;
+    int remaining = 0;
+
+    for (Job &job : jobs) {
+        if ((job.state == JOB_LOADING || job.state == JOB_SAVING) && pool->is_task_completed(job.task_id)) {
+            _finish_task(job);
+        }
+
+        if (job.state == JOB_LOADING || job.state == JOB_READY) {
+            loaded_ahead++;
+        }
+        if (job.state != JOB_DONE && job.state != JOB_FAILED) {
+            remaining++;
+        }
+    }
+
+    if (remaining == 0) {
+        _finish();
+        return;
+    }
+
+    // Load ahead of the request slots, but not so far that every scene sits in memory
+    for (uint32_t i = 0; i < jobs.size() && loaded_ahead < max_in_flight * 2; i++) {
+        if (jobs[i].state == JOB_PENDING) {
+            _start_task(i, JOB_LOADING);
+            loaded_ahead++;
+        }
+    }
+
+    for (ClientSlot &slot : clients) {
+        if (slot.job != -1) {
+            continue;
+        }
+
+        for (uint32_t i = 0; i < jobs.size(); i++) {
+            Job &job = jobs[i];
+            if (job.state != JOB_READY) {
+                continue;
+            }
+
+            job.state = JOB_REQUESTING;
+            job.request_start_usec = OS::get_singleton()->get_ticks_usec();
+            slot.job = i;
+
+            String scene_info = job.scene_info;
+            job.scene_info = String();
+            slot.client->send_request(prompt, scene_info, callable_mp(this, &VectorAIBatch::_on_job_response).bind((int)i));
+            break;
+        }
+    }
+}
+
+void VectorAIBatch::_on_job_response(const Dictionary &p_response, const String &p_error, int p_index) {
+    for (ClientSlot &slot : clients) {
+        if (slot.job == p_index) {
+            slot.job = -1;
+        }
+    }
+
+    Job &job = jobs[p_index];
+    job.request_msec = (OS::get_singleton()->get_ticks_usec() - job.request_start_usec) / 1000.0;
+
+    if (!p_error.is_empty()) {
+        _fail(job, p_error);
+        return;
+    }
+
+    job.modifications = p_response.get("modifications", Dictionary());
+    Array list = job.modifications.get("list", Array());
+    if (list.is_empty()) {
+        memdelete(job.root);
+        job.root = nullptr;
+        job.state = JOB_DONE;
+        _write_report(false);
+        return;
+    }
+
+    _start_task(p_index, JOB_SAVING);
+}
+
+void VectorAIBatch::_write_report(bool p_finished) const {
+    static const char *state_names[] = { "pending", "loading", "ready", "requesting", "saving", "done", "failed" };
+
+    Array job_reports;
+    int done = 0;
+    int failed = 0;
+    for (const Job &job : jobs) {
+        Dictionary entry;
+        entry["scene"] = job.scene_path;
+        entry["status"] = state_names[job.state];
+        entry["applied"] = job.applied;
+        entry["load_ms"] = job.load_msec;
+        entry["request_ms"] = job.request_msec;
+        entry["save_ms"] = job.save_msec;
+        if (job.output_path != job.scene_path) {
+            entry["output"] = job.output_path;
+        }
+        if (!job.error.is_empty()) {
+            entry["error"] = job.error;
+        }
+        job_reports.push_back(entry);
+
+        done += job.state == JOB_DONE;
+        failed += job.state == JOB_FAILED;
+    }
+
+    Dictionary report;
+    report["prompt"] = prompt;
+    report["finished"] = p_finished;
+    report["dry_run"] = dry_run;
+    report["elapsed_ms"] = (OS::get_singleton()->get_ticks_usec() - start_usec) / 1000.0;
+    report["updated"] = Time::get_singleton()->get_datetime_string_from_system();
+    report["total"] = jobs.size();
+    report["done"] = done;
+    report["failed"] = failed;
+    report["jobs"] = job_reports;
+
+    // Rewritten as jobs complete so progress can be followed from outside
+    Ref<FileAccess> f = FileAccess::open(report_path, FileAccess::WRITE);
+    ERR_FAIL_COND_MSG(f.is_null(), "Vector AI batch: cannot write report " + report_path);
+    f->store_string(JSON::stringify(report, "    "));
+}
+
+void VectorAIBatch::_finish() {
+    running = false;
+    set_process(false);
+    _write_report(true);
+
+    int failed = 0;
+    for (const Job &job : jobs) {
+        failed += job.state == JOB_FAILED;
+    }
+
+    print_line(vformat("Vector AI batch: finished %d scenes, %d failed, in %.1f s. Report: %s", jobs.size(), failed, (OS::get_singleton()->get_ticks_usec() - start_usec) / 1000000.0, report_path));
+
+    if (quit_when_done) {
+        SceneTree::get_singleton()->quit(failed > 0 ? 1 : 0);
+    }
+}
+
+VectorAIBatch::VectorAIBatch() {
+}
+
+VectorAIBatch::~VectorAIBatch() {
+    // Tasks reference the jobs; let them finish before the jobs go away
+    for (Job &job : jobs) {
+        if (job.task_id != WorkerThreadPool::INVALID_TASK_ID) {
+            WorkerThreadPool::get_singleton()->wait_for_task_completion(job.task_id);
+        }
+        if (job.task.root) {
+            memdelete(job.task.root);
+        }
+        if (job.root) {
+            memdelete(job.root);
+        }
+    }
+}
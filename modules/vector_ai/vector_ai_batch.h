@@ -0,0 +1,138 @@
+/**************************************************************************/
+/*  vector_ai_batch.h                                                     */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/object/worker_thread_pool.h"
+#include "core/templates/local_vector.h"
+#include "scene/main/node.h"
+
+class GeminiClient;
+class SceneAnalyzer;
+class SceneModifier;
+
+// Runs one prompt over many scenes without opening them in the editor.
+// Loading, analysis and saving run on the worker pool; model requests are
+// issued from the main thread with a bounded number in flight.
+//
+//   godot --headless --editor --path <project> -- --vector-ai-batch=<job.json>
+//
+// The job file holds "prompt", "scenes" (array) and/or "scene_list" (file
+// with one path per line), plus optional "max_in_flight", "output_dir",
+// "dry_run" and "report" (defaults to res://vector_ai_batch_report.json).
+class VectorAIBatch : public Node {
+    GDCLASS(VectorAIBatch, Node);
+
+public:
+    static constexpr const char *CMDLINE_ARG = "--vector-ai-batch=";
+
+private:
+    enum JobState {
+        JOB_PENDING,
+        JOB_LOADING,
+        JOB_READY,
+        JOB_REQUESTING,
+        JOB_SAVING,
+        JOB_DONE,
+        JOB_FAILED,
+    };
+
+    // Only the worker task writes this; the main thread reads it once the task has completed
+    struct TaskResult {
+        Node *root = nullptr;
+        String scene_info;
+        String error;
+        int applied = 0;
+        double msec = 0.0;
+    };
+
+    struct Job {
+        String scene_path;
+        String output_path;
+        JobState state = JOB_PENDING;
+        WorkerThreadPool::TaskID task_id = WorkerThreadPool::INVALID_TASK_ID;
+        TaskResult task;
+
+        // Main thread only
+        Node *root = nullptr;
+        String scene_info;
+        Dictionary modifications;
+        String error;
+        int applied = 0;
+
+        double load_msec = 0.0;
+        double request_msec = 0.0;
+        double save_msec = 0.0;
+        uint64_t request_start_usec = 0;
+    };
+
+    struct ClientSlot {
+        GeminiClient *client = nullptr;
+        int job = -1;
+    };
+
+    LocalVector<Job> jobs;
+    LocalVector<ClientSlot> clients;
+    SceneAnalyzer *scene_analyzer = nullptr;
+    SceneModifier *scene_modifier = nullptr;
+
+    String prompt;
+    String report_path;
+    String output_dir;
+    bool dry_run = false;
+    int max_in_flight = 4;
+    bool quit_when_done = false;
+    bool running = false;
+    uint64_t start_usec = 0;
+
+    Error _load_job_file(const String &p_path);
+    void _load_job(int p_index);
+    void _save_job(int p_index);
+    void _start_task(int p_index, JobState p_state);
+    void _poll();
+    void _finish_task(Job &p_job);
+    void _fail(Job &p_job, const String &p_error);
+    void _on_job_response(const Dictionary &p_response, const String &p_error, int p_index);
+    void _write_report(bool p_finished) const;
+    void _finish();
+
+protected:
+    void _notification(int p_what);
+    static void _bind_methods();
+
+public:
+    static String get_cmdline_job_file();
+
+    Error start(const String &p_job_file, bool p_quit_when_done);
+    bool is_running() const;
+
+    VectorAIBatch();
+    ~VectorAIBatch();
+};
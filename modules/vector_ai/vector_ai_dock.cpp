@@ -32,15 +32,18 @@
 
 #include "editor/editor_node.h"
 #include "editor/editor_scale.h"
+#include "editor/editor_settings.h"
 #include "scene/gui/label.h"
 #include "scene/gui/separator.h"
+#include "vector_ai_profiler.h"
+#include "vector_ai_tracer.h"
 
 void VectorAIDock::_notification(int p_what) {
     switch (p_what) {
         case NOTIFICATION_READY: {
+            // The settings window is built the first time it is opened
             _setup_ui();
-            _setup_settings_window();
-            _load_settings();
+            gemini_client->load_settings();
             _add_system_message("Welcome to Vector AI! I can help you modify your Godot scenes based on natural language prompts. Type your request and press Enter or click Send.");
         } break;
     }
@@ -54,7 +57,11 @@ void VectorAIDock::_bind_methods() {
     ClassDB::bind_method(D_METHOD("_on_save_settings_pressed"), &VectorAIDock::_on_save_settings_pressed);
     ClassDB::bind_method(D_METHOD("_on_cancel_settings_pressed"), &VectorAIDock::_on_cancel_settings_pressed);
     ClassDB::bind_method(D_METHOD("_on_dev_mode_toggled"), &VectorAIDock::_on_dev_mode_toggled);
+    ClassDB::bind_method(D_METHOD("_on_context_scope_selected"), &VectorAIDock::_on_context_scope_selected);
     ClassDB::bind_method(D_METHOD("_on_gemini_response"), &VectorAIDock::_on_gemini_response);
+    ClassDB::bind_method(D_METHOD("_on_modification_streamed"), &VectorAIDock::_on_modification_streamed);
+    ClassDB::bind_method(D_METHOD("_on_replay_menu_about_to_popup"), &VectorAIDock::_on_replay_menu_about_to_popup);
+    ClassDB::bind_method(D_METHOD("_on_replay_id_pressed"), &VectorAIDock::_on_replay_id_pressed);
 }
 
 void VectorAIDock::_setup_ui() {
@@ -91,6 +98,25 @@ void VectorAIDock::_setup_ui() {
     title_label->set_h_size_flags(SIZE_EXPAND_FILL);
     title_container->add_child(title_label);
 
+    // Which part of the scene is sent as context
+    scope_option = memnew(OptionButton);
+    scope_option->add_item("Scene", SceneAnalyzer::SCOPE_SCENE);
+    scope_option->add_item("Selection", SceneAnalyzer::SCOPE_SELECTION);
+    scope_option->add_item("Viewport", SceneAnalyzer::SCOPE_VIEWPORT);
+    scope_option->set_tooltip_text("Scene context sent with each prompt: the whole scene, the selected nodes, or what is visible in the 2D viewport.");
+    scope_option->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    scope_option->add_theme_color_override("font_hover_color", Color(0.0, 0.7, 1.0)); // Neon blue on hover
+    scope_option->connect("item_selected", callable_mp(this, &VectorAIDock::_on_context_scope_selected));
+    top_bar->add_child(scope_option);
+
+    // Journaled changes replayed on the current scene without asking the model again
+    replay_button = memnew(MenuButton);
+    replay_button->set_text("⟲");
+    replay_button->set_tooltip_text("Replay a previous AI change on the current scene");
+    replay_button->get_popup()->connect("about_to_popup", callable_mp(this, &VectorAIDock::_on_replay_menu_about_to_popup));
+    replay_button->get_popup()->connect("id_pressed", callable_mp(this, &VectorAIDock::_on_replay_id_pressed));
+    top_bar->add_child(replay_button);
+
     // Buttons with futuristic styling
     settings_button = memnew(Button);
     settings_button->set_text("⚙");
@@ -118,6 +144,23 @@ void VectorAIDock::_setup_ui() {
     chat_history->add_theme_stylebox_override("normal", EditorNode::get_singleton()->get_editor_theme()->get_stylebox("panel", "Tree"));
     main_container->add_child(chat_history);
 
+    // Compact timing line for the last request
+    timing_label = memnew(Label);
+    timing_label->set_text_overrun_behavior(TextServer::OVERRUN_TRIM_ELLIPSIS);
+    timing_label->add_theme_color_override("font_color", Color(0.5, 0.6, 0.7)); // Subtle blue-gray
+    timing_label->add_theme_font_size_override("font_size", 11 * EDSCALE); // Smaller font
+    timing_label->set_visible(false);
+    main_container->add_child(timing_label);
+
+    // Session token usage and cost
+    usage_label = memnew(Label);
+    usage_label->set_text_overrun_behavior(TextServer::OVERRUN_TRIM_ELLIPSIS);
+    usage_label->add_theme_color_override("font_color", Color(0.5, 0.6, 0.7)); // Subtle blue-gray
+    usage_label->add_theme_font_size_override("font_size", 11 * EDSCALE); // Smaller font
+    usage_label->set_mouse_filter(MOUSE_FILTER_PASS);
+    usage_label->set_visible(false);
+    main_container->add_child(usage_label);
+
     // Input area with futuristic styling
     HBoxContainer *input_container = memnew(HBoxContainer);
     input_container->set_custom_minimum_size(Vector2(0, 40 * EDSCALE));
@@ -140,14 +183,25 @@ void VectorAIDock::_setup_ui() {
     send_button->connect("pressed", callable_mp(this, &VectorAIDock::_on_send_button_pressed));
     input_container->add_child(send_button);
 
-    // Initialize components
+    // Initialize components; the analyzer, modifier, journal and index come from set_services
     gemini_client = memnew(GeminiClient);
-    scene_analyzer = memnew(SceneAnalyzer);
-    scene_modifier = memnew(SceneModifier);
-
     add_child(gemini_client);
-    add_child(scene_analyzer);
-    add_child(scene_modifier);
+
+    gemini_client->set_project_index(project_index);
+
+    // The model can pull scene details through the analyzer instead of receiving the whole tree
+    gemini_client->set_tool_handler(callable_mp(scene_analyzer, &SceneAnalyzer::call_tool), SceneAnalyzer::get_tool_declarations());
+
+    // Streamed responses hand over each modification as soon as it is complete
+    gemini_client->set_modification_handler(callable_mp(this, &VectorAIDock::_on_modification_streamed));
+
+    // Alternative answers are dry-run against the edited scene to pick the one that applies
+    gemini_client->set_candidate_validator(callable_mp(scene_modifier, &SceneModifier::validate_modifications));
+
+    // The context scope is remembered per project
+    int scope = EditorSettings::get_singleton()->get_project_metadata("vector_ai", "context_scope", SceneAnalyzer::SCOPE_SCENE);
+    scope_option->select(scope_option->get_item_index(scope));
+    scene_analyzer->set_context_scope(SceneAnalyzer::ContextScope(scope));
 }
 
 void VectorAIDock::_setup_settings_window() {
@@ -199,6 +253,46 @@ void VectorAIDock::_setup_settings_window() {
     dev_mode_check->connect("toggled", callable_mp(this, &VectorAIDock::_on_dev_mode_toggled));
     settings_vbox->add_child(dev_mode_check);
 
+    // Request tracing for chrome://tracing / Perfetto
+    trace_check = memnew(CheckBox);
+    trace_check->set_text("Record Request Traces (chrome://tracing)");
+    trace_check->set_tooltip_text("Writes a trace-event JSON file to the project's .godot/editor folder after each request.");
+    trace_check->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    trace_check->add_theme_color_override("font_color_hover", Color(0.0, 0.7, 1.0)); // Neon blue on hover
+    settings_vbox->add_child(trace_check);
+
+    // Function calling: send a shallow outline and let the model ask for details
+    tool_calling_check = memnew(CheckBox);
+    tool_calling_check->set_text("Scene Tools (send an outline, fetch details on demand)");
+    tool_calling_check->set_tooltip_text("The model inspects children, properties and scripts through function calls. Requires developer mode.");
+    tool_calling_check->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    tool_calling_check->add_theme_color_override("font_color_hover", Color(0.0, 0.7, 1.0)); // Neon blue on hover
+    settings_vbox->add_child(tool_calling_check);
+
+    // Loopback JSON-RPC server so godot-mcp can work on the open scenes
+    rpc_check = memnew(CheckBox);
+    rpc_check->set_text("Local RPC Server (godot-mcp)");
+    rpc_check->set_tooltip_text("Serves analyze/apply/create_node/create_scene/save_scene on 127.0.0.1. Clients read the port and token from the project's .godot/editor/vector_ai_rpc.json.");
+    rpc_check->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    rpc_check->add_theme_color_override("font_color_hover", Color(0.0, 0.7, 1.0)); // Neon blue on hover
+    settings_vbox->add_child(rpc_check);
+
+    // Background BM25 index over the project's scenes, scripts and resources
+    retrieval_check = memnew(CheckBox);
+    retrieval_check->set_text("Project Retrieval (add related files to the prompt)");
+    retrieval_check->set_tooltip_text("Indexes .tscn, .gd and .tres files in the background and adds the snippets most relevant to each request.");
+    retrieval_check->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    retrieval_check->add_theme_color_override("font_color_hover", Color(0.0, 0.7, 1.0)); // Neon blue on hover
+    settings_vbox->add_child(retrieval_check);
+
+    // Apply modifications while the response is still arriving
+    stream_check = memnew(CheckBox);
+    stream_check->set_text("Stream Responses (apply edits as they arrive)");
+    stream_check->set_tooltip_text("Reads the response as it is generated and applies each modification once complete; all of them undo as one step. Requires developer mode and is skipped while Scene Tools are active.");
+    stream_check->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    stream_check->add_theme_color_override("font_color_hover", Color(0.0, 0.7, 1.0)); // Neon blue on hover
+    settings_vbox->add_child(stream_check);
+
     // API Key with futuristic styling
     Label *api_key_label = memnew(Label);
     api_key_label->set_text("Gemini API Key:");
@@ -232,6 +326,36 @@ void VectorAIDock::_setup_settings_window() {
     model_option->add_theme_color_override("font_hover_color", Color(0.0, 0.7, 1.0)); // Neon blue on hover
     settings_grid->add_child(model_option);
 
+    // Model routing: simple edits go to a low-latency model
+    Label *routing_label = memnew(Label);
+    routing_label->set_text("Model Routing:");
+    routing_label->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    settings_grid->add_child(routing_label);
+
+    routing_option = memnew(OptionButton);
+    routing_option->set_h_size_flags(SIZE_EXPAND_FILL);
+    routing_option->add_item("off");
+    routing_option->add_item("heuristic");
+    routing_option->add_item("classifier");
+    routing_option->set_tooltip_text("heuristic: local keyword/size rules. classifier: unsure cases are classified by the fast model (developer mode only).");
+    routing_option->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    routing_option->add_theme_color_override("font_hover_color", Color(0.0, 0.7, 1.0)); // Neon blue on hover
+    settings_grid->add_child(routing_option);
+
+    Label *fast_model_label = memnew(Label);
+    fast_model_label->set_text("Fast Model:");
+    fast_model_label->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    settings_grid->add_child(fast_model_label);
+
+    fast_model_option = memnew(OptionButton);
+    fast_model_option->set_h_size_flags(SIZE_EXPAND_FILL);
+    fast_model_option->add_item("gemini-2.0-flash-lite");
+    fast_model_option->add_item("gemini-2.0-flash");
+    fast_model_option->add_item("gemini-1.5-flash");
+    fast_model_option->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    fast_model_option->add_theme_color_override("font_hover_color", Color(0.0, 0.7, 1.0)); // Neon blue on hover
+    settings_grid->add_child(fast_model_option);
+
     // Temperature with futuristic styling
     Label *temperature_label = memnew(Label);
     temperature_label->set_text("Temperature:");
@@ -272,6 +396,106 @@ void VectorAIDock::_setup_settings_window() {
     max_tokens_input->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
     settings_grid->add_child(max_tokens_input);
 
+    // Prompt token budget enforced before sending
+    Label *token_budget_label = memnew(Label);
+    token_budget_label->set_text("Prompt Token Budget:");
+    token_budget_label->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    settings_grid->add_child(token_budget_label);
+
+    token_budget_input = memnew(SpinBox);
+    token_budget_input->set_h_size_flags(SIZE_EXPAND_FILL);
+    token_budget_input->set_min(0);
+    token_budget_input->set_max(2000000);
+    token_budget_input->set_step(1000);
+    token_budget_input->set_value(120000);
+    token_budget_input->set_tooltip_text("Scene context is trimmed locally so the prompt fits this estimate. 0 disables the budget.");
+    token_budget_input->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    settings_grid->add_child(token_budget_input);
+
+    Label *float_precision_label = memnew(Label);
+    float_precision_label->set_text("Float Precision:");
+    float_precision_label->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    settings_grid->add_child(float_precision_label);
+
+    float_precision_input = memnew(SpinBox);
+    float_precision_input->set_h_size_flags(SIZE_EXPAND_FILL);
+    float_precision_input->set_min(-1);
+    float_precision_input->set_max(8);
+    float_precision_input->set_value(3);
+    float_precision_input->set_tooltip_text("Decimals kept for float values in the scene context. -1 keeps full precision.");
+    float_precision_input->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    settings_grid->add_child(float_precision_input);
+
+    Label *max_continuations_label = memnew(Label);
+    max_continuations_label->set_text("Max Continuations:");
+    max_continuations_label->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    settings_grid->add_child(max_continuations_label);
+
+    max_continuations_input = memnew(SpinBox);
+    max_continuations_input->set_h_size_flags(SIZE_EXPAND_FILL);
+    max_continuations_input->set_min(0);
+    max_continuations_input->set_max(8);
+    max_continuations_input->set_value(2);
+    max_continuations_input->set_tooltip_text("Follow-up requests made when a response is cut off by Max Output Tokens; the parts are joined before modifications are read. Requires developer mode.");
+    max_continuations_input->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    settings_grid->add_child(max_continuations_input);
+
+    Label *candidate_count_label = memnew(Label);
+    candidate_count_label->set_text("Candidates:");
+    candidate_count_label->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    settings_grid->add_child(candidate_count_label);
+
+    candidate_count_input = memnew(SpinBox);
+    candidate_count_input->set_h_size_flags(SIZE_EXPAND_FILL);
+    candidate_count_input->set_min(1);
+    candidate_count_input->set_max(4);
+    candidate_count_input->set_value(1);
+    candidate_count_input->set_tooltip_text("Answers requested at once; the one whose modifications apply cleanly to the open scene is used. Requires developer mode, without streaming or tool calling.");
+    candidate_count_input->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    settings_grid->add_child(candidate_count_input);
+
+    Label *undo_memory_label = memnew(Label);
+    undo_memory_label->set_text("Undo Memory (MB):");
+    undo_memory_label->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    settings_grid->add_child(undo_memory_label);
+
+    undo_memory_input = memnew(SpinBox);
+    undo_memory_input->set_h_size_flags(SIZE_EXPAND_FILL);
+    undo_memory_input->set_min(1);
+    undo_memory_input->set_max(4096);
+    undo_memory_input->set_value(64);
+    undo_memory_input->set_tooltip_text("Memory kept for undoing AI edits to large arrays (polygons, tile data). The oldest entries are released first; the latest AI turn can always be undone.");
+    undo_memory_input->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    settings_grid->add_child(undo_memory_input);
+
+    Label *retrieval_budget_label = memnew(Label);
+    retrieval_budget_label->set_text("Retrieval Budget:");
+    retrieval_budget_label->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    settings_grid->add_child(retrieval_budget_label);
+
+    retrieval_budget_input = memnew(SpinBox);
+    retrieval_budget_input->set_h_size_flags(SIZE_EXPAND_FILL);
+    retrieval_budget_input->set_min(0);
+    retrieval_budget_input->set_max(100000);
+    retrieval_budget_input->set_step(500);
+    retrieval_budget_input->set_value(4000);
+    retrieval_budget_input->set_tooltip_text("Estimated tokens available for related project files in each prompt.");
+    retrieval_budget_input->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    settings_grid->add_child(retrieval_budget_input);
+
+    Label *rpc_port_label = memnew(Label);
+    rpc_port_label->set_text("RPC Port:");
+    rpc_port_label->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    settings_grid->add_child(rpc_port_label);
+
+    rpc_port_input = memnew(SpinBox);
+    rpc_port_input->set_h_size_flags(SIZE_EXPAND_FILL);
+    rpc_port_input->set_min(1024);
+    rpc_port_input->set_max(65535);
+    rpc_port_input->set_value(9510);
+    rpc_port_input->add_theme_color_override("font_color", Color(0.9, 0.9, 0.95)); // Light text
+    settings_grid->add_child(rpc_port_input);
+
     // Glowing separator
     HSeparator *separator2 = memnew(HSeparator);
     separator2->add_theme_color_override("color", Color(0.0, 0.7, 1.0, 0.3)); // Neon blue with transparency
@@ -305,6 +529,34 @@ void VectorAIDock::_load_settings() {
         dev_mode_check->set_pressed(settings["dev_mode"]);
     }
 
+    if (settings.has("trace_enabled")) {
+        trace_check->set_pressed(settings["trace_enabled"]);
+    }
+
+    if (settings.has("tool_calling")) {
+        tool_calling_check->set_pressed(settings["tool_calling"]);
+    }
+
+    if (settings.has("rpc_enabled")) {
+        rpc_check->set_pressed(settings["rpc_enabled"]);
+    }
+
+    if (settings.has("rpc_port")) {
+        rpc_port_input->set_value(settings["rpc_port"]);
+    }
+
+    if (settings.has("retrieval_enabled")) {
+        retrieval_check->set_pressed(settings["retrieval_enabled"]);
+    }
+
+    if (settings.has("retrieval_token_budget")) {
+        retrieval_budget_input->set_value(settings["retrieval_token_budget"]);
+    }
+
+    if (settings.has("stream_responses")) {
+        stream_check->set_pressed(settings["stream_responses"]);
+    }
+
     if (settings.has("api_key")) {
         api_key_input->set_text(settings["api_key"]);
     }
@@ -319,6 +571,26 @@ void VectorAIDock::_load_settings() {
         }
     }
 
+    if (settings.has("fast_model")) {
+        String fast_model = settings["fast_model"];
+        for (int i = 0; i < fast_model_option->get_item_count(); i++) {
+            if (fast_model_option->get_item_text(i) == fast_model) {
+                fast_model_option->select(i);
+                break;
+            }
+        }
+    }
+
+    if (settings.has("routing_mode")) {
+        String routing_mode = settings["routing_mode"];
+        for (int i = 0; i < routing_option->get_item_count(); i++) {
+            if (routing_option->get_item_text(i) == routing_mode) {
+                routing_option->select(i);
+                break;
+            }
+        }
+    }
+
     if (settings.has("temperature")) {
         temperature_slider->set_value(settings["temperature"]);
     }
@@ -327,6 +599,26 @@ void VectorAIDock::_load_settings() {
         max_tokens_input->set_value(settings["max_output_tokens"]);
     }
 
+    if (settings.has("prompt_token_budget")) {
+        token_budget_input->set_value(settings["prompt_token_budget"]);
+    }
+
+    if (settings.has("float_precision")) {
+        float_precision_input->set_value(settings["float_precision"]);
+    }
+
+    if (settings.has("max_continuations")) {
+        max_continuations_input->set_value(settings["max_continuations"]);
+    }
+
+    if (settings.has("candidate_count")) {
+        candidate_count_input->set_value(settings["candidate_count"]);
+    }
+
+    if (settings.has("undo_memory_cap_mb")) {
+        undo_memory_input->set_value(settings["undo_memory_cap_mb"]);
+    }
+
     // Update UI based on dev mode
     api_key_input->get_parent()->set_visible(dev_mode_check->is_pressed());
 }
@@ -335,34 +627,87 @@ void VectorAIDock::_save_settings() {
     Dictionary settings;
 
     settings["dev_mode"] = dev_mode_check->is_pressed();
+    settings["trace_enabled"] = trace_check->is_pressed();
+    settings["tool_calling"] = tool_calling_check->is_pressed();
+    settings["rpc_enabled"] = rpc_check->is_pressed();
+    settings["rpc_port"] = (int)rpc_port_input->get_value();
+    settings["retrieval_enabled"] = retrieval_check->is_pressed();
+    settings["retrieval_token_budget"] = (int)retrieval_budget_input->get_value();
+    settings["stream_responses"] = stream_check->is_pressed();
 
     if (dev_mode_check->is_pressed()) {
         settings["api_key"] = api_key_input->get_text();
     }
 
     settings["model"] = model_option->get_item_text(model_option->get_selected());
+    settings["fast_model"] = fast_model_option->get_item_text(fast_model_option->get_selected());
+    settings["routing_mode"] = routing_option->get_item_text(routing_option->get_selected());
     settings["temperature"] = temperature_slider->get_value();
     settings["max_output_tokens"] = (int)max_tokens_input->get_value();
+    settings["prompt_token_budget"] = (int)token_budget_input->get_value();
+    settings["float_precision"] = (int)float_precision_input->get_value();
+    settings["max_continuations"] = (int)max_continuations_input->get_value();
+    settings["candidate_count"] = (int)candidate_count_input->get_value();
+    settings["undo_memory_cap_mb"] = (int)undo_memory_input->get_value();
 
     gemini_client->save_settings(settings);
+    if (settings_handler.is_valid()) {
+        settings_handler.call(settings);
+    }
+}
+
+void VectorAIDock::set_services(SceneAnalyzer *p_analyzer, SceneModifier *p_modifier, const Ref<ModificationJournal> &p_journal, const Ref<ProjectIndex> &p_index) {
+    // Called before the dock enters the tree; the UI is built around these on ready
+    scene_analyzer = p_analyzer;
+    scene_modifier = p_modifier;
+    journal = p_journal;
+    project_index = p_index;
+}
+
+void VectorAIDock::set_settings_handler(const Callable &p_handler) {
+    settings_handler = p_handler;
 }
 
 void VectorAIDock::_on_send_button_pressed() {
     String user_input = input_field->get_text().strip_edges();
-    if (user_input.is_empty()) {
+    if (user_input.is_empty() || gemini_client->is_request_active()) {
         return;
     }
 
     // Add user message to chat history
     _add_user_message(user_input);
+    pending_prompt = user_input;
 
     // Clear input field
     input_field->set_text("");
 
+    VectorAIProfiler *profiler = VectorAIProfiler::get_singleton();
+    if (profiler) {
+        profiler->begin_request();
+        profiler->begin_phase(VectorAIProfiler::PHASE_ANALYZE);
+    }
+
+    VectorAITracer *tracer = VectorAITracer::get_singleton();
+    if (tracer) {
+        // Each saved trace covers one request; earlier events would only fill the buffers
+        tracer->clear();
+        tracer->begin_span("request");
+        tracer->begin_span("analysis");
+    }
+
     // Get current scene information
-    String scene_info = scene_analyzer->analyze_current_scene();
+    String scene_info = gemini_client->is_tool_calling_active() ? scene_analyzer->analyze_shallow_outline() : scene_analyzer->analyze_current_scene();
 
-    // Send request to Gemini API
+    if (profiler) {
+        profiler->end_phase(VectorAIProfiler::PHASE_ANALYZE);
+    }
+
+    if (tracer) {
+        tracer->end_span("analysis");
+    }
+
+    // Send request to Gemini API; Send stays disabled until the response or error arrives
+    send_button->set_disabled(true);
     gemini_client->send_request(user_input, scene_info, callable_mp(this, &VectorAIDock::_on_gemini_response));
 }
 
@@ -373,6 +718,10 @@ void VectorAIDock::_on_input_field_text_submitted(const String &p_text) {
 }
 
 void VectorAIDock::_on_settings_button_pressed() {
+    if (!settings_window) {
+        _setup_settings_window();
+    }
+    _load_settings();
     settings_window->popup_centered();
 }
 
@@ -388,7 +737,7 @@ void VectorAIDock::_on_save_settings_pressed() {
 }
 
 void VectorAIDock::_on_cancel_settings_pressed() {
-    _load_settings();
+    // The fields are filled again from the saved settings when the window reopens
     settings_window->hide();
 }
 
@@ -396,24 +745,195 @@ void VectorAIDock::_on_dev_mode_toggled(bool p_toggled) {
     api_key_input->get_parent()->set_visible(p_toggled);
 }
 
+void VectorAIDock::_on_context_scope_selected(int p_index) {
+    int scope = scope_option->get_item_id(p_index);
+    scene_analyzer->set_context_scope(SceneAnalyzer::ContextScope(scope));
+    EditorSettings::get_singleton()->set_project_metadata("vector_ai", "context_scope", scope);
+}
+
+void VectorAIDock::_on_modification_streamed(const Dictionary &p_modification) {
+    Dictionary result = scene_modifier->stage_modification(p_modification);
+    if (!result["success"]) {
+        _add_system_message("Error applying modification: " + String(result["error"]));
+    }
+}
+
+void VectorAIDock::_on_replay_menu_about_to_popup() {
+    static const int MAX_REPLAY_ITEMS = 15;
+
+    PopupMenu *popup = replay_button->get_popup();
+    popup->clear();
+
+    Array entries = journal->get_entries(MAX_REPLAY_ITEMS);
+    if (entries.is_empty()) {
+        popup->add_item("No applied AI changes yet");
+        popup->set_item_disabled(0, true);
+        return;
+    }
+
+    for (int i = 0; i < entries.size(); i++) {
+        Dictionary entry = entries[i];
+        String prompt = entry["prompt"];
+        if (prompt.length() > 48) {
+            prompt = prompt.left(45) + "...";
+        }
+        popup->add_item(vformat("%s (%d changes, %s)", prompt, (int)entry["change_count"], String(entry["scene_path"]).get_file()), entry["id"]);
+        popup->set_item_tooltip(popup->get_item_count() - 1, entry["prompt"]);
+    }
+}
+
+void VectorAIDock::_on_replay_id_pressed(int p_id) {
+    Dictionary entry = journal->get_entry(p_id);
+    if (entry.is_empty()) {
+        return;
+    }
+
+    Dictionary result = scene_modifier->replay_changes(entry["changes"], Dictionary());
+    if (result["success"]) {
+        _add_system_message(vformat("Replayed %d change(s) from \"%s\" without a model call.", (int)result["applied"], entry["prompt"]));
+    } else {
+        _add_system_message(vformat("Replayed %d change(s) from \"%s\"; %s", (int)result.get("applied", 0), entry["prompt"], result["error"]));
+    }
+}
+
 void VectorAIDock::_on_gemini_response(const Dictionary &p_response, const String &p_error) {
+    send_button->set_disabled(false);
+
     if (!p_error.is_empty()) {
         _add_system_message("Error: " + p_error);
+
+        // Edits that landed before a stream failed stay, but as one undoable step
+        if (scene_modifier->get_staged_count() > 0) {
+            Dictionary result = scene_modifier->commit_staged();
+            _add_system_message(vformat("Kept %d modification(s) applied before the error; undo reverts them together.", (int)result["applied"]));
+        }
+
+        _finish_request_timing();
         return;
     }
 
     // Add AI response to chat history
     _add_ai_message(p_response["text"]);
+    _update_usage_summary();
 
     // Apply modifications if requested
     if (p_response.has("modifications")) {
-        Dictionary result = scene_modifier->apply_modifications(p_response["modifications"]);
+        VectorAIProfiler *profiler = VectorAIProfiler::get_singleton();
+        if (profiler) {
+            profiler->begin_phase(VectorAIProfiler::PHASE_APPLY);
+        }
+
+        Dictionary result;
+        {
+            VECTOR_AI_TRACE_SCOPE("apply");
+            if (p_response.get("streamed", false)) {
+                // Already applied while streaming; only the undo action is left
+                result = scene_modifier->commit_staged();
+            } else {
+                result = scene_modifier->apply_modifications(p_response["modifications"]);
+            }
+        }
+
+        if (profiler) {
+            profiler->end_phase(VectorAIProfiler::PHASE_APPLY);
+        }
+
+        // What was applied, resolved to node paths and typed values, on the scene it landed on
+        journal->record(pending_prompt, result.get("scene_path", String()), result.get("changes", Array()));
+
         if (result["success"]) {
-            _add_system_message("Successfully applied modifications to the scene.");
+            String message = "Successfully applied modifications to the scene.";
+            Dictionary undo_stats = scene_modifier->get_undo_stats();
+            if ((int64_t)undo_stats["memory_bytes"] > 0) {
+                message += vformat(" Undo data held: %s (full copies: %s).", String::humanize_size(undo_stats["memory_bytes"]), String::humanize_size(undo_stats["full_copy_bytes"]));
+            }
+            _add_system_message(message);
         } else {
             _add_system_message("Error applying modifications: " + String(result["error"]));
         }
     }
+
+    _finish_request_timing();
+}
+
+void VectorAIDock::_update_usage_summary() {
+    Ref<UsageLedger> ledger = gemini_client->get_usage_ledger();
+    if (ledger.is_null() || gemini_client->get_last_usage().is_empty()) {
+        return;
+    }
+
+    Dictionary session = ledger->get_session_totals();
+    usage_label->set_text(vformat("Session: %d req | %d in (%d cached) | %d out | $%s",
+            (int64_t)session["requests"], (int64_t)session["prompt_tokens"], (int64_t)session["cached_tokens"],
+            (int64_t)session["candidates_tokens"], String::num((double)session["cost"], 4)));
+
+    // Per-model and per-project breakdown on hover
+    String tooltip;
+    Dictionary models = ledger->get_model_totals();
+    Array model_names = models.keys();
+    for (int i = 0; i < model_names.size(); i++) {
+        Dictionary totals = models[model_names[i]];
+        tooltip += vformat("%s: %d req, %d in, %d out, $%s\n", model_names[i], (int64_t)totals["requests"],
+                (int64_t)totals["prompt_tokens"], (int64_t)totals["candidates_tokens"], String::num((double)totals["cost"], 4));
+    }
+
+    Dictionary project = ledger->get_project_totals();
+    tooltip += vformat("This project: %d req, $%s", (int64_t)project["requests"], String::num((double)project["cost"], 4));
+
+    Array expensive = ledger->get_most_expensive_prompts(1);
+    if (!expensive.is_empty()) {
+        Dictionary entry = expensive[0];
+        tooltip += vformat("\nMost expensive prompt ($%s): %s", String::num((double)entry["cost"], 4), entry["prompt"]);
+    }
+
+    usage_label->set_tooltip_text(tooltip);
+    usage_label->set_visible(true);
+}
+
+void VectorAIDock::_finish_request_timing() {
+    VectorAIProfiler *profiler = VectorAIProfiler::get_singleton();
+    if (!profiler || !profiler->is_request_active()) {
+        return;
+    }
+
+    profiler->end_request();
+
+    String timing_text = profiler->get_last_summary();
+    String tooltip = vformat("p50 / p95 total: %.0f / %.0f ms",
+            profiler->get_percentile(VectorAIProfiler::PHASE_TOTAL, 50),
+            profiler->get_percentile(VectorAIProfiler::PHASE_TOTAL, 95));
+
+    Dictionary routing = gemini_client->get_last_routing();
+    if (routing.has("model")) {
+        timing_text += " | " + String(routing["model"]);
+        tooltip += vformat("\nRouted to %s (%s tier, %s)", routing["model"], routing["tier"], routing["source"]);
+        if (routing.has("reasons")) {
+            tooltip += ": " + String(", ").join(PackedStringArray(routing["reasons"]));
+        }
+    }
+
+    Dictionary tokens = gemini_client->get_last_token_breakdown();
+    if (!tokens.is_empty()) {
+        timing_text += vformat(" | ~%d tok", (int)tokens["total"]);
+        tooltip += vformat("\nEstimated tokens: system %d, scene %d, prompt %d", (int)tokens["system"], (int)tokens["scene"], (int)tokens["user"]);
+        if ((int)tokens["trimmed_lines"] > 0) {
+            tooltip += vformat("\nScene context trimmed from %d tokens (%d lines omitted)", (int)tokens["scene_untrimmed"], (int)tokens["trimmed_lines"]);
+        }
+    }
+
+    timing_label->set_text(timing_text);
+    timing_label->set_tooltip_text(tooltip);
+    timing_label->set_visible(true);
+
+    VectorAITracer *tracer = VectorAITracer::get_singleton();
+    if (tracer && tracer->is_enabled()) {
+        tracer->end_span("request");
+
+        String trace_path = tracer->get_default_trace_path();
+        if (tracer->save_trace(trace_path) == OK) {
+            timing_label->set_tooltip_text(timing_label->get_tooltip_text() + "\nTrace: " + trace_path);
+        }
+    }
 }
 
 void VectorAIDock::_add_user_message(const String &p_text) {
@@ -33,7 +33,9 @@
 #include "scene/gui/box_container.h"
 #include "scene/gui/button.h"
 #include "scene/gui/check_box.h"
+#include "scene/gui/label.h"
 #include "scene/gui/line_edit.h"
+#include "scene/gui/menu_button.h"
 #include "scene/gui/option_button.h"
 #include "scene/gui/rich_text_label.h"
 #include "scene/gui/text_edit.h"
@@ -44,6 +46,7 @@
 #include "scene/gui/window.h"
 
 #include "gemini_client.h"
+#include "modification_journal.h"
 #include "scene_analyzer.h"
 #include "scene_modifier.h"
 
@@ -57,19 +60,45 @@ private:
     Button *send_button = nullptr;
     Button *settings_button = nullptr;
     Button *clear_button = nullptr;
+    OptionButton *scope_option = nullptr;
+    MenuButton *replay_button = nullptr;
+    Label *timing_label = nullptr;
+    Label *usage_label = nullptr;
 
-    // Components
+    // Components; all but the client are owned by VectorAI and shared with the RPC server
     GeminiClient *gemini_client = nullptr;
     SceneAnalyzer *scene_analyzer = nullptr;
     SceneModifier *scene_modifier = nullptr;
+    Ref<ProjectIndex> project_index;
+
+    // Receives the settings after each save, for the components the dock does not own
+    Callable settings_handler;
+
+    // Applied batches, replayable without a model call
+    Ref<ModificationJournal> journal;
+    String pending_prompt;
 
     // Settings window
     Window *settings_window = nullptr;
     LineEdit *api_key_input = nullptr;
     CheckBox *dev_mode_check = nullptr;
+    CheckBox *trace_check = nullptr;
+    CheckBox *tool_calling_check = nullptr;
+    CheckBox *rpc_check = nullptr;
+    CheckBox *retrieval_check = nullptr;
+    SpinBox *retrieval_budget_input = nullptr;
+    CheckBox *stream_check = nullptr;
+    SpinBox *rpc_port_input = nullptr;
     OptionButton *model_option = nullptr;
+    OptionButton *fast_model_option = nullptr;
+    OptionButton *routing_option = nullptr;
     HSlider *temperature_slider = nullptr;
     SpinBox *max_tokens_input = nullptr;
+    SpinBox *token_budget_input = nullptr;
+    SpinBox *float_precision_input = nullptr;
+    SpinBox *max_continuations_input = nullptr;
+    SpinBox *candidate_count_input = nullptr;
+    SpinBox *undo_memory_input = nullptr;
 
     // Chat history
     Vector<Dictionary> messages;
@@ -86,17 +115,26 @@ private:
     void _on_save_settings_pressed();
     void _on_cancel_settings_pressed();
     void _on_dev_mode_toggled(bool p_toggled);
+    void _on_context_scope_selected(int p_index);
     void _on_gemini_response(const Dictionary &p_response, const String &p_error);
+    void _on_modification_streamed(const Dictionary &p_modification);
+    void _on_replay_menu_about_to_popup();
+    void _on_replay_id_pressed(int p_id);
 
     void _add_user_message(const String &p_text);
     void _add_ai_message(const String &p_text);
     void _add_system_message(const String &p_text);
+    void _finish_request_timing();
+    void _update_usage_summary();
 
 protected:
     void _notification(int p_what);
     static void _bind_methods();
 
 public:
+    void set_services(SceneAnalyzer *p_analyzer, SceneModifier *p_modifier, const Ref<ModificationJournal> &p_journal, const Ref<ProjectIndex> &p_index);
+    void set_settings_handler(const Callable &p_handler);
+
     VectorAIDock();
     ~VectorAIDock();
 };
@@ -0,0 +1,243 @@
+/**************************************************************************/
+/*  vector_ai_profiler.cpp                                                */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "vector_ai_profiler.h"
+
+#include "core/os/os.h"
+#include "core/templates/sort_array.h"
+#include "main/performance.h"
+
+VectorAIProfiler *VectorAIProfiler::singleton = nullptr;
+
+void VectorAIProfiler::SampleWindow::push(double p_msec) {
+    samples[next] = p_msec;
+    next = (next + 1) % WINDOW_SIZE;
+    if (count < WINDOW_SIZE) {
+        count++;
+    }
+}
+
+double VectorAIProfiler::SampleWindow::percentile(double p_percentile) const {
+    if (count == 0) {
+        return 0.0;
+    }
+
+    // The window is tiny, so sorting a copy is cheaper than keeping an ordered structure
+    double sorted[WINDOW_SIZE];
+    for (int i = 0; i < count; i++) {
+        sorted[i] = samples[i];
+    }
+    SortArray<double> sorter;
+    sorter.sort(sorted, count);
+
+    int index = CLAMP((int)Math::ceil(p_percentile / 100.0 * count) - 1, 0, count - 1);
+    return sorted[index];
+}
+
+void VectorAIProfiler::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("begin_request"), &VectorAIProfiler::begin_request);
+    ClassDB::bind_method(D_METHOD("begin_phase", "phase"), &VectorAIProfiler::begin_phase);
+    ClassDB::bind_method(D_METHOD("end_phase", "phase"), &VectorAIProfiler::end_phase);
+    ClassDB::bind_method(D_METHOD("end_request"), &VectorAIProfiler::end_request);
+    ClassDB::bind_method(D_METHOD("is_request_active"), &VectorAIProfiler::is_request_active);
+    ClassDB::bind_method(D_METHOD("get_percentile", "phase", "percentile"), &VectorAIProfiler::get_percentile);
+    ClassDB::bind_method(D_METHOD("get_last_timings"), &VectorAIProfiler::get_last_timings);
+    ClassDB::bind_method(D_METHOD("get_last_summary"), &VectorAIProfiler::get_last_summary);
+
+    BIND_ENUM_CONSTANT(PHASE_ANALYZE);
+    BIND_ENUM_CONSTANT(PHASE_SERIALIZE);
+    BIND_ENUM_CONSTANT(PHASE_NETWORK);
+    BIND_ENUM_CONSTANT(PHASE_PARSE);
+    BIND_ENUM_CONSTANT(PHASE_APPLY);
+    BIND_ENUM_CONSTANT(PHASE_TOTAL);
+    BIND_ENUM_CONSTANT(PHASE_MAX);
+}
+
+VectorAIProfiler *VectorAIProfiler::get_singleton() {
+    return singleton;
+}
+
+String VectorAIProfiler::get_phase_name(Phase p_phase) {
+    switch (p_phase) {
+        case PHASE_ANALYZE:
+            return "analyze";
+        case PHASE_SERIALIZE:
+            return "serialize";
+        case PHASE_NETWORK:
+            return "network";
+        case PHASE_PARSE:
+            return "parse";
+        case PHASE_APPLY:
+            return "apply";
+        case PHASE_TOTAL:
+            return "total";
+        default:
+            return "unknown";
+    }
+}
+
+void VectorAIProfiler::_register_monitors() {
+    Performance *performance = Performance::get_singleton();
+    if (!performance || monitors_registered) {
+        return;
+    }
+
+    for (int i = 0; i < PHASE_MAX; i++) {
+        String phase_name = get_phase_name(Phase(i));
+
+        Vector<Variant> p50_args;
+        p50_args.push_back(i);
+        p50_args.push_back(50);
+        performance->add_custom_monitor("vector_ai/" + phase_name + "_p50_ms", callable_mp(this, &VectorAIProfiler::_get_monitor_value), p50_args);
+
+        Vector<Variant> p95_args;
+        p95_args.push_back(i);
+        p95_args.push_back(95);
+        performance->add_custom_monitor("vector_ai/" + phase_name + "_p95_ms", callable_mp(this, &VectorAIProfiler::_get_monitor_value), p95_args);
+    }
+
+    monitors_registered = true;
+}
+
+void VectorAIProfiler::_unregister_monitors() {
+    Performance *performance = Performance::get_singleton();
+    if (!performance || !monitors_registered) {
+        return;
+    }
+
+    for (int i = 0; i < PHASE_MAX; i++) {
+        String phase_name = get_phase_name(Phase(i));
+        performance->remove_custom_monitor("vector_ai/" + phase_name + "_p50_ms");
+        performance->remove_custom_monitor("vector_ai/" + phase_name + "_p95_ms");
+    }
+
+    monitors_registered = false;
+}
+
+double VectorAIProfiler::_get_monitor_value(int p_phase, int p_percentile) const {
+    ERR_FAIL_INDEX_V(p_phase, PHASE_MAX, 0.0);
+    return windows[p_phase].percentile(p_percentile);
+}
+
+void VectorAIProfiler::begin_request() {
+    // Monitors are registered on first use so the module stays out of the startup path
+    _register_monitors();
+
+    request_active = true;
+    request_start_usec = OS::get_singleton()->get_ticks_usec();
+
+    for (int i = 0; i < PHASE_MAX; i++) {
+        phase_start_usec[i] = 0;
+        phase_msec[i] = 0.0;
+    }
+}
+
+void VectorAIProfiler::begin_phase(Phase p_phase) {
+    ERR_FAIL_INDEX(p_phase, PHASE_MAX);
+    if (!request_active) {
+        return;
+    }
+
+    phase_start_usec[p_phase] = OS::get_singleton()->get_ticks_usec();
+}
+
+void VectorAIProfiler::end_phase(Phase p_phase) {
+    ERR_FAIL_INDEX(p_phase, PHASE_MAX);
+    if (!request_active || phase_start_usec[p_phase] == 0) {
+        return;
+    }
+
+    // Phases can run more than once per request, so durations accumulate
+    uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - phase_start_usec[p_phase];
+    phase_msec[p_phase] += elapsed / 1000.0;
+    phase_start_usec[p_phase] = 0;
+}
+
+Dictionary VectorAIProfiler::end_request() {
+    if (!request_active) {
+        return last_timings;
+    }
+
+    // Close any phase that was left open by an error path
+    for (int i = 0; i < PHASE_TOTAL; i++) {
+        end_phase(Phase(i));
+    }
+
+    phase_msec[PHASE_TOTAL] = (OS::get_singleton()->get_ticks_usec() - request_start_usec) / 1000.0;
+    request_active = false;
+
+    Dictionary timings;
+    PackedStringArray summary_parts;
+
+    for (int i = 0; i < PHASE_MAX; i++) {
+        String phase_name = get_phase_name(Phase(i));
+        timings[phase_name] = phase_msec[i];
+
+        // Phases that never ran are left out of the percentiles
+        if (phase_msec[i] > 0.0 || i == PHASE_TOTAL) {
+            windows[i].push(phase_msec[i]);
+            summary_parts.push_back(phase_name + " " + String::num(phase_msec[i], phase_msec[i] < 10.0 ? 1 : 0) + " ms");
+        }
+    }
+
+    last_timings = timings;
+    last_summary = String(" | ").join(summary_parts);
+
+    return timings;
+}
+
+bool VectorAIProfiler::is_request_active() const {
+    return request_active;
+}
+
+double VectorAIProfiler::get_percentile(Phase p_phase, double p_percentile) const {
+    ERR_FAIL_INDEX_V(p_phase, PHASE_MAX, 0.0);
+    return windows[p_phase].percentile(p_percentile);
+}
+
+Dictionary VectorAIProfiler::get_last_timings() const {
+    return last_timings;
+}
+
+String VectorAIProfiler::get_last_summary() const {
+    return last_summary;
+}
+
+VectorAIProfiler::VectorAIProfiler() {
+    singleton = this;
+}
+
+VectorAIProfiler::~VectorAIProfiler() {
+    _unregister_monitors();
+
+    if (singleton == this) {
+        singleton = nullptr;
+    }
+}
@@ -0,0 +1,102 @@
+/**************************************************************************/
+/*  vector_ai_profiler.h                                                  */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/object/class_db.h"
+#include "core/object/object.h"
+
+class VectorAIProfiler : public Object {
+    GDCLASS(VectorAIProfiler, Object);
+
+public:
+    enum Phase {
+        PHASE_ANALYZE,
+        PHASE_SERIALIZE,
+        PHASE_NETWORK,
+        PHASE_PARSE,
+        PHASE_APPLY,
+        PHASE_TOTAL,
+        PHASE_MAX
+    };
+
+private:
+    static VectorAIProfiler *singleton;
+
+    // Number of requests kept per phase for the rolling percentiles
+    static const int WINDOW_SIZE = 64;
+
+    struct SampleWindow {
+        double samples[WINDOW_SIZE] = {};
+        int count = 0;
+        int next = 0;
+
+        void push(double p_msec);
+        double percentile(double p_percentile) const;
+    };
+
+    SampleWindow windows[PHASE_MAX];
+
+    // Timings of the request currently in flight
+    bool request_active = false;
+    uint64_t request_start_usec = 0;
+    uint64_t phase_start_usec[PHASE_MAX] = {};
+    double phase_msec[PHASE_MAX] = {};
+
+    Dictionary last_timings;
+    String last_summary;
+    bool monitors_registered = false;
+
+    void _register_monitors();
+    void _unregister_monitors();
+    double _get_monitor_value(int p_phase, int p_percentile) const;
+
+protected:
+    static void _bind_methods();
+
+public:
+    static VectorAIProfiler *get_singleton();
+    static String get_phase_name(Phase p_phase);
+
+    void begin_request();
+    void begin_phase(Phase p_phase);
+    void end_phase(Phase p_phase);
+    Dictionary end_request();
+    bool is_request_active() const;
+
+    double get_percentile(Phase p_phase, double p_percentile) const;
+    Dictionary get_last_timings() const;
+    String get_last_summary() const;
+
+    VectorAIProfiler();
+    ~VectorAIProfiler();
+};
+
+VARIANT_ENUM_CAST(VectorAIProfiler::Phase);
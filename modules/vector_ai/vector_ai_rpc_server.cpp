@@ -0,0 +1,623 @@
+/**************************************************************************/
+/*  vector_ai_rpc_server.cpp                                              */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "vector_ai_rpc_server.h"
+
+#include "core/config/project_settings.h"
+#include "core/crypto/crypto_core.h"
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/io/json.h"
+#include "core/io/resource_saver.h"
+#include "core/os/os.h"
+#include "core/version.h"
+#include "editor/editor_file_system.h"
+#include "editor/editor_interface.h"
+#include "editor/editor_node.h"
+#include "editor/editor_paths.h"
+#include "scene/resources/packed_scene.h"
+#include "scene_analyzer.h"
+#include "scene_modifier.h"
+
+void VectorAIRPCServer::_notification(int p_what) {
+    switch (p_what) {
+        case NOTIFICATION_PROCESS: {
+            _poll();
+        } break;
+
+        case NOTIFICATION_EXIT_TREE: {
+            stop();
+        } break;
+    }
+}
+
+void VectorAIRPCServer::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("start", "port"), &VectorAIRPCServer::start);
+    ClassDB::bind_method(D_METHOD("stop"), &VectorAIRPCServer::stop);
+    ClassDB::bind_method(D_METHOD("is_running"), &VectorAIRPCServer::is_running);
+    ClassDB::bind_method(D_METHOD("get_port"), &VectorAIRPCServer::get_port);
+}
+
+void VectorAIRPCServer::set_components(SceneAnalyzer *p_analyzer, SceneModifier *p_modifier) {
+    scene_analyzer = p_analyzer;
+    scene_modifier = p_modifier;
+}
+
+void VectorAIRPCServer::set_journal(const Ref<ModificationJournal> &p_journal) {
+    journal = p_journal;
+}
+
+String VectorAIRPCServer::_get_discovery_path() const {
+    return EditorPaths::get_singleton()->get_project_settings_dir().path_join("vector_ai_rpc.json");
+}
+
+void VectorAIRPCServer::_write_discovery_file() const {
+    // Clients find the port and the session token next to the project
+    Ref<FileAccess> f = FileAccess::open(_get_discovery_path(), FileAccess::WRITE);
+    if (f.is_null()) {
+        return;
+    }
+
+    Dictionary discovery;
+    discovery["port"] = port;
+    discovery["token"] = token;
+    discovery["pid"] = OS::get_singleton()->get_process_id();
+    f->store_string(JSON::stringify(discovery, "    "));
+}
+
+Error VectorAIRPCServer::start(int p_port) {
+    stop();
+
+    port = p_port > 0 ? p_port : DEFAULT_PORT;
+
+    // Loopback only; nothing outside this machine can reach the editor
+    server.instantiate();
+    Error err = server->listen(port, IPAddress("127.0.0.1"));
+    if (err != OK) {
+        server.unref();
+        return err;
+    }
+
+    // Fresh token per session, readable only through the project folder
+    CryptoCore::RandomGenerator rng;
+    uint8_t bytes[16] = {};
+    if (rng.init() == OK && rng.get_random_bytes(bytes, sizeof(bytes)) == OK) {
+        token = String::hex_encode_buffer(bytes, sizeof(bytes));
+    } else {
+        token = String::num_uint64(OS::get_singleton()->get_ticks_usec() ^ OS::get_singleton()->get_process_id(), 16);
+    }
+
+    _write_discovery_file();
+    set_process(true);
+
+    return OK;
+}
+
+void VectorAIRPCServer::stop() {
+    if (server.is_null()) {
+        return;
+    }
+
+    for (Peer &peer : peers) {
+        peer.stream->disconnect_from_host();
+    }
+    peers.clear();
+
+    server->stop();
+    server.unref();
+    token = String();
+    set_process(false);
+
+    DirAccess::remove_absolute(_get_discovery_path());
+}
+
+bool VectorAIRPCServer::is_running() const {
+    return server.is_valid() && server->is_listening();
+}
+
+int VectorAIRPCServer::get_port() const {
+    return port;
+}
+
+void VectorAIRPCServer::_poll() {
+    if (server.is_null()) {
+        return;
+    }
+
+    while (server->is_connection_available()) {
+        Ref<StreamPeerTCP> stream = server->take_connection();
+        if (stream.is_null()) {
+            break;
+        }
+        if ((int)peers.size() >= MAX_PEERS) {
+            stream->disconnect_from_host();
+            continue;
+        }
+
+        Peer peer;
+        peer.stream = stream;
+        peers.push_back(peer);
+    }
+
+    for (uint32_t i = 0; i < peers.size();) {
+        if (!_read_peer(peers[i]) || !_write_peer(peers[i])) {
+            peers.remove_at_unordered(i);
+            continue;
+        }
+        i++;
+    }
+}
+
+bool VectorAIRPCServer::_read_peer(Peer &p_peer) {
+    p_peer.stream->poll();
+    if (p_peer.stream->get_status() != StreamPeerTCP::STATUS_CONNECTED) {
+        return false;
+    }
+
+    // Nothing more is read until the queued responses are taken
+    if (p_peer.closing || p_peer.outgoing.size() - p_peer.outgoing_offset > MAX_LINE_LENGTH) {
+        return true;
+    }
+
+    int available = p_peer.stream->get_available_bytes();
+    if (available <= 0) {
+        return true;
+    }
+
+    int offset = p_peer.buffer.size();
+    p_peer.buffer.resize(offset + available);
+    int received = 0;
+    if (p_peer.stream->get_partial_data(p_peer.buffer.ptrw() + offset, available, received) != OK) {
+        return false;
+    }
+    p_peer.buffer.resize(offset + received);
+
+    // One request per line; responses go back in the same order
+    int line_start = 0;
+    const uint8_t *data = p_peer.buffer.ptr();
+    for (int i = 0; i < p_peer.buffer.size(); i++) {
+        if (data[i] != '\n') {
+            continue;
+        }
+
+        String line = String::utf8((const char *)data + line_start, i - line_start).strip_edges();
+        line_start = i + 1;
+        if (line.is_empty()) {
+            continue;
+        }
+
+        String response = _handle_line(line);
+        if (!response.is_empty()) {
+            _queue_response(p_peer, response);
+        }
+    }
+
+    if (line_start > 0) {
+        p_peer.buffer = p_peer.buffer.slice(line_start);
+    }
+
+    if (p_peer.buffer.size() > MAX_LINE_LENGTH) {
+        Dictionary response;
+        response["jsonrpc"] = "2.0";
+        response["id"] = Variant();
+        response["error"] = _make_error(ERROR_INVALID_REQUEST, "Request too large.");
+        _queue_response(p_peer, JSON::stringify(response));
+
+        // Closed once the error has been sent
+        p_peer.buffer.clear();
+        p_peer.closing = true;
+    }
+
+    return true;
+}
+
+void VectorAIRPCServer::_queue_response(Peer &p_peer, const String &p_response) {
+    CharString utf8 = (p_response + "\n").utf8();
+    int offset = p_peer.outgoing.size();
+    p_peer.outgoing.resize(offset + utf8.length());
+    memcpy(p_peer.outgoing.ptrw() + offset, utf8.get_data(), utf8.length());
+}
+
+bool VectorAIRPCServer::_write_peer(Peer &p_peer) {
+    // Sends what the socket takes without blocking the editor; the rest goes out on later frames
+    int pending = p_peer.outgoing.size() - p_peer.outgoing_offset;
+    if (pending > 0) {
+        int sent = 0;
+        if (p_peer.stream->put_partial_data(p_peer.outgoing.ptr() + p_peer.outgoing_offset, pending, sent) != OK) {
+            return false;
+        }
+        p_peer.outgoing_offset += sent;
+        pending -= sent;
+    }
+
+    if (pending > 0) {
+        return true;
+    }
+
+    p_peer.outgoing.clear();
+    p_peer.outgoing_offset = 0;
+    return !p_peer.closing;
+}
+
+bool VectorAIRPCServer::_token_matches(const String &p_token) const {
+    // Every byte is compared, so the time taken does not tell how much of a guess was right
+    CharString expected = token.utf8();
+    CharString given = p_token.utf8();
+    if (expected.length() == 0 || given.length() != expected.length()) {
+        return false;
+    }
+
+    uint8_t difference = 0;
+    for (int i = 0; i < expected.length(); i++) {
+        difference |= (uint8_t)expected[i] ^ (uint8_t)given[i];
+    }
+    return difference == 0;
+}
+
+Dictionary VectorAIRPCServer::_make_error(int p_code, const String &p_message) {
+    Dictionary error;
+    error["code"] = p_code;
+    error["message"] = p_message;
+    return error;
+}
+
+String VectorAIRPCServer::_handle_line(const String &p_line) {
+    Dictionary response;
+    response["jsonrpc"] = "2.0";
+    response["id"] = Variant();
+
+    JSON json;
+    if (json.parse(p_line) != OK || json.get_data().get_type() != Variant::DICTIONARY) {
+        response["error"] = _make_error(ERROR_PARSE, "Parse error.");
+        return JSON::stringify(response);
+    }
+
+    Dictionary request = json.get_data();
+    bool is_notification = !request.has("id");
+    response["id"] = request.get("id", Variant());
+
+    if (String(request.get("jsonrpc", "")) != "2.0" || request.get("method", Variant()).get_type() != Variant::STRING) {
+        response["error"] = _make_error(ERROR_INVALID_REQUEST, "Invalid request.");
+        return JSON::stringify(response);
+    }
+
+    Variant params_value = request.get("params", Dictionary());
+    if (params_value.get_type() != Variant::DICTIONARY) {
+        response["error"] = _make_error(ERROR_INVALID_PARAMS, "Params must be an object.");
+        return JSON::stringify(response);
+    }
+
+    Dictionary params = params_value;
+    if (!_token_matches(params.get("token", ""))) {
+        response["error"] = _make_error(ERROR_UNAUTHORIZED, "Missing or invalid token.");
+        return JSON::stringify(response);
+    }
+
+    Dictionary error;
+    Dictionary result = _dispatch(request["method"], params, error);
+    _restore_scene_tab();
+
+    if (is_notification) {
+        return String();
+    }
+
+    if (!error.is_empty()) {
+        response["error"] = error;
+    } else {
+        response["result"] = result;
+    }
+
+    return JSON::stringify(response);
+}
+
+Dictionary VectorAIRPCServer::_dispatch(const String &p_method, const Dictionary &p_params, Dictionary &r_error) {
+    if (p_method == "ping") {
+        Dictionary result;
+        result["version"] = VERSION_FULL_CONFIG;
+        result["project"] = ProjectSettings::get_singleton()->get_resource_path();
+        return result;
+    } else if (p_method == "analyze") {
+        return _rpc_analyze(p_params, r_error);
+    } else if (p_method == "apply") {
+        return _rpc_apply(p_params, r_error);
+    } else if (p_method == "create_node" || p_method == "add_node") {
+        return _rpc_create_node(p_params, r_error);
+    } else if (p_method == "create_scene") {
+        return _rpc_create_scene(p_params, r_error);
+    } else if (p_method == "save_scene") {
+        return _rpc_save_scene(p_params, r_error);
+    } else if (p_method == "journal_list") {
+        return _rpc_journal_list(p_params, r_error);
+    } else if (p_method == "journal_replay") {
+        return _rpc_journal_replay(p_params, r_error);
+    }
+
+    r_error = _make_error(ERROR_METHOD_NOT_FOUND, "Method not found: " + p_method);
+    return Dictionary();
+}
+
+Node *VectorAIRPCServer::_get_scene(const Dictionary &p_params, Dictionary &r_error) {
+    Node *edited_scene = EditorNode::get_singleton()->get_edited_scene();
+
+    String scene_path = p_params.get("scene_path", "");
+    if (scene_path.is_empty()) {
+        if (!edited_scene) {
+            r_error = _make_error(ERROR_OPERATION_FAILED, "No scene is currently open in the editor.");
+        }
+        return edited_scene;
+    }
+
+    if (!scene_path.begins_with("res://")) {
+        scene_path = "res://" + scene_path;
+    }
+
+    if (edited_scene && edited_scene->get_scene_file_path() == scene_path) {
+        return edited_scene;
+    }
+
+    // Work on the live copy: open it in the editor (or switch to its tab) for the duration of the call
+    if (!FileAccess::exists(scene_path)) {
+        r_error = _make_error(ERROR_INVALID_PARAMS, "Scene not found: " + scene_path);
+        return nullptr;
+    }
+
+    if (edited_scene && previous_scene.is_null()) {
+        previous_scene = edited_scene->get_instance_id();
+    }
+    EditorInterface::get_singleton()->open_scene_from_path(scene_path);
+    edited_scene = EditorNode::get_singleton()->get_edited_scene();
+    if (!edited_scene || edited_scene->get_scene_file_path() != scene_path) {
+        r_error = _make_error(ERROR_OPERATION_FAILED, "Could not open scene: " + scene_path);
+        return nullptr;
+    }
+
+    return edited_scene;
+}
+
+void VectorAIRPCServer::_restore_scene_tab() {
+    if (previous_scene.is_null()) {
+        return;
+    }
+
+    Node *scene = Object::cast_to<Node>(ObjectDB::get_instance(previous_scene));
+    previous_scene = ObjectID();
+    if (!scene || scene == EditorNode::get_singleton()->get_edited_scene()) {
+        return;
+    }
+
+    // Scenes opened by the call stay open in their own tabs
+    EditorData &editor_data = EditorNode::get_editor_data();
+    for (int i = 0; i < editor_data.get_edited_scene_count(); i++) {
+        if (editor_data.get_edited_scene_root(i) == scene) {
+            EditorNode::get_singleton()->set_current_scene(i);
+            return;
+        }
+    }
+}
+
+Dictionary VectorAIRPCServer::_rpc_analyze(const Dictionary &p_params, Dictionary &r_error) {
+    // Scenes that are not open are read from their file without instantiating
+    String file = p_params.get("file", "");
+    if (!file.is_empty()) {
+        if (!file.begins_with("res://")) {
+            file = "res://" + file;
+        }
+
+        Dictionary result;
+        result["scene_path"] = file;
+        result["scene_info"] = scene_analyzer->analyze_scene_file(file);
+        return result;
+    }
+
+    Node *scene = _get_scene(p_params, r_error);
+    if (!scene) {
+        return Dictionary();
+    }
+
+    Dictionary result;
+    result["scene_path"] = scene->get_scene_file_path();
+    result["scene_info"] = bool(p_params.get("outline", false)) ? scene_analyzer->analyze_shallow_outline() : scene_analyzer->analyze_current_scene();
+    return result;
+}
+
+Dictionary VectorAIRPCServer::_rpc_apply(const Dictionary &p_params, Dictionary &r_error) {
+    if (p_params.get("modifications", Variant()).get_type() != Variant::ARRAY) {
+        r_error = _make_error(ERROR_INVALID_PARAMS, "Expected a modifications array of {node_path, property_value}.");
+        return Dictionary();
+    }
+
+    Node *scene = _get_scene(p_params, r_error);
+    if (!scene) {
+        return Dictionary();
+    }
+
+    Dictionary modifications;
+    modifications["list"] = p_params["modifications"];
+    return scene_modifier->apply_modifications(modifications);
+}
+
+Dictionary VectorAIRPCServer::_rpc_create_node(const Dictionary &p_params, Dictionary &r_error) {
+    String node_type = p_params.get("node_type", "");
+    String node_name = p_params.get("node_name", "");
+    if (node_type.is_empty() || node_name.is_empty()) {
+        r_error = _make_error(ERROR_INVALID_PARAMS, "node_type and node_name are required.");
+        return Dictionary();
+    }
+
+    Node *scene = _get_scene(p_params, r_error);
+    if (!scene) {
+        return Dictionary();
+    }
+
+    Dictionary result = scene_modifier->create_node(p_params.get("parent_node_path", ""), node_type, node_name, p_params.get("properties", Dictionary()), p_params.get("typed_properties", Dictionary()));
+    if (!bool(result["success"])) {
+        r_error = _make_error(ERROR_OPERATION_FAILED, result["error"]);
+        return result;
+    }
+
+    // A named scene is saved like the headless add_node does; the edited scene is left to the user
+    result["saved"] = false;
+    if (!String(p_params.get("scene_path", "")).is_empty()) {
+        Error err = EditorInterface::get_singleton()->save_scene();
+        if (err != OK) {
+            r_error = _make_error(ERROR_OPERATION_FAILED, vformat("Node created but the scene could not be saved (error %d).", err));
+            return result;
+        }
+        result["saved"] = true;
+    }
+    return result;
+}
+
+Dictionary VectorAIRPCServer::_rpc_create_scene(const Dictionary &p_params, Dictionary &r_error) {
+    String scene_path = p_params.get("scene_path", "");
+    String root_node_type = p_params.get("root_node_type", "Node2D");
+    if (scene_path.is_empty()) {
+        r_error = _make_error(ERROR_INVALID_PARAMS, "scene_path is required.");
+        return Dictionary();
+    }
+    if (!scene_path.begins_with("res://")) {
+        scene_path = "res://" + scene_path;
+    }
+
+    if (!ClassDB::can_instantiate(root_node_type) || !ClassDB::is_parent_class(root_node_type, "Node")) {
+        r_error = _make_error(ERROR_INVALID_PARAMS, "Not an instantiable node type: " + root_node_type);
+        return Dictionary();
+    }
+
+    Node *root = Object::cast_to<Node>(ClassDB::instantiate(root_node_type));
+    root->set_name(scene_path.get_file().get_basename().to_pascal_case());
+
+    Ref<PackedScene> packed_scene;
+    packed_scene.instantiate();
+    Error err = packed_scene->pack(root);
+    memdelete(root);
+
+    if (err == OK) {
+        DirAccess::make_dir_recursive_absolute(ProjectSettings::get_singleton()->globalize_path(scene_path.get_base_dir()));
+        err = ResourceSaver::save(packed_scene, scene_path);
+    }
+    if (err != OK) {
+        r_error = _make_error(ERROR_OPERATION_FAILED, vformat("Failed to save scene %s (error %d).", scene_path, err));
+        return Dictionary();
+    }
+
+    // Saved only, like the headless operation; a later call opens it when it needs the live scene
+    EditorFileSystem::get_singleton()->update_file(scene_path);
+
+    Dictionary result;
+    result["scene_path"] = scene_path;
+    return result;
+}
+
+Dictionary VectorAIRPCServer::_rpc_save_scene(const Dictionary &p_params, Dictionary &r_error) {
+    Node *scene = _get_scene(p_params, r_error);
+    if (!scene) {
+        return Dictionary();
+    }
+
+    String new_path = p_params.get("new_path", "");
+    if (!new_path.is_empty()) {
+        if (!new_path.begins_with("res://")) {
+            new_path = "res://" + new_path;
+        }
+        EditorInterface::get_singleton()->save_scene_as(new_path);
+    } else {
+        Error err = EditorInterface::get_singleton()->save_scene();
+        if (err != OK) {
+            r_error = _make_error(ERROR_OPERATION_FAILED, vformat("Failed to save scene (error %d).", err));
+            return Dictionary();
+        }
+    }
+
+    Dictionary result;
+    result["scene_path"] = new_path.is_empty() ? scene->get_scene_file_path() : new_path;
+    return result;
+}
+
+Dictionary VectorAIRPCServer::_rpc_journal_list(const Dictionary &p_params, Dictionary &r_error) {
+    if (journal.is_null()) {
+        r_error = _make_error(ERROR_OPERATION_FAILED, "The modification journal is not available.");
+        return Dictionary();
+    }
+
+    Dictionary result;
+    result["entries"] = journal->get_entries(p_params.get("limit", 50));
+    return result;
+}
+
+Dictionary VectorAIRPCServer::_rpc_journal_replay(const Dictionary &p_params, Dictionary &r_error) {
+    if (journal.is_null()) {
+        r_error = _make_error(ERROR_OPERATION_FAILED, "The modification journal is not available.");
+        return Dictionary();
+    }
+
+    Dictionary entry = journal->get_entry(p_params.get("id", -1));
+    if (entry.is_empty()) {
+        r_error = _make_error(ERROR_INVALID_PARAMS, "Journal entry not found: " + String(p_params.get("id", "")));
+        return Dictionary();
+    }
+
+    // Paths are remapped by prefix, e.g. {"UI/HUD": "CanvasLayer/HUD"}
+    Dictionary remap = p_params.get("remap", Dictionary());
+    Array changes = entry["changes"];
+
+    // Without scene_paths the edited scene is changed, as one undo action
+    Variant scene_paths_value = p_params.get("scene_paths", Variant());
+    if (scene_paths_value.get_type() == Variant::NIL) {
+        Node *scene = _get_scene(p_params, r_error);
+        if (!scene) {
+            return Dictionary();
+        }
+        return scene_modifier->replay_changes(changes, remap);
+    }
+
+    if (scene_paths_value.get_type() != Variant::ARRAY && scene_paths_value.get_type() != Variant::PACKED_STRING_ARRAY) {
+        r_error = _make_error(ERROR_INVALID_PARAMS, "Expected scene_paths as an array of scene paths.");
+        return Dictionary();
+    }
+
+    PackedStringArray scene_paths;
+    Array scene_list = scene_paths_value;
+    for (int i = 0; i < scene_list.size(); i++) {
+        String scene_path = scene_list[i];
+        if (!scene_path.begins_with("res://")) {
+            scene_path = "res://" + scene_path;
+        }
+        scene_paths.push_back(scene_path);
+    }
+    return scene_modifier->replay_changes_to_scenes(changes, scene_paths, remap);
+}
+
+VectorAIRPCServer::VectorAIRPCServer() {
+}
+
+VectorAIRPCServer::~VectorAIRPCServer() {
+    stop();
+}
@@ -0,0 +1,120 @@
+/**************************************************************************/
+/*  vector_ai_rpc_server.h                                                */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/io/stream_peer_tcp.h"
+#include "core/io/tcp_server.h"
+#include "core/templates/local_vector.h"
+#include "modification_journal.h"
+#include "scene/main/node.h"
+
+class SceneAnalyzer;
+class SceneModifier;
+
+// Newline-delimited JSON-RPC 2.0 over a loopback TCP socket, serving live
+// editor scenes to local tools such as godot-mcp.
+class VectorAIRPCServer : public Node {
+    GDCLASS(VectorAIRPCServer, Node);
+
+public:
+    enum ErrorCode {
+        ERROR_PARSE = -32700,
+        ERROR_INVALID_REQUEST = -32600,
+        ERROR_METHOD_NOT_FOUND = -32601,
+        ERROR_INVALID_PARAMS = -32602,
+        ERROR_OPERATION_FAILED = -32000,
+        ERROR_UNAUTHORIZED = -32001,
+    };
+
+private:
+    static const int DEFAULT_PORT = 9510;
+    static const int MAX_PEERS = 8;
+    static const int MAX_LINE_LENGTH = 8 * 1024 * 1024;
+
+    // Responses wait here until the socket takes them; a peer that stops reading stops being read
+    struct Peer {
+        Ref<StreamPeerTCP> stream;
+        PackedByteArray buffer;
+        PackedByteArray outgoing;
+        int outgoing_offset = 0;
+        bool closing = false;
+    };
+
+    Ref<TCPServer> server;
+    LocalVector<Peer> peers;
+    int port = DEFAULT_PORT;
+    String token;
+
+    SceneAnalyzer *scene_analyzer = nullptr;
+    SceneModifier *scene_modifier = nullptr;
+    Ref<ModificationJournal> journal;
+
+    // Scene the user had open before a call switched tabs to work on another one
+    ObjectID previous_scene;
+
+    String _get_discovery_path() const;
+    void _write_discovery_file() const;
+    void _poll();
+    bool _read_peer(Peer &p_peer);
+    bool _write_peer(Peer &p_peer);
+    static void _queue_response(Peer &p_peer, const String &p_response);
+    bool _token_matches(const String &p_token) const;
+    String _handle_line(const String &p_line);
+    Dictionary _dispatch(const String &p_method, const Dictionary &p_params, Dictionary &r_error);
+
+    Node *_get_scene(const Dictionary &p_params, Dictionary &r_error);
+    void _restore_scene_tab();
+    Dictionary _rpc_analyze(const Dictionary &p_params, Dictionary &r_error);
+    Dictionary _rpc_apply(const Dictionary &p_params, Dictionary &r_error);
+    Dictionary _rpc_create_node(const Dictionary &p_params, Dictionary &r_error);
+    Dictionary _rpc_create_scene(const Dictionary &p_params, Dictionary &r_error);
+    Dictionary _rpc_save_scene(const Dictionary &p_params, Dictionary &r_error);
+    Dictionary _rpc_journal_list(const Dictionary &p_params, Dictionary &r_error);
+    Dictionary _rpc_journal_replay(const Dictionary &p_params, Dictionary &r_error);
+
+    static Dictionary _make_error(int p_code, const String &p_message);
+
+protected:
+    void _notification(int p_what);
+    static void _bind_methods();
+
+public:
+    void set_components(SceneAnalyzer *p_analyzer, SceneModifier *p_modifier);
+    void set_journal(const Ref<ModificationJournal> &p_journal);
+
+    Error start(int p_port);
+    void stop();
+    bool is_running() const;
+    int get_port() const;
+
+    VectorAIRPCServer();
+    ~VectorAIRPCServer();
+};
@@ -0,0 +1,198 @@
+/**************************************************************************/
+/*  vector_ai_tracer.cpp                                                  */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "vector_ai_tracer.h"
+
+#include "core/io/file_access.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "editor/editor_paths.h"
+
+VectorAITracer *VectorAITracer::singleton = nullptr;
+thread_local VectorAITracer::ThreadBuffer *VectorAITracer::thread_buffer = nullptr;
+
+void VectorAITracer::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("set_enabled", "enabled"), &VectorAITracer::set_enabled);
+    ClassDB::bind_method(D_METHOD("is_enabled"), &VectorAITracer::is_enabled);
+    ClassDB::bind_method(D_METHOD("begin_span", "name"), &VectorAITracer::begin_span_named);
+    ClassDB::bind_method(D_METHOD("end_span", "name"), &VectorAITracer::end_span_named);
+    ClassDB::bind_method(D_METHOD("clear"), &VectorAITracer::clear);
+    ClassDB::bind_method(D_METHOD("save_trace", "path"), &VectorAITracer::save_trace);
+    ClassDB::bind_method(D_METHOD("get_default_trace_path"), &VectorAITracer::get_default_trace_path);
+}
+
+VectorAITracer *VectorAITracer::get_singleton() {
+    return singleton;
+}
+
+VectorAITracer::ThreadBuffer *VectorAITracer::_get_thread_buffer() {
+    if (thread_buffer) {
+        return thread_buffer;
+    }
+
+    ThreadBuffer *buffer = memnew(ThreadBuffer);
+    buffer->thread_id = Thread::get_caller_id();
+    buffer->generation.set(generation.get());
+
+    // Lock-free push onto the buffer list; buffers are only freed with the tracer
+    ThreadBuffer *head = buffers.load(std::memory_order_relaxed);
+    do {
+        buffer->next = head;
+    } while (!buffers.compare_exchange_weak(head, buffer, std::memory_order_release, std::memory_order_relaxed));
+
+    thread_buffer = buffer;
+    return buffer;
+}
+
+void VectorAITracer::_record(const char *p_name, EventType p_type) {
+    if (!enabled.is_set()) {
+        return;
+    }
+
+    ThreadBuffer *buffer = _get_thread_buffer();
+
+    // The owning thread resets its buffer when the trace was cleared. The generation is published
+    // last, so a reader that sees the new one also sees the reset counts.
+    uint32_t current_generation = generation.get();
+    if (buffer->generation.get() != current_generation) {
+        buffer->committed.set(0);
+        buffer->dropped.set(0);
+        buffer->generation.set(current_generation);
+    }
+
+    uint32_t index = buffer->committed.get();
+    if (index >= BUFFER_CAPACITY) {
+        buffer->dropped.increment();
+        return;
+    }
+
+    Event &event = buffer->events[index];
+    strncpy(event.name, p_name, MAX_NAME_LENGTH - 1);
+    event.name[MAX_NAME_LENGTH - 1] = '\0';
+    event.timestamp_usec = OS::get_singleton()->get_ticks_usec();
+    event.type = p_type;
+
+    // Publish the event to readers only after it is fully written
+    buffer->committed.set(index + 1);
+}
+
+void VectorAITracer::set_enabled(bool p_enabled) {
+    if (p_enabled) {
+        enabled.set();
+    } else {
+        enabled.clear();
+    }
+}
+
+void VectorAITracer::begin_span(const char *p_name) {
+    _record(p_name, EVENT_BEGIN);
+}
+
+void VectorAITracer::end_span(const char *p_name) {
+    _record(p_name, EVENT_END);
+}
+
+void VectorAITracer::instant(const char *p_name) {
+    _record(p_name, EVENT_INSTANT);
+}
+
+void VectorAITracer::begin_span_named(const String &p_name) {
+    if (enabled.is_set()) {
+        _record(p_name.utf8().get_data(), EVENT_BEGIN);
+    }
+}
+
+void VectorAITracer::end_span_named(const String &p_name) {
+    if (enabled.is_set()) {
+        _record(p_name.utf8().get_data(), EVENT_END);
+    }
+}
+
+void VectorAITracer::clear() {
+    generation.increment();
+}
+
+Error VectorAITracer::save_trace(const String &p_path) const {
+    Ref<FileAccess> f = FileAccess::open(p_path, FileAccess::WRITE);
+    ERR_FAIL_COND_V_MSG(f.is_null(), ERR_FILE_CANT_WRITE, "Cannot write Vector AI trace to: " + p_path);
+
+    uint32_t current_generation = generation.get();
+    bool first = true;
+
+    f->store_string("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    for (const ThreadBuffer *buffer = buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+        if (buffer->generation.get() != current_generation) {
+            continue;
+        }
+
+        uint32_t count = buffer->committed.get();
+        for (uint32_t i = 0; i < count; i++) {
+            const Event &event = buffer->events[i];
+
+            String phase = event.type == EVENT_BEGIN ? "B" : (event.type == EVENT_END ? "E" : "i");
+            String line = vformat("{\"name\":\"%s\",\"cat\":\"vector_ai\",\"ph\":\"%s\",\"ts\":%d,\"pid\":1,\"tid\":%d%s}",
+                    String::utf8(event.name).json_escape(), phase, (int64_t)event.timestamp_usec, (int64_t)buffer->thread_id,
+                    event.type == EVENT_INSTANT ? ",\"s\":\"t\"" : "");
+
+            f->store_string(first ? line : ",\n" + line);
+            first = false;
+        }
+
+        uint32_t dropped = buffer->dropped.get();
+        if (dropped > 0) {
+            WARN_PRINT(vformat("Vector AI trace buffer for thread %d was full, %d events were dropped.", (int64_t)buffer->thread_id, dropped));
+        }
+    }
+
+    f->store_string("\n]}\n");
+    return OK;
+}
+
+String VectorAITracer::get_default_trace_path() const {
+    return EditorPaths::get_singleton()->get_project_settings_dir().path_join("vector_ai_trace.json");
+}
+
+VectorAITracer::VectorAITracer() {
+    singleton = this;
+}
+
+VectorAITracer::~VectorAITracer() {
+    ThreadBuffer *buffer = buffers.exchange(nullptr);
+    while (buffer) {
+        ThreadBuffer *next = buffer->next;
+        memdelete(buffer);
+        buffer = next;
+    }
+
+    if (singleton == this) {
+        singleton = nullptr;
+    }
+}
@@ -0,0 +1,128 @@
+/**************************************************************************/
+/*  vector_ai_tracer.h                                                    */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/object/class_db.h"
+#include "core/object/object.h"
+#include "core/templates/safe_refcount.h"
+
+#include <atomic>
+
+class VectorAITracer : public Object {
+    GDCLASS(VectorAITracer, Object);
+
+public:
+    static const int MAX_NAME_LENGTH = 48;
+    static const uint32_t BUFFER_CAPACITY = 8192;
+
+    enum EventType {
+        EVENT_BEGIN,
+        EVENT_END,
+        EVENT_INSTANT,
+    };
+
+private:
+    struct Event {
+        char name[MAX_NAME_LENGTH];
+        uint64_t timestamp_usec = 0;
+        EventType type = EVENT_INSTANT;
+    };
+
+    // Each thread writes only to its own buffer, so recording never takes a lock.
+    // Buffers are linked into a push-only list the first time a thread records.
+    // The counters are read by save_trace on another thread, so they are atomic.
+    struct ThreadBuffer {
+        Event events[BUFFER_CAPACITY];
+        SafeNumeric<uint32_t> committed;
+        SafeNumeric<uint32_t> generation;
+        SafeNumeric<uint32_t> dropped;
+        uint64_t thread_id = 0;
+        ThreadBuffer *next = nullptr;
+    };
+
+    static VectorAITracer *singleton;
+    static thread_local ThreadBuffer *thread_buffer;
+
+    SafeFlag enabled;
+    SafeNumeric<uint32_t> generation;
+    std::atomic<ThreadBuffer *> buffers = { nullptr };
+
+    ThreadBuffer *_get_thread_buffer();
+    void _record(const char *p_name, EventType p_type);
+
+protected:
+    static void _bind_methods();
+
+public:
+    static VectorAITracer *get_singleton();
+
+    void set_enabled(bool p_enabled);
+    _FORCE_INLINE_ bool is_enabled() const { return enabled.is_set(); }
+
+    void begin_span(const char *p_name);
+    void end_span(const char *p_name);
+    void instant(const char *p_name);
+
+    void begin_span_named(const String &p_name);
+    void end_span_named(const String &p_name);
+
+    void clear();
+    Error save_trace(const String &p_path) const;
+    String get_default_trace_path() const;
+
+    VectorAITracer();
+    ~VectorAITracer();
+};
+
+// Records a span for the lifetime of the scope when tracing is enabled
+class VectorAITraceScope {
+    const char *name = nullptr;
+    bool active = false;
+
+public:
+    _FORCE_INLINE_ VectorAITraceScope(const char *p_name) {
+        VectorAITracer *tracer = VectorAITracer::get_singleton();
+        if (tracer && tracer->is_enabled()) {
+            name = p_name;
+            active = true;
+            tracer->begin_span(p_name);
+        }
+    }
+
+    _FORCE_INLINE_ ~VectorAITraceScope() {
+        VectorAITracer *tracer = VectorAITracer::get_singleton();
+        if (active && tracer) {
+            tracer->end_span(name);
+        }
+    }
+};
+
+#define VECTOR_AI_TRACE_SCOPE(m_name) VectorAITraceScope _vector_ai_trace_scope_(m_name)